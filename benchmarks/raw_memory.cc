@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Micro-benchmarks of the primitives in pemc/basic/raw_memory.h. Compares the
+// former scalar loops with the vectorized and the size specialised operations.
+// Build with optimizations (e.g., --buildtype=release).
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "pemc/basic/raw_memory.h"
+
+using namespace pemc;
+
+namespace {
+
+// The loop areBuffersEqual used before it was vectorized.
+bool areBuffersEqualScalar(gsl::byte* buffer1,
+                           gsl::byte* buffer2,
+                           size_t sizeInBytes) {
+  for (auto i = sizeInBytes / 8; i > 0; --i) {
+    uint64_t word1, word2;
+    std::memcpy(&word1, buffer1, 8);
+    std::memcpy(&word2, buffer2, 8);
+    if (word1 != word2)
+      return false;
+    buffer1 += 8;
+    buffer2 += 8;
+  }
+  for (auto i = sizeInBytes % 8; i > 0; --i) {
+    if (*buffer1 != *buffer2)
+      return false;
+    buffer1 += 1;
+    buffer2 += 1;
+  }
+  return true;
+}
+
+const size_t NumberOfStates = 4096;
+const int32_t Repetitions = 200;
+
+// Returns nanoseconds per call of operation on each of NumberOfStates
+// states.
+template <typename TOperation>
+double measure(TOperation operation) {
+  volatile uint64_t sink = 0;
+  // Warm up the caches and the branch predictors.
+  for (size_t state = 0; state < NumberOfStates; ++state)
+    sink = sink + operation(state);
+  auto start = std::chrono::steady_clock::now();
+  for (auto repetition = 0; repetition < Repetitions; ++repetition) {
+    for (size_t state = 0; state < NumberOfStates; ++state)
+      sink = sink + operation(state);
+  }
+  auto end = std::chrono::steady_clock::now();
+  auto nanoseconds =
+      std::chrono::duration<double, std::nano>(end - start).count();
+  return nanoseconds / (double(Repetitions) * NumberOfStates);
+}
+
+void benchmarkSize(size_t sizeInBytes) {
+  // Equal states are the worst case of a comparison.
+  auto states1 = std::vector<gsl::byte>(NumberOfStates * sizeInBytes);
+  for (size_t i = 0; i < states1.size(); ++i)
+    states1[i] = static_cast<gsl::byte>(i * 7);
+  auto states2 = states1;
+  auto target = std::vector<gsl::byte>(NumberOfStates * sizeInBytes);
+  auto state1 = [&](size_t state) { return &states1[state * sizeInBytes]; };
+  auto state2 = [&](size_t state) { return &states2[state * sizeInBytes]; };
+  auto operations = getStateVectorOperations(sizeInBytes);
+
+  auto equalScalar = measure([&](size_t state) {
+    return areBuffersEqualScalar(state1(state), state2(state), sizeInBytes);
+  });
+  auto equalVectorized = measure([&](size_t state) {
+    return areBuffersEqual(state1(state), state2(state), sizeInBytes);
+  });
+  auto equalOperations = measure([&](size_t state) {
+    return operations.areEqual(state1(state), state2(state));
+  });
+  auto copyGeneric = measure([&](size_t state) {
+    copyBuffers(state1(state), &target[state * sizeInBytes], sizeInBytes);
+    return 0;
+  });
+  auto copyOperations = measure([&](size_t state) {
+    operations.copy(state1(state), &target[state * sizeInBytes]);
+    return 0;
+  });
+  auto hashGeneric = measure([&](size_t state) {
+    return hashBuffer64(state1(state), sizeInBytes, 0);
+  });
+  auto hashOperations =
+      measure([&](size_t state) { return operations.hash64(state1(state), 0); });
+
+  std::cout << std::setw(6) << sizeInBytes << std::fixed
+            << std::setprecision(2) << std::setw(12) << equalScalar
+            << std::setw(12) << equalVectorized << std::setw(12)
+            << equalOperations << std::setw(12) << copyGeneric
+            << std::setw(12) << copyOperations << std::setw(12)
+            << hashGeneric << std::setw(12) << hashOperations << std::endl;
+}
+
+}  // namespace
+
+int main() {
+  std::cout << "Nanoseconds per state vector" << std::endl;
+  std::cout << std::setw(6) << "bytes" << std::setw(12) << "eq scalar"
+            << std::setw(12) << "eq simd" << std::setw(12) << "eq sized"
+            << std::setw(12) << "copy" << std::setw(12) << "copy sized"
+            << std::setw(12) << "hash" << std::setw(12) << "hash sized"
+            << std::endl;
+  for (auto sizeInBytes : {4, 8, 16, 32, 64, 100, 256, 1024})
+    benchmarkSize(sizeInBytes);
+}
@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Micro-benchmark of the kernels of pemc/lmc/sparse_matrix_kernels.h on a
+// random Lmc that resembles the Lmcs of models: short rows whose targets are
+// mostly close to their source state. Build with optimizations (e.g.,
+// --buildtype=release).
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "pemc/lmc/lmc.h"
+#include "pemc/lmc/lmc_columns.h"
+#include "pemc/lmc/lmc_reduced_matrix.h"
+
+using namespace pemc;
+
+namespace {
+
+const StateIndex NumberOfStates = 2000000;
+const NoOfElements MaximalTransitionsPerState = 7;
+const int32_t Iterations = 20;
+
+void createLmc(Lmc& lmc) {
+  auto capacity = ModelCapacityByModelSize::Normal();
+  capacity.setMaximalTargets(1 << 24);
+  lmc.initialize(capacity);
+  lmc.setLabelIdentifier(std::vector<std::string>{"f"});
+
+  std::mt19937 random(1);
+  auto anyState = std::uniform_int_distribution<StateIndex>(0, NumberOfStates - 1);
+  auto nearby = std::uniform_int_distribution<StateIndex>(-1000, 1000);
+  auto isNearby = std::bernoulli_distribution(0.8);
+  auto numberOfTransitions =
+      std::uniform_int_distribution<NoOfElements>(1, MaximalTransitionsPerState);
+  auto target = [&](StateIndex source) {
+    if (!isNearby(random))
+      return anyState(random);
+    auto state = source + nearby(random);
+    return state < 0 || state >= NumberOfStates ? source : state;
+  };
+  auto addTransitions = [&](TransitionIndex location, NoOfElements number,
+                            StateIndex source) {
+    for (auto i = 0; i < number; i++)
+      lmc.setLmcTransitionEntry(
+          location + i, LmcTransitionEntry(Probability(1.0 / number), Label(),
+                                           target(source)));
+  };
+  addTransitions(lmc.getPlaceForNewInitialTransitionEntries(1), 1, 0);
+  for (StateIndex s = 0; s < NumberOfStates; s++) {
+    auto number = numberOfTransitions(random);
+    addTransitions(lmc.getPlaceForNewTransitionEntriesOfState(s, number),
+                   number, s);
+  }
+  lmc.finishCreation(NumberOfStates);
+}
+
+// Returns nanoseconds per nonzero and iteration.
+double measure(const LmcReducedMatrix& matrix) {
+  auto x = std::vector<Probability>(matrix.getVectorSize(), Probability(0.5));
+  auto xnew = x;
+  matrix.multiplyAndAdd(x, xnew);
+  auto start = std::chrono::steady_clock::now();
+  for (auto i = 0; i < Iterations; i++) {
+    matrix.multiplyAndAdd(x, xnew);
+    std::swap(x, xnew);
+  }
+  auto end = std::chrono::steady_clock::now();
+  auto nanoseconds =
+      std::chrono::duration<double, std::nano>(end - start).count();
+  return nanoseconds / (double(Iterations) * matrix.getNonZeroCount());
+}
+
+}  // namespace
+
+int main() {
+  Lmc lmc;
+  createLmc(lmc);
+  LmcColumns columns(lmc);
+  // No transition is decided, so A contains every transition.
+  auto precalculations = std::vector<PrecalculatedTransition>(
+      columns.getTransitionCount(), PrecalculatedTransition::Nothing);
+
+  std::cout << "Nanoseconds per nonzero and iteration" << std::endl;
+  std::cout << std::setw(12) << "format" << std::setw(12) << "scalar"
+            << std::setw(12) << "AVX2" << std::setw(12) << "AVX-512"
+            << std::endl;
+  auto formats = {std::make_tuple("CSR", LmcMatrixFormat::Csr, 1),
+                  std::make_tuple("SELL-8-1", LmcMatrixFormat::SellCSigma, 1),
+                  std::make_tuple("SELL-8-32", LmcMatrixFormat::SellCSigma, 32),
+                  std::make_tuple("SELL-8-256", LmcMatrixFormat::SellCSigma,
+                                  256)};
+  for (auto format : formats) {
+    LmcReducedMatrix matrix(columns, precalculations, std::get<1>(format),
+                            std::get<2>(format));
+    std::cout << std::setw(12) << std::get<0>(format) << std::fixed
+              << std::setprecision(3);
+    for (auto instructionSet :
+         {SimdInstructionSet::Scalar, SimdInstructionSet::Avx2,
+          SimdInstructionSet::Avx512}) {
+      if (!isSimdInstructionSetSupported(instructionSet)) {
+        std::cout << std::setw(12) << "-";
+        continue;
+      }
+      matrix.setSimdInstructionSet(instructionSet);
+      std::cout << std::setw(12) << measure(matrix);
+    }
+    std::cout << std::endl;
+  }
+}
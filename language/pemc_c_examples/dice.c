@@ -151,7 +151,7 @@ int32_t formula_f2(unsigned char* model) {
 
 int main() {
   // setup model functions
-  pemc_model_functions model_functions;
+  pemc_model_functions model_functions = {0};
   model_functions.model_create = (pemc_model_create)dice_model_create;
   model_functions.model_free = (pemc_model_free)dice_model_free;
   model_functions.serialize =
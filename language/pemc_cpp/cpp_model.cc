@@ -35,4 +35,16 @@ namespace pemc { namespace cpp {
       [this](auto& formula){ return generateSlowCppFormulaEvaluator(this,formula.get()) ;} );
   }
 
+  void PackedCppModel::serialize(gsl::span<gsl::byte> position) {
+    stateVariables.pack(position);
+  }
+
+  void PackedCppModel::deserialize(gsl::span<gsl::byte> position) {
+    stateVariables.unpack(position);
+  }
+
+  int32_t PackedCppModel::getStateVectorSize() {
+    return stateVariables.getStateVectorSize();
+  }
+
 } }
@@ -24,13 +24,19 @@
 #ifndef PEMC_CPP_CPP_MODEL_H_
 #define PEMC_CPP_CPP_MODEL_H_
 
+#include <cstring>
+#include <type_traits>
+
 #include "pemc/executable_model/abstract_model.h"
+#include "pemc_cpp/packed_state_variables.h"
 
 namespace pemc { namespace cpp {
 
   using namespace pemc;
 
   class CppModel : public AbstractModel {
+  private:
+    std::vector<Probability> probabilitiesOfChoice;
   public:
 
     virtual void serialize(gsl::span<gsl::byte> position) { }
@@ -45,14 +51,18 @@ namespace pemc { namespace cpp {
 
     virtual int32_t getStateVectorSize() { return 0; }
 
+    // The choose overloads below would hide those of AbstractModel, including
+    // the continuation-style ones.
+    using AbstractModel::choose;
+
     template<typename T>
     std::tuple<Probability,T> choose(std::initializer_list<std::tuple<Probability,T>> choices) {
       // This is a Member template and the implementation must stay therefore in the header.
-      auto probabilities = std::vector<Probability>();
-      probabilities.reserve(choices.size());
-      std::transform(choices.begin(), choices.end(), std::back_inserter(probabilities),
+      // The buffer is reused, so choose does not allocate in a steady state.
+      probabilitiesOfChoice.clear();
+      std::transform(choices.begin(), choices.end(), std::back_inserter(probabilitiesOfChoice),
         [](auto& choice){ return std::get<0>(choice);} );
-      auto chosenIdx = choiceResolver->choose(probabilities);
+      auto chosenIdx = choiceResolver->choose(probabilitiesOfChoice);
       return choices.begin()[chosenIdx];
     }
 
@@ -65,5 +75,97 @@ namespace pemc { namespace cpp {
 
   };
 
+  // A CppModel that declares its state variables with their value ranges
+  // (usually in the constructor), e.g.
+  //   addStateVariable(position, 0, 99, "position");
+  // serialize, deserialize and getStateVectorSize are derived from the
+  // declarations. Each variable occupies only the bits its range requires.
+  // The declarations refer to the members of this instance, so the model can
+  // neither be copied nor moved.
+  class PackedCppModel : public CppModel {
+  protected:
+    PackedStateVariables stateVariables;
+
+    template<typename T>
+    void addStateVariable(T& variable, T minValue, T maxValue, const std::string& name = "") {
+      stateVariables.add(variable, minValue, maxValue, name);
+    }
+  public:
+    PackedCppModel() = default;
+    PackedCppModel(const PackedCppModel&) = delete;
+    PackedCppModel(PackedCppModel&&) = delete;
+    PackedCppModel& operator=(const PackedCppModel&) = delete;
+    PackedCppModel& operator=(PackedCppModel&&) = delete;
+
+    virtual void serialize(gsl::span<gsl::byte> position);
+
+    virtual void deserialize(gsl::span<gsl::byte> position);
+
+    virtual int32_t getStateVectorSize();
+  };
+
+  // A CppModel whose state is the trivially copyable struct TState. The
+  // ModelExecutor lets the model step directly on the state vector of the
+  // successor, so the state is neither serialized nor deserialized. Access the
+  // state only via getState(). Before the first useStateVector, the model uses
+  // its own copy of the state. The model refers to its own state, so it can
+  // neither be copied nor moved.
+  template<typename TState>
+  class CppStateVectorResidentModel : public CppModel {
+    static_assert(std::is_trivially_copyable<TState>::value,
+                  "The state of a state vector resident model must be trivially copyable");
+  private:
+    TState ownState;
+    TState* state = &ownState;
+  public:
+    CppStateVectorResidentModel() = default;
+    CppStateVectorResidentModel(const CppStateVectorResidentModel&) = delete;
+    CppStateVectorResidentModel(CppStateVectorResidentModel&&) = delete;
+    CppStateVectorResidentModel& operator=(const CppStateVectorResidentModel&) = delete;
+    CppStateVectorResidentModel& operator=(CppStateVectorResidentModel&&) = delete;
+
+    TState& getState() { return *state; }
+
+    virtual bool isStateVectorResident() { return true; }
+
+    virtual void useStateVector(gsl::span<gsl::byte> stateVector) {
+      state = reinterpret_cast<TState*>(stateVector.data());
+    }
+
+    virtual void serialize(gsl::span<gsl::byte> position) {
+      std::memcpy(position.data(), state, sizeof(TState));
+    }
+
+    virtual void deserialize(gsl::span<gsl::byte> position) {
+      std::memcpy(state, position.data(), sizeof(TState));
+    }
+
+    virtual int32_t getStateVectorSize() { return sizeof(TState); }
+  };
+
+  // A state vector resident model with a statically known state layout
+  // (curiously recurring template pattern). TDerived implements
+  //   void initialState(TState& state);
+  //   void stepState(TState& state);
+  // as non-virtual members. They are called directly and can be inlined, and
+  // the state vector size is a compile time constant, so the ModelExecutor and
+  // the StateStorage copy, compare and hash the states with the operations
+  // specialised for sizeof(TState).
+  template<typename TDerived, typename TState>
+  class StaticCppModel : public CppStateVectorResidentModel<TState> {
+  public:
+    static constexpr int32_t StateVectorSize = sizeof(TState);
+
+    virtual void resetToInitialState() final {
+      static_cast<TDerived*>(this)->initialState(this->getState());
+    }
+
+    virtual void step() final {
+      static_cast<TDerived*>(this)->stepState(this->getState());
+    }
+
+    virtual int32_t getStateVectorSize() final { return StateVectorSize; }
+  };
+
 } }
 #endif  // PEMC_CPP_CPP_MODEL_H_
@@ -0,0 +1,125 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "pemc_cpp/packed_state_variables.h"
+
+#include <cstring>
+
+#include "pemc/basic/ThrowAssert.hpp"
+
+namespace pemc { namespace cpp {
+
+  void PackedStateVariables::addVariable(void* variable, int32_t sizeInBytes, bool isSigned,
+                                         int64_t minValue, int64_t maxValue, const std::string& name) {
+    throw_assert(minValue <= maxValue, "the range of the state variable " << name << " is empty");
+    auto range = static_cast<uint64_t>(maxValue) - static_cast<uint64_t>(minValue);
+    auto bits = 0;
+    while (bits < 64 && (range >> bits) != 0)
+      ++bits;
+    throw_assert(bits <= 32, "the range of the state variable " << name << " exceeds 32 bits");
+    variables.push_back(StateVariable{variable, sizeInBytes, isSigned, minValue, range, bits, name});
+    totalBits += bits;
+  }
+
+  int64_t PackedStateVariables::readVariable(const StateVariable& variable) {
+    switch (variable.sizeInBytes) {
+      case 1:
+        return variable.isSigned ? int64_t(*static_cast<int8_t*>(variable.variable))
+                                 : int64_t(*static_cast<uint8_t*>(variable.variable));
+      case 2:
+        return variable.isSigned ? int64_t(*static_cast<int16_t*>(variable.variable))
+                                 : int64_t(*static_cast<uint16_t*>(variable.variable));
+      case 4:
+        return variable.isSigned ? int64_t(*static_cast<int32_t*>(variable.variable))
+                                 : int64_t(*static_cast<uint32_t*>(variable.variable));
+      default:
+        int64_t value;
+        std::memcpy(&value, variable.variable, sizeof(value));
+        return value;
+    }
+  }
+
+  void PackedStateVariables::writeVariable(const StateVariable& variable, int64_t value) {
+    // Truncating to the size of the variable keeps the value, because the
+    // value is within the declared range.
+    switch (variable.sizeInBytes) {
+      case 1:
+        *static_cast<uint8_t*>(variable.variable) = static_cast<uint8_t>(value);
+        break;
+      case 2:
+        *static_cast<uint16_t*>(variable.variable) = static_cast<uint16_t>(value);
+        break;
+      case 4:
+        *static_cast<uint32_t*>(variable.variable) = static_cast<uint32_t>(value);
+        break;
+      default:
+        std::memcpy(variable.variable, &value, sizeof(value));
+    }
+  }
+
+  int32_t PackedStateVariables::getNumberOfBits() {
+    return totalBits;
+  }
+
+  int32_t PackedStateVariables::getStateVectorSize() {
+    return (totalBits + 7) / 8;
+  }
+
+  void PackedStateVariables::pack(gsl::span<gsl::byte> position) {
+    // The bits are collected in a 64 bit buffer and written byte by byte.
+    auto target = position.data();
+    uint64_t buffer = 0;
+    auto bitsInBuffer = 0;
+    for (auto& variable : variables) {
+      auto offset = static_cast<uint64_t>(readVariable(variable)) - static_cast<uint64_t>(variable.minValue);
+      throw_assert(offset <= variable.range, "the state variable " << variable.name << " is out of range");
+      buffer |= offset << bitsInBuffer;
+      bitsInBuffer += variable.bits;
+      while (bitsInBuffer >= 8) {
+        *target++ = static_cast<gsl::byte>(buffer & 0xff);
+        buffer >>= 8;
+        bitsInBuffer -= 8;
+      }
+    }
+    if (bitsInBuffer > 0)
+      *target = static_cast<gsl::byte>(buffer & 0xff);
+  }
+
+  void PackedStateVariables::unpack(gsl::span<gsl::byte> position) {
+    auto source = position.data();
+    uint64_t buffer = 0;
+    auto bitsInBuffer = 0;
+    for (auto& variable : variables) {
+      while (bitsInBuffer < variable.bits) {
+        buffer |= static_cast<uint64_t>(*source++) << bitsInBuffer;
+        bitsInBuffer += 8;
+      }
+      auto offset = buffer & ((uint64_t(1) << variable.bits) - 1);
+      buffer >>= variable.bits;
+      bitsInBuffer -= variable.bits;
+      writeVariable(variable, static_cast<int64_t>(static_cast<uint64_t>(variable.minValue) + offset));
+    }
+  }
+
+} }
@@ -0,0 +1,89 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef PEMC_CPP_PACKED_STATE_VARIABLES_H_
+#define PEMC_CPP_PACKED_STATE_VARIABLES_H_
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <gsl/span>
+
+namespace pemc { namespace cpp {
+
+  // The state variables of a model with their value ranges. Each variable
+  // occupies only the bits required for its range, so the state vector is
+  // usually much smaller than the sum of the sizes of the variables.
+  // Supported are integral types, bool and enums with at most 32 bits per
+  // range.
+  class PackedStateVariables {
+  private:
+    struct StateVariable {
+      void* variable;
+      int32_t sizeInBytes;
+      bool isSigned;
+      int64_t minValue;
+      uint64_t range;
+      int32_t bits;
+      std::string name;
+    };
+
+    std::vector<StateVariable> variables;
+    int32_t totalBits = 0;
+
+    void addVariable(void* variable, int32_t sizeInBytes, bool isSigned,
+                     int64_t minValue, int64_t maxValue, const std::string& name);
+
+    static int64_t readVariable(const StateVariable& variable);
+
+    static void writeVariable(const StateVariable& variable, int64_t value);
+
+  public:
+    // Declares variable as state variable with the values from minValue to
+    // maxValue (inclusive). The variable must outlive this object.
+    template<typename T>
+    void add(T& variable, T minValue, T maxValue, const std::string& name = "") {
+      static_assert(std::is_integral<T>::value || std::is_enum<T>::value,
+                    "Only integral and enum state variables can be packed");
+      using TValue = typename std::conditional<std::is_enum<T>::value,
+        std::underlying_type<T>, std::common_type<T>>::type::type;
+      addVariable(&variable, sizeof(T), std::is_signed<TValue>::value,
+                  static_cast<int64_t>(static_cast<TValue>(minValue)),
+                  static_cast<int64_t>(static_cast<TValue>(maxValue)), name);
+    }
+
+    int32_t getNumberOfBits();
+
+    // The size of the packed state vector in bytes.
+    int32_t getStateVectorSize();
+
+    // Throws if a variable is not within its range.
+    void pack(gsl::span<gsl::byte> position);
+
+    void unpack(gsl::span<gsl::byte> position);
+  };
+
+} }
+#endif  // PEMC_CPP_PACKED_STATE_VARIABLES_H_
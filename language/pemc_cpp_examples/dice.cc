@@ -35,29 +35,20 @@ using namespace pemc::cpp;
 
 namespace {
 
-class TestModel : public CppModel {
+class TestModel : public PackedCppModel {
  public:
   int32_t state;
 
-  virtual void serialize(gsl::span<gsl::byte> position);
-
-  virtual void deserialize(gsl::span<gsl::byte> position);
+  TestModel();
 
   virtual void resetToInitialState();
 
   virtual void step();
-
-  virtual int32_t getStateVectorSize();
 };
 
-void TestModel::serialize(gsl::span<gsl::byte> position) {
-  auto ptrToState = reinterpret_cast<int32_t*>(position.data());
-  *ptrToState = state;
-}
-
-void TestModel::deserialize(gsl::span<gsl::byte> position) {
-  auto ptrToState = reinterpret_cast<int32_t*>(position.data());
-  state = *ptrToState;
+TestModel::TestModel() {
+  // The values of the dice fit into 13 bits.
+  addStateVariable(state, 0, 6456, "state");
 }
 
 void TestModel::resetToInitialState() {
@@ -89,10 +80,6 @@ void TestModel::step() {
   }
 }
 
-int32_t TestModel::getStateVectorSize() {
-  return sizeof(int32_t);
-}
-
 auto f1 = std::make_shared<CppFormula>(
     [](CppModel* model) {
       auto cppModel = static_cast<TestModel*>(model);
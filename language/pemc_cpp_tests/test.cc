@@ -22,8 +22,10 @@
 // THE SOFTWARE.
 
 #include <gtest/gtest.h>
+#include <cmath>
 #include <iostream>
 
+#include "pemc/basic/ThrowAssert.hpp"
 #include "pemc/executable_model/model_executor.h"
 #include "pemc/lmc_traverser/lmc_choice_resolver.h"
 #include "pemc/pemc.h"
@@ -97,11 +99,303 @@ TEST(pemcCpp_test, pemcCpp_test) {
 
     auto probability1 = pemc.calculateProbabilityToReachStateWithinBound(*lmc, f1, 0);
     auto probability2 = pemc.calculateProbabilityToReachStateWithinBound(*lmc, f1, 1);
+    auto probability3 = pemc.calculateProbabilityToReachState(*lmc, f1);
 
     lmc->validate();
 
     ASSERT_EQ(lmc->getStates().size(), 2) << "FAIL";
     ASSERT_EQ(probabilityIsAround(probability1, 0.5, 0.0001), true) << "FAIL";
     ASSERT_EQ(probabilityIsOne(probability2, 0.0001), true) << "FAIL";
+    ASSERT_EQ(probabilityIsOne(probability3, 0.0001), true) << "FAIL";
 
 }
+
+namespace {
+
+  // TestModel with continuation-style choices, so step() is executed only
+  // once per state.
+  class ContinuationTestModel : public CppModel {
+  public:
+    int32_t state;
+    int32_t executionsOfStep = 0;
+    std::vector<Probability> probabilities{Probability(0.5), Probability(0.5)};
+
+    virtual void serialize(gsl::span<gsl::byte> position) {
+      *reinterpret_cast<int32_t*>(position.data()) = state;
+    }
+
+    virtual void deserialize(gsl::span<gsl::byte> position) {
+      state = *reinterpret_cast<int32_t*>(position.data());
+    }
+
+    virtual void resetToInitialState() {
+      state = 0;
+    }
+
+    virtual bool usesContinuationStyleChoices() {
+      return true;
+    }
+
+    virtual void step() {
+      executionsOfStep++;
+      if (state == 0 ) {
+        choose(probabilities, [this](size_t option) {
+          state = option == 0 ? 3 : 1;
+        });
+      } else if (state == 1 ) {
+        choose(1, [this](size_t option) {
+          state = 3;
+        });
+      }
+    }
+
+    virtual int32_t getStateVectorSize() {
+      return sizeof(int32_t);
+    }
+  };
+
+  auto continuationF1 = std::make_shared<CppFormula>([](CppModel* model) {
+      return static_cast<ContinuationTestModel*>(model)->state == 3;
+    }, "continuationF1" );
+
+}
+
+TEST(pemcCpp_test, pemcCpp_with_continuation_style_choices_test) {
+    auto configuration = Configuration();
+
+    auto modelCreator = [](){ return std::make_unique<ContinuationTestModel>(); };
+
+    auto pemc = Pemc(configuration);
+    auto lmc = pemc.buildLmcFromExecutableModel(modelCreator, std::vector<std::shared_ptr<Formula>>( {continuationF1} ));
+
+    auto probability1 = pemc.calculateProbabilityToReachStateWithinBound(*lmc, continuationF1, 0);
+    auto probability2 = pemc.calculateProbabilityToReachStateWithinBound(*lmc, continuationF1, 1);
+
+    lmc->validate();
+
+    ASSERT_EQ(lmc->getStates().size(), 2) << "FAIL";
+    ASSERT_EQ(probabilityIsAround(probability1, 0.5, 0.0001), true) << "FAIL";
+    ASSERT_EQ(probabilityIsOne(probability2, 0.0001), true) << "FAIL";
+
+    // Both options of the initial choice are resumed from one execution of
+    // step().
+    auto modelExecutor = std::make_unique<ModelExecutor>(configuration);
+    auto model = std::make_unique<ContinuationTestModel>();
+    model->setFormulasForLabel(std::vector<std::shared_ptr<Formula>>( {continuationF1} ));
+    auto modelPtr = model.get();
+    modelExecutor->setModel(std::move(model));
+    modelExecutor->setChoiceResolver(std::make_unique<LmcChoiceResolver>());
+    modelExecutor->calculateInitialTransitions();
+    auto executionsOfInitialStep = modelPtr->executionsOfStep;
+    std::vector<gsl::byte> sourceState(sizeof(int32_t));
+    *reinterpret_cast<int32_t*>(sourceState.data()) = 0;
+    auto transitions = modelExecutor->calculateTransitionsOfState(sourceState);
+    ASSERT_EQ(transitions.size(), 2) << "FAIL";
+    ASSERT_EQ(modelPtr->executionsOfStep - executionsOfInitialStep, 1) << "FAIL";
+}
+
+namespace {
+
+  struct ResidentTestState {
+    int32_t position;
+    bool finished;
+  };
+
+  // TestModel with a state that lives in the state vector.
+  class ResidentTestModel : public CppStateVectorResidentModel<ResidentTestState> {
+  public:
+    virtual void serialize(gsl::span<gsl::byte> position) {
+      throw_assert(false, "a state vector resident model is never serialized");
+    }
+
+    virtual void deserialize(gsl::span<gsl::byte> position) {
+      throw_assert(false, "a state vector resident model is never deserialized");
+    }
+
+    virtual void resetToInitialState() {
+      getState().position = 0;
+      getState().finished = false;
+    }
+
+    virtual void step() {
+      auto& state = getState();
+      if (state.position == 0 ) {
+        state.position = choose( {3, 1} );
+      } else if (state.position == 1 ) {
+        state.position = 3;
+      }
+      state.finished = state.position == 3;
+    }
+  };
+
+  auto residentF1 = std::make_shared<CppFormula>([](CppModel* model) {
+      auto cppModel = static_cast<ResidentTestModel*>(model);
+      return cppModel->getState().finished;
+    }, "residentF1" );
+
+  auto residentFormulas = std::vector<std::shared_ptr<Formula>>( {residentF1} );
+
+}
+
+TEST(pemcCpp_test, pemcCpp_with_state_vector_resident_model_test) {
+    for (auto calculateLabelsPerState : {false, true}) {
+      auto configuration = Configuration();
+      configuration.calculateLabelsPerState = calculateLabelsPerState;
+      configuration.choiceTreeThreads = calculateLabelsPerState ? 2 : 1;
+
+      auto modelCreator = [](){ return std::make_unique<ResidentTestModel>(); };
+
+      auto pemc = Pemc(configuration);
+      auto lmc = pemc.buildLmcFromExecutableModel(modelCreator, residentFormulas);
+
+      auto probability1 = pemc.calculateProbabilityToReachStateWithinBound(*lmc, residentF1, 0);
+      auto probability2 = pemc.calculateProbabilityToReachStateWithinBound(*lmc, residentF1, 1);
+
+      lmc->validate();
+
+      ASSERT_EQ(lmc->getStates().size(), 2) << "FAIL";
+      ASSERT_EQ(probabilityIsAround(probability1, 0.5, 0.0001), true) << "FAIL";
+      ASSERT_EQ(probabilityIsOne(probability2, 0.0001), true) << "FAIL";
+    }
+}
+
+namespace {
+
+  struct DiceState {
+    int32_t value;
+  };
+
+  // The dice of the examples with a statically known state layout.
+  class StaticDiceModel : public StaticCppModel<StaticDiceModel, DiceState> {
+  public:
+    void initialState(DiceState& state) {
+      state.value = 0;
+    }
+
+    void stepState(DiceState& state) {
+      if (state.value == 0) {
+        state.value = choose({123, 456});
+      } else if (state.value == 123) {
+        state.value = choose({12, 3123});
+      } else if (state.value == 12) {
+        state.value = choose({1, 2});
+      } else if (state.value == 3123) {
+        state.value = choose({3, 123});
+      } else if (state.value == 456) {
+        state.value = choose({45, 6456});
+      } else if (state.value == 45) {
+        state.value = choose({4, 5});
+      } else if (state.value == 6456) {
+        state.value = choose({6, 456});
+      }
+    }
+  };
+
+  auto diceIs3 = std::make_shared<CppFormula>([](CppModel* model) {
+      return static_cast<StaticDiceModel*>(model)->getState().value == 3;
+    }, "diceIs3" );
+
+}
+
+TEST(pemcCpp_test, pemcCpp_with_static_model_test) {
+    static_assert(StaticDiceModel::StateVectorSize == sizeof(int32_t), "state layout");
+
+    auto configuration = Configuration();
+    auto modelCreator = [](){ return std::make_unique<StaticDiceModel>(); };
+
+    auto pemc = Pemc(configuration);
+    auto lmc = pemc.buildLmcFromExecutableModel(modelCreator, std::vector<std::shared_ptr<Formula>>( {diceIs3} ));
+
+    auto probability = pemc.calculateProbabilityToReachStateWithinBound(*lmc, diceIs3, 50);
+
+    lmc->validate();
+
+    // 123, 456, 12, 3123, 45, 6456, 1, ..., 6
+    ASSERT_EQ(lmc->getStates().size(), 12) << "FAIL";
+    ASSERT_EQ(probabilityIsAround(probability, 1.0 / 6.0, 0.0001), true) << "FAIL";
+}
+
+namespace {
+
+  enum class Mode : uint8_t { Off, Standby, On };
+
+  // A counter that counts up to 99 while the mode is On and may fail.
+  class PackedTestModel : public PackedCppModel {
+  public:
+    int32_t counter = 0;
+    Mode mode = Mode::Off;
+    bool failed = false;
+    int16_t temperature = -40;
+
+    PackedTestModel() {
+      addStateVariable(counter, 0, 99, "counter");
+      addStateVariable(mode, Mode::Off, Mode::On, "mode");
+      addStateVariable(failed, false, true, "failed");
+      addStateVariable(temperature, int16_t(-40), int16_t(85), "temperature");
+    }
+
+    int32_t getNumberOfBits() {
+      return stateVariables.getNumberOfBits();
+    }
+
+    virtual void resetToInitialState() {
+      counter = 0;
+      mode = Mode::Off;
+      failed = false;
+      temperature = -40;
+    }
+
+    virtual void step() {
+      if (failed)
+        return;
+      if (mode == Mode::Off) {
+        mode = choose( {Mode::Standby, Mode::On} );
+      } else if (mode == Mode::Standby) {
+        mode = Mode::On;
+      } else if (counter < 99) {
+        counter++;
+        temperature = static_cast<int16_t>(temperature + 1);
+        failed = choose( {false, false, false, true} );
+      }
+    }
+  };
+
+  auto counterFinished = std::make_shared<CppFormula>([](CppModel* model) {
+      return static_cast<PackedTestModel*>(model)->counter == 99;
+    }, "counterFinished" );
+
+}
+
+TEST(pemcCpp_test, pemcCpp_packed_state_variables_test) {
+    auto model = PackedTestModel();
+    // 7 bits for the counter, 2 for the mode, 1 for failed and 7 for the
+    // temperature instead of 4+1+1+2 bytes.
+    ASSERT_EQ(model.getNumberOfBits(), 17) << "FAIL";
+    ASSERT_EQ(model.getStateVectorSize(), 3) << "FAIL";
+
+    auto stateVector = std::vector<gsl::byte>(3);
+    model.counter = 98;
+    model.mode = Mode::On;
+    model.failed = true;
+    model.temperature = 85;
+    model.serialize(stateVector);
+    model.resetToInitialState();
+    model.deserialize(stateVector);
+    ASSERT_EQ(model.counter, 98) << "FAIL";
+    ASSERT_EQ(model.mode == Mode::On, true) << "FAIL";
+    ASSERT_EQ(model.failed, true) << "FAIL";
+    ASSERT_EQ(model.temperature, 85) << "FAIL";
+
+    model.temperature = -41;
+    ASSERT_THROW(model.serialize(stateVector), AssertionFailureException) << "FAIL";
+
+    auto configuration = Configuration();
+    auto modelCreator = [](){ return std::make_unique<PackedTestModel>(); };
+    auto pemc = Pemc(configuration);
+    auto lmc = pemc.buildLmcFromExecutableModel(modelCreator, std::vector<std::shared_ptr<Formula>>( {counterFinished} ));
+    lmc->validate();
+
+    auto probability = pemc.calculateProbabilityToReachStateWithinBound(*lmc, counterFinished, 200);
+    // The 99th increment reaches 99 even if the counter fails in that step.
+    ASSERT_NEAR(probability.value / std::pow(0.75, 98), 1.0, 0.0001) << "FAIL";
+}
@@ -422,7 +422,7 @@ static void setup_model_functions(pemc_model_functions* _model_functions) {
 // Main functionality
 static PyObject* py_check_reachability_in_executable_model(PyObject* self,
                                                            PyObject* args) {
-  pemc_model_functions model_functions;
+  pemc_model_functions model_functions = {0};
   setup_model_functions(&model_functions);
 
   pemc_formula_ref* f1 = pemc_function_accessor.pemc_register_basic_formula(
@@ -443,7 +443,7 @@ static PyObject* py_check_reachability_in_executable_model(PyObject* self,
 
 static PyObject* py_build_lmc_from_executable_model(PyObject* self,
                                                     PyObject* args) {
-  pemc_model_functions model_functions;
+  pemc_model_functions model_functions = {0};
   setup_model_functions(&model_functions);
 
   pemc_formula_ref* f1 = pemc_function_accessor.pemc_register_basic_formula(
@@ -0,0 +1,158 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef PEMC_BASIC_CHUNKED_ARRAY_H_
+#define PEMC_BASIC_CHUNKED_ARRAY_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+#include "pemc/basic/ThrowAssert.hpp"
+#include "pemc/basic/raw_memory.h"
+
+namespace pemc {
+
+/// <summary>
+///   Array that grows on demand without moving its elements. Chunk 0 contains
+///   the first firstChunkCapacity elements, chunk j>0 contains the next
+///   firstChunkCapacity << (j-1) elements (the layout of the state memory of
+///   StateStorage). Multiple threads may grow the array and access different
+///   elements at the same time. An element may only be accessed after the
+///   array has been grown to contain it.
+/// </summary>
+template <typename T>
+class ChunkedArray {
+ private:
+  static const size_t MaximalChunks = 64;
+
+  size_t firstChunkCapacity = 0;
+  size_t maximalCapacity = 0;
+  std::atomic<size_t> allocatedCapacity{0};
+  size_t allocatedChunks = 0;
+
+  // If set, new chunks are filled with fillValue.
+  bool fill = false;
+  T fillValue{};
+
+  std::array<UninitializedVector<T>, MaximalChunks> chunkMemory;
+  std::array<std::atomic<T*>, MaximalChunks> chunks{};
+  std::mutex growMutex;
+
+  void allocateChunk() {
+    auto chunkCapacity =
+        allocatedChunks == 0 ? firstChunkCapacity
+                             : firstChunkCapacity << (allocatedChunks - 1);
+    auto oldCapacity = allocatedCapacity.load(std::memory_order_relaxed);
+    chunkCapacity = std::min(chunkCapacity, maximalCapacity - oldCapacity);
+    auto& memory = chunkMemory[allocatedChunks];
+    memory.resize(chunkCapacity);
+    if (fill)
+      std::fill(memory.begin(), memory.end(), fillValue);
+    chunks[allocatedChunks].store(memory.data(), std::memory_order_relaxed);
+    ++allocatedChunks;
+    allocatedCapacity.store(oldCapacity + chunkCapacity,
+                            std::memory_order_release);
+  }
+
+ public:
+  // Releases all elements. If initialCapacity is smaller than maximalCapacity,
+  // the first chunk gets the next power of two and further chunks are
+  // allocated by grow().
+  void reset(size_t initialCapacity, size_t maximalCapacity) {
+    throw_assert(initialCapacity <= maximalCapacity, "capacity invalid");
+    release();
+    this->maximalCapacity = maximalCapacity;
+    firstChunkCapacity = 1;
+    while (firstChunkCapacity < initialCapacity)
+      firstChunkCapacity <<= 1;
+    if (firstChunkCapacity >= maximalCapacity)
+      firstChunkCapacity = std::max(maximalCapacity, size_t(1));
+    if (maximalCapacity > 0)
+      allocateChunk();
+  }
+
+  void setFillValue(const T& value) {
+    fill = true;
+    fillValue = value;
+  }
+
+  // Makes sure that the elements with index smaller than capacity can be
+  // accessed. capacity must not exceed the maximal capacity.
+  void grow(size_t capacity) {
+    if (capacity <= allocatedCapacity.load(std::memory_order_acquire))
+      return;
+    throw_assert(capacity <= maximalCapacity, "capacity exceeded");
+    std::lock_guard<std::mutex> lock(growMutex);
+    while (allocatedCapacity.load(std::memory_order_relaxed) < capacity)
+      allocateChunk();
+  }
+
+  T& operator[](size_t index) {
+    if (index < firstChunkCapacity)
+      return chunks[0].load(std::memory_order_relaxed)[index];
+    auto chunk = size_t(1);
+    auto chunkStart = firstChunkCapacity;
+    while (index - chunkStart >= chunkStart) {
+      chunkStart <<= 1;
+      ++chunk;
+    }
+    return chunks[chunk].load(std::memory_order_relaxed)[index - chunkStart];
+  }
+
+  size_t getAllocatedCapacity() { return allocatedCapacity.load(); }
+
+  // Copies the first count elements to destination and releases all
+  // elements. Each chunk is released as soon as it has been copied.
+  void moveTo(T* destination, size_t count) {
+    throw_assert(count <= allocatedCapacity.load(), "count invalid");
+    size_t chunkStart = 0;
+    for (size_t chunk = 0; chunk < allocatedChunks; ++chunk) {
+      auto& memory = chunkMemory[chunk];
+      auto toCopy = std::min(memory.size(), count - std::min(count, chunkStart));
+      if (toCopy > 0)
+        std::copy(memory.begin(), memory.begin() + toCopy,
+                  destination + chunkStart);
+      chunkStart += memory.size();
+      UninitializedVector<T>().swap(memory);
+      chunks[chunk].store(nullptr, std::memory_order_relaxed);
+    }
+    release();
+  }
+
+  void release() {
+    for (size_t chunk = 0; chunk < allocatedChunks; ++chunk) {
+      UninitializedVector<T>().swap(chunkMemory[chunk]);
+      chunks[chunk].store(nullptr, std::memory_order_relaxed);
+    }
+    allocatedChunks = 0;
+    allocatedCapacity = 0;
+  }
+};
+
+}  // namespace pemc
+
+#endif  // PEMC_BASIC_CHUNKED_ARRAY_H_
@@ -27,11 +27,50 @@
 
 #include <functional>
 #include <iostream>
+#include <string>
 
 #include "pemc/basic/model_capacity.h"
 
 namespace pemc {
 
+// Determines how the GenericTraverser remembers the states it has found.
+enum class StateStorageType {
+  // Stores every state vector. Required to build an Lmc.
+  Exact,
+  // Sets some bits per state in a bit table (Bloom filter). Lossy.
+  Bitstate,
+  // Stores a 64 bit fingerprint per state. Lossy.
+  HashCompaction
+};
+
+// Determines the order in which the GenericTraverser explores the states.
+enum class TraversalStrategy {
+  // Work-stealing depth-first search using a PathTracker per worker.
+  DepthFirst,
+  // Level-synchronous breadth-first search. The workers expand one layer in
+  // parallel and wait for each other before the next layer. The depth of each
+  // state is known (see GenericTraverser::getStateDepth).
+  BreadthFirst
+};
+
+// Determines how LmcModelChecker stores the iteration matrix.
+enum class LmcMatrixFormat {
+  // Compressed sparse rows.
+  Csr,
+  // SELL-C-sigma: chunks of rows stored column by column, so that each SIMD
+  // lane computes one row. Suits wide SIMD better if the rows are short.
+  SellCSigma
+};
+
+// Determines how LmcModelChecker solves unbounded until formulas.
+enum class LmcIterativeSolver {
+  // x' = A x + b with two vectors. Runs on lmcModelCheckingThreads threads.
+  Jacobi,
+  // Updates x in place, so a row reads the values of the rows before it from
+  // the same iteration. Needs fewer iterations, but runs on one thread.
+  GaussSeidel
+};
+
 struct Configuration {
   // Output stream to write output to.
   // Note: Memory of cout is not managed. If memory management is required,
@@ -44,8 +83,102 @@ struct Configuration {
 
   int32_t maximalSearchDepth = 1 << 20;
 
+  // The initial number of successors of a state the ModelExecutor can hold.
+  // Grows if a state has more successors.
   int32_t successorCapacity = 1 << 14;
 
+  // Number of workers that traverse the state space in parallel. Each worker
+  // runs in its own thread and has its own instance of the model.
+  int32_t numberOfWorkers = 1;
+
+  // Merge the transitions of a state that lead to the same target state with
+  // the same label before the target states are added to the state storage
+  // (see MergeIdenticalSuccessorsModifier). Only used to build an Lmc.
+  bool mergeIdenticalSuccessors = true;
+
+  // Calculate the label of each state once, when the state is found, instead
+  // of once per transition. Only valid if the formulas depend on the
+  // serialized state of the model alone. Only supported by the
+  // GenericTraverser with an exact state storage and if no pre state storage
+  // modifier requires labels (otherwise, the labels are calculated per
+  // transition).
+  bool calculateLabelsPerState = false;
+
+  // Number of threads that enumerate the choice tree of a single state in
+  // parallel, each with its own instance of the model. Only pays off for
+  // models with very many successors per state, because the choice tree of
+  // every state is split into prefixes first. Used per worker, so up to
+  // numberOfWorkers * choiceTreeThreads threads run. 1 disables it.
+  int32_t choiceTreeThreads = 1;
+
+  TraversalStrategy traversalStrategy = TraversalStrategy::DepthFirst;
+
+  // If not negative, only the states up to this depth are expanded (requires
+  // a breadth-first traversal). Transitions to states beyond the horizon lead
+  // to the stuttering state instead. See
+  // Pemc::buildLmcFromExecutableModel(..., horizon).
+  int32_t traversalHorizon = -1;
+
+  // Store the state vectors tree compressed. Saves memory on models with wide
+  // state vectors, of which most parts are shared with other states.
+  bool compressStateVectors = false;
+
+  // Derive the hash of each successor from the hash of its source state and
+  // the words of the state vector that differ (see updateLinearHash64),
+  // instead of hashing the whole state vector. Pays off for wide state
+  // vectors of which a step changes only a few words. Only supported by the
+  // exact state storage without tree compression.
+  bool incrementalStateHashing = false;
+
+  // Lossy state storages may omit states, but need far less memory. They are
+  // only used for reachability checks, which report the estimated omission
+  // probability.
+  StateStorageType stateStorageType = StateStorageType::Exact;
+
+  // Size of the bit table or the fingerprint table of lossy state storages.
+  int64_t lossyStateStorageMemory = 1 << 26;
+
+  // Number of bits set per state by StateStorageType::Bitstate.
+  int32_t bitstateHashFunctions = 3;
+
+  // Use the ExternalMemoryTraverser instead of the GenericTraverser. It keeps
+  // the found states on disk and thus supports state spaces larger than RAM.
+  bool useExternalMemoryTraverser = false;
+
+  // Directory for the temporary files of the ExternalMemoryTraverser. If
+  // empty, the temporary directory of the system is used.
+  std::string externalMemoryDirectory = "";
+
+  // Number of bytes the ExternalMemoryTraverser sorts in memory at once.
+  size_t externalMemoryBufferSize = 1 << 26;
+
+  // Storage format of the iteration matrix of LmcModelChecker. The rows of
+  // Lmcs are usually short, so a SIMD kernel per CSR row hardly pays off.
+  LmcMatrixFormat lmcMatrixFormat = LmcMatrixFormat::SellCSigma;
+
+  // Number of consecutive rows that SellCSigma sorts by their length (sigma)
+  // to reduce the padding of the chunks. Larger windows reduce the padding,
+  // but the rows are moved further away from the rows they read.
+  int32_t sellSortingScope = 256;
+
+  // Number of threads that calculate the iterations of LmcModelChecker. The
+  // rows are split into partitions with about the same number of
+  // transitions, one per thread.
+  int32_t lmcModelCheckingThreads = 1;
+
+  // Solver of unbounded until formulas.
+  LmcIterativeSolver lmcIterativeSolver = LmcIterativeSolver::Jacobi;
+
+  // The solver stops when the largest change of a state in an iteration is
+  // at most lmcAbsoluteTolerance, or when the largest change relative to the
+  // new value is at most lmcRelativeTolerance. 0 disables a criterion.
+  double lmcAbsoluteTolerance = 1e-9;
+  double lmcRelativeTolerance = 0.0;
+
+  // The solver gives up after this many iterations and reports the result
+  // as not converged.
+  int64_t lmcMaximalIterations = 1 << 20;
+
   std::shared_ptr<ModelCapacity> modelCapacity =
       std::make_shared<ModelCapacityByModelSize>(
           ModelCapacityByModelSize::Small());
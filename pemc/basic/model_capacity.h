@@ -51,24 +51,59 @@ class ModelCapacity {
 
   virtual StateIndex getMaximalStates() = 0;
 
+  // The number of states the state storage and the Lmc are allocated for
+  // initially. If it is smaller than getMaximalStates(), they grow on demand.
+  virtual StateIndex getInitialStates() { return getMaximalStates(); }
+
+  // The number of nodes of the tree compression of state vectors (only used
+  // if Configuration::compressStateVectors is set).
+  virtual int64_t getMaximalTreeNodes() {
+    return static_cast<int64_t>(getMaximalStates()) * 4;
+  }
+
   virtual TargetIndex getMaximalTargets() = 0;
 
+  // The number of targets the Lmc is allocated for initially. By default, it
+  // has the same ratio to getMaximalTargets() as getInitialStates() to
+  // getMaximalStates().
+  virtual TargetIndex getInitialTargets() {
+    auto maximalStates = getMaximalStates();
+    auto initialStates = getInitialStates();
+    if (maximalStates <= 0 || initialStates >= maximalStates)
+      return getMaximalTargets();
+    return static_cast<TargetIndex>(static_cast<double>(getMaximalTargets()) *
+                                    initialStates / maximalStates);
+  }
+
   virtual ChoiceIndex getMaximalChoices() = 0;
 };
 
 class ModelCapacityByModelSize : public ModelCapacity {
  private:
+  StateIndex initialStates = 0;
   StateIndex maximalStates = 0;
+  TargetIndex initialTargets = 0;
   TargetIndex maximalTargets = 0;
   ChoiceIndex maximalChoices = 0;
 
  public:
   virtual ~ModelCapacityByModelSize() = default;
 
+  // 0 means that the state storage and the Lmc are allocated for
+  // maximalStates at once.
+  void setInitialStates(StateIndex _initialStates) {
+    initialStates = _initialStates;
+  }
+
   void setMaximalStates(StateIndex _maximalStates) {
     maximalStates = _maximalStates;
   }
 
+  // 0 means that the Lmc derives its initial allocation from the states.
+  void setInitialTargets(TargetIndex _initialTargets) {
+    initialTargets = _initialTargets;
+  }
+
   void setMaximalTargets(TargetIndex _maximalTargets) {
     maximalTargets = _maximalTargets;
   }
@@ -77,8 +112,17 @@ class ModelCapacityByModelSize : public ModelCapacity {
     maximalChoices = _maximalChoices;
   }
 
+  virtual StateIndex getInitialStates() {
+    return initialStates > 0 ? initialStates : maximalStates;
+  };
+
   virtual StateIndex getMaximalStates() { return maximalStates; };
 
+  virtual TargetIndex getInitialTargets() {
+    return initialTargets > 0 ? initialTargets
+                              : ModelCapacity::getInitialTargets();
+  };
+
   virtual TargetIndex getMaximalTargets() {
     // Remind: Transition = Target + Probability
     return maximalTargets;
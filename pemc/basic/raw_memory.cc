@@ -22,12 +22,31 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <array>
 #include <string>
+#include <cstring>
 #include <stdio.h>
 #include <functional>
+#include <utility>
 
 #include "pemc/basic/raw_memory.h"
 
+#if defined(_MSC_VER)
+#define PEMC_FORCE_INLINE __forceinline
+#else
+#define PEMC_FORCE_INLINE inline __attribute__((always_inline))
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define PEMC_X86_64
+#include <immintrin.h>
+#endif
+
+// AVX2 is selected at runtime. Requires the target attribute of gcc and clang.
+#if defined(PEMC_X86_64) && (defined(__GNUC__) || defined(__clang__))
+#define PEMC_RUNTIME_AVX2
+#endif
+
 namespace pemc {
 
     void deleter(void *data) {
@@ -48,6 +67,78 @@ namespace pemc {
 
 
 
+    namespace {
+      // Scalar comparison for the bytes the vector loops leave over.
+      // memcpy instead of reinterpret_cast, because the buffers might be
+      // unaligned.
+      inline bool areBytesEqualScalar(gsl::byte* buffer1, gsl::byte* buffer2, size_t sizeInBytes) {
+        for (; sizeInBytes >= 8; sizeInBytes -= 8) {
+          uint64_t word1, word2;
+          std::memcpy(&word1, buffer1, 8);
+          std::memcpy(&word2, buffer2, 8);
+          if (word1 != word2)
+            return false;
+          buffer1 += 8;
+          buffer2 += 8;
+        }
+        for (; sizeInBytes > 0; --sizeInBytes) {
+          if (*buffer1 != *buffer2)
+            return false;
+          buffer1 += 1;
+          buffer2 += 1;
+        }
+        return true;
+      }
+
+#if defined(PEMC_X86_64)
+      // SSE2 is part of every x86-64 processor.
+      bool areBuffersEqualSse2(gsl::byte* buffer1, gsl::byte* buffer2, size_t sizeInBytes) {
+        for (; sizeInBytes >= 16; sizeInBytes -= 16) {
+          auto block1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer1));
+          auto block2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer2));
+          if (_mm_movemask_epi8(_mm_cmpeq_epi8(block1, block2)) != 0xFFFF)
+            return false;
+          buffer1 += 16;
+          buffer2 += 16;
+        }
+        return areBytesEqualScalar(buffer1, buffer2, sizeInBytes);
+      }
+#endif
+
+#if defined(PEMC_RUNTIME_AVX2)
+      __attribute__((target("avx2")))
+      bool areBuffersEqualAvx2(gsl::byte* buffer1, gsl::byte* buffer2, size_t sizeInBytes) {
+        for (; sizeInBytes >= 32; sizeInBytes -= 32) {
+          auto block1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buffer1));
+          auto block2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buffer2));
+          auto difference = _mm256_xor_si256(block1, block2);
+          if (!_mm256_testz_si256(difference, difference))
+            return false;
+          buffer1 += 32;
+          buffer2 += 32;
+        }
+        return areBuffersEqualSse2(buffer1, buffer2, sizeInBytes);
+      }
+#endif
+
+      using AreBuffersEqualFunction = bool (*)(gsl::byte*, gsl::byte*, size_t);
+
+      // Selects the widest implementation the processor supports.
+      AreBuffersEqualFunction selectAreBuffersEqual() {
+#if defined(PEMC_RUNTIME_AVX2)
+        if (__builtin_cpu_supports("avx2"))
+          return &areBuffersEqualAvx2;
+#endif
+#if defined(PEMC_X86_64)
+        return &areBuffersEqualSse2;
+#else
+        return &areBytesEqualScalar;
+#endif
+      }
+
+      const AreBuffersEqualFunction areBuffersEqualImplementation = selectAreBuffersEqual();
+    }
+
     /// <summary>
     ///   Compares the two buffers <paramref name="buffer1" /> and <paramref name="buffer2" />, returning <c>true</c> when the
     ///   buffers are equivalent.
@@ -58,34 +149,7 @@ namespace pemc {
     bool areBuffersEqual(gsl::byte* buffer1, gsl::byte* buffer2, size_t sizeInBytes) {
       if (buffer1 == buffer2)
         return true;
-
-      for (auto i = sizeInBytes / 8; i > 0; --i) {
-        if (* reinterpret_cast<int64_t*>(buffer1) != * reinterpret_cast<int64_t*>(buffer2))
-          return false;
-
-        buffer1 += 8;
-        buffer2 += 8;
-      }
-
-      auto remaining = sizeInBytes % 8;
-      if (remaining >= 4) {
-        if (* reinterpret_cast<int32_t*>(buffer1) != * reinterpret_cast<int32_t*>(buffer2))
-          return false;
-
-        buffer1 += 4;
-        buffer2 += 4;
-        remaining -= 4;
-      }
-
-      for (auto i = 0; i < remaining; ++i) {
-        if (*buffer1 != *buffer2)
-          return false;
-
-        buffer1 += 1;
-        buffer2 += 1;
-      }
-
-      return true;
+      return areBuffersEqualImplementation(buffer1, buffer2, sizeInBytes);
     }
 
     /// <summary>
@@ -94,29 +158,10 @@ namespace pemc {
     /// <param name="source">The first buffer of memory to compare.</param>
     /// <param name="destination">The second buffer of memory to compare.</param>
     /// <param name="sizeInBytes">The size of the buffers in bytes.</param>
+    /// <remarks>memcpy of the C library already selects a vectorized
+    /// implementation for the processor at runtime.</remarks>
     void copyBuffers(gsl::byte* source, gsl::byte* destination, size_t sizeInBytes) {
-      for (auto i = sizeInBytes / 8; i > 0; --i) {
-        * reinterpret_cast<int64_t*>(destination) = * reinterpret_cast<int64_t*>(source);
-
-        source += 8;
-        destination += 8;
-      }
-
-      auto remaining = sizeInBytes % 8;
-      if (remaining >= 4) {
-        * reinterpret_cast<int32_t*>(destination) = * reinterpret_cast<int32_t*>(source);
-
-        source += 4;
-        destination += 4;
-        remaining -= 4;
-      }
-
-      for (auto i = 0; i < remaining; ++i) {
-        *destination = *source;
-
-        source += 1;
-        destination += 1;
-      }
+      std::memcpy(destination, source, sizeInBytes);
     }
 
     /// <summary>
@@ -173,4 +218,192 @@ namespace pemc {
 
       return hash;
     }
+
+    namespace {
+      const uint64_t Prime64_1 = 0x9E3779B185EBCA87ULL;
+      const uint64_t Prime64_2 = 0xC2B2AE3D27D4EB4FULL;
+      const uint64_t Prime64_3 = 0x165667B19E3779F9ULL;
+      const uint64_t Prime64_4 = 0x85EBCA77C2B2AE63ULL;
+      const uint64_t Prime64_5 = 0x27D4EB2F165667C5ULL;
+
+      inline uint64_t rotateLeft(uint64_t value, int32_t bits) {
+        return (value << bits) | (value >> (64 - bits));
+      }
+
+      // memcpy instead of reinterpret_cast, because buffer might be unaligned.
+      inline uint64_t read64(gsl::byte* buffer) {
+        uint64_t value;
+        std::memcpy(&value, buffer, sizeof(value));
+        return value;
+      }
+
+      inline uint32_t read32(gsl::byte* buffer) {
+        uint32_t value;
+        std::memcpy(&value, buffer, sizeof(value));
+        return value;
+      }
+
+      inline uint64_t round64(uint64_t accumulator, uint64_t input) {
+        accumulator += input * Prime64_2;
+        accumulator = rotateLeft(accumulator, 31);
+        return accumulator * Prime64_1;
+      }
+
+      inline uint64_t mergeRound64(uint64_t hash, uint64_t accumulator) {
+        hash ^= round64(0, accumulator);
+        return hash * Prime64_1 + Prime64_4;
+      }
+
+      // Always inlined, so calls with a constant sizeInBytes are unrolled.
+      PEMC_FORCE_INLINE uint64_t hashBuffer64Inline(gsl::byte* buffer, size_t sizeInBytes, uint64_t seed) {
+        auto end = buffer + sizeInBytes;
+        uint64_t hash;
+
+        if (sizeInBytes >= 32) {
+          auto limit = end - 32;
+          uint64_t v1 = seed + Prime64_1 + Prime64_2;
+          uint64_t v2 = seed + Prime64_2;
+          uint64_t v3 = seed;
+          uint64_t v4 = seed - Prime64_1;
+          do {
+            v1 = round64(v1, read64(buffer));
+            v2 = round64(v2, read64(buffer + 8));
+            v3 = round64(v3, read64(buffer + 16));
+            v4 = round64(v4, read64(buffer + 24));
+            buffer += 32;
+          } while (buffer <= limit);
+
+          hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+          hash = mergeRound64(hash, v1);
+          hash = mergeRound64(hash, v2);
+          hash = mergeRound64(hash, v3);
+          hash = mergeRound64(hash, v4);
+        } else {
+          hash = seed + Prime64_5;
+        }
+
+        hash += static_cast<uint64_t>(sizeInBytes);
+
+        while (buffer + 8 <= end) {
+          hash ^= round64(0, read64(buffer));
+          hash = rotateLeft(hash, 27) * Prime64_1 + Prime64_4;
+          buffer += 8;
+        }
+
+        if (buffer + 4 <= end) {
+          hash ^= static_cast<uint64_t>(read32(buffer)) * Prime64_1;
+          hash = rotateLeft(hash, 23) * Prime64_2 + Prime64_3;
+          buffer += 4;
+        }
+
+        while (buffer < end) {
+          hash ^= static_cast<uint64_t>(*buffer) * Prime64_5;
+          hash = rotateLeft(hash, 11) * Prime64_1;
+          buffer += 1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= Prime64_2;
+        hash ^= hash >> 29;
+        hash *= Prime64_3;
+        hash ^= hash >> 32;
+
+        return hash;
+      }
+
+      // The size argument of the specialised operations is ignored, so the
+      // size is a compile time constant and the loops are unrolled.
+      template<size_t SizeInBytes>
+      bool areBuffersOfSizeEqual(gsl::byte* buffer1, gsl::byte* buffer2, size_t) {
+        return std::memcmp(buffer1, buffer2, SizeInBytes) == 0;
+      }
+
+      template<size_t SizeInBytes>
+      void copyBuffersOfSize(gsl::byte* source, gsl::byte* destination, size_t) {
+        std::memcpy(destination, source, SizeInBytes);
+      }
+
+      template<size_t SizeInBytes>
+      uint64_t hashBufferOfSize64(gsl::byte* buffer, size_t, uint64_t seed) {
+        return hashBuffer64Inline(buffer, SizeInBytes, seed);
+      }
+
+      // The number of specialised sizes. Sizes 4, 8, ..., 4*SpecialisedSizes
+      // are specialised.
+      const size_t SpecialisedSizes = 16;
+
+      template<size_t... Multiples>
+      std::array<StateVectorOperations, sizeof...(Multiples)> createSpecialisedStateVectorOperations(std::index_sequence<Multiples...>) {
+        return {StateVectorOperations{
+          (Multiples + 1) * 4,
+          &areBuffersOfSizeEqual<(Multiples + 1) * 4>,
+          &copyBuffersOfSize<(Multiples + 1) * 4>,
+          &hashBufferOfSize64<(Multiples + 1) * 4>}...};
+      }
+
+      const auto specialisedStateVectorOperations =
+        createSpecialisedStateVectorOperations(std::make_index_sequence<SpecialisedSizes>());
+    }
+
+    /// <summary>
+    ///   Hashes the <paramref name="buffer" /> to 64 bits.
+    /// </summary>
+    /// <param name="buffer">The buffer of memory that should be hashed.</param>
+    /// <param name="sizeInBytes">The size of the buffer in bytes.</param>
+    /// <param name="seed">The seed value for the hash.</param>
+    /// <remarks>See also https://github.com/Cyan4973/xxHash (XXH64 algorithm)</remarks>
+    uint64_t hashBuffer64(gsl::byte* buffer, size_t sizeInBytes, uint64_t seed) {
+      return hashBuffer64Inline(buffer, sizeInBytes, seed);
+    }
+
+    namespace {
+      // Reads the word at wordIndex. The last word is filled with zeros.
+      inline uint64_t readWord(gsl::byte* buffer, size_t sizeInBytes, size_t wordIndex) {
+        auto offset = wordIndex * 8;
+        if (offset + 8 <= sizeInBytes)
+          return read64(buffer + offset);
+        uint64_t value = 0;
+        std::memcpy(&value, buffer + offset, sizeInBytes - offset);
+        return value;
+      }
+
+      inline uint64_t hashWord(uint64_t word, size_t wordIndex) {
+        // The key of each position is not 0, so words of zeros count, too.
+        return mixBits64(word ^ ((wordIndex + 1) * 0x9E3779B97F4A7C15ULL));
+      }
+    }
+
+    uint64_t hashBufferLinear64(gsl::byte* buffer, size_t sizeInBytes) {
+      uint64_t hash = 0;
+      auto numberOfWords = (sizeInBytes + 7) / 8;
+      for (size_t i = 0; i < numberOfWords; ++i)
+        hash ^= hashWord(readWord(buffer, sizeInBytes, i), i);
+      return hash;
+    }
+
+    uint64_t updateLinearHash64(uint64_t hash, gsl::byte* oldBuffer, gsl::byte* newBuffer, size_t sizeInBytes) {
+      auto numberOfWords = (sizeInBytes + 7) / 8;
+      for (size_t i = 0; i < numberOfWords; ++i) {
+        auto oldWord = readWord(oldBuffer, sizeInBytes, i);
+        auto newWord = readWord(newBuffer, sizeInBytes, i);
+        if (oldWord != newWord)
+          hash ^= hashWord(oldWord, i) ^ hashWord(newWord, i);
+      }
+      return hash;
+    }
+
+    StateVectorOperations getStateVectorOperations(size_t sizeInBytes) {
+      if (sizeInBytes > 0 && sizeInBytes % 4 == 0 && sizeInBytes / 4 <= SpecialisedSizes)
+        return specialisedStateVectorOperations[sizeInBytes / 4 - 1];
+      return StateVectorOperations{sizeInBytes, &areBuffersEqual, &copyBuffers, &hashBuffer64};
+    }
+
+    uint64_t mixBits64(uint64_t value) {
+      value ^= value >> 33;
+      value *= 0xff51afd7ed558ccdULL;
+      value ^= value >> 33;
+      value *= 0xc4ceb9fe1a85ec53ULL;
+      value ^= value >> 33;
+      return value;
+    }
 }
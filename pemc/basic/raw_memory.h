@@ -25,8 +25,14 @@
 #ifndef PEMC_BASIC_RAW_MEMORY_H_
 #define PEMC_BASIC_RAW_MEMORY_H_
 
+#include <cstdint>
+#include <functional>
 #include <gsl/gsl_byte>
 #include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace pemc {
 
@@ -72,6 +78,113 @@ void copyBuffers(gsl::byte* source, gsl::byte* destination, size_t sizeInBytes);
 /// implementation)</remarks>
 uint32_t hashBuffer(gsl::byte* buffer, size_t sizeInBytes, int32_t seed);
 
+/// <summary>
+///   Hashes the <paramref name="buffer" /> to 64 bits.
+/// </summary>
+/// <param name="buffer">The buffer of memory that should be hashed.</param>
+/// <param name="sizeInBytes">The size of the buffer in bytes.</param>
+/// <param name="seed">The seed value for the hash.</param>
+/// <remarks>See also https://github.com/Cyan4973/xxHash (XXH64 algorithm).
+/// Four independent accumulators process 32 bytes per iteration, which keeps
+/// the multipliers of the CPU busy.</remarks>
+uint64_t hashBuffer64(gsl::byte* buffer, size_t sizeInBytes, uint64_t seed);
+
+/// <summary>
+///   Hashes the <paramref name="buffer" /> to 64 bits such that the hash can be
+///   updated incrementally (see updateLinearHash64). The hash is the xor of
+///   the mixed 8 byte words of the buffer, each combined with its position.
+/// </summary>
+/// <param name="buffer">The buffer of memory that should be hashed.</param>
+/// <param name="sizeInBytes">The size of the buffer in bytes.</param>
+/// <remarks>Zobrist hashing with a mixing function instead of a table,
+/// because the words are too large for tables.</remarks>
+uint64_t hashBufferLinear64(gsl::byte* buffer, size_t sizeInBytes);
+
+/// <summary>
+///   Returns hashBufferLinear64(<paramref name="newBuffer" />) given the hash
+///   of <paramref name="oldBuffer" />. Only the words that differ are hashed.
+/// </summary>
+/// <param name="hash">The linear hash of oldBuffer.</param>
+/// <param name="oldBuffer">The buffer with the known hash.</param>
+/// <param name="newBuffer">The buffer whose hash is requested.</param>
+/// <param name="sizeInBytes">The size of both buffers in bytes.</param>
+uint64_t updateLinearHash64(uint64_t hash,
+                            gsl::byte* oldBuffer,
+                            gsl::byte* newBuffer,
+                            size_t sizeInBytes);
+
+/// <summary>
+///   Compares, copies and hashes state vectors of a fixed size. For small
+///   sizes that are a multiple of 4, the operations are instantiated with the
+///   size as compile time constant, so they are unrolled and need no loop.
+///   Other sizes use the functions above. The results equal the results of
+///   areBuffersEqual, copyBuffers and hashBuffer64.
+/// </summary>
+struct StateVectorOperations {
+  size_t sizeInBytes;
+  bool (*areEqualFunction)(gsl::byte*, gsl::byte*, size_t);
+  void (*copyFunction)(gsl::byte*, gsl::byte*, size_t);
+  uint64_t (*hashFunction)(gsl::byte*, size_t, uint64_t);
+
+  bool areEqual(gsl::byte* buffer1, gsl::byte* buffer2) const {
+    return areEqualFunction(buffer1, buffer2, sizeInBytes);
+  }
+
+  void copy(gsl::byte* source, gsl::byte* destination) const {
+    copyFunction(source, destination, sizeInBytes);
+  }
+
+  uint64_t hash64(gsl::byte* buffer, uint64_t seed) const {
+    return hashFunction(buffer, sizeInBytes, seed);
+  }
+};
+
+/// <summary>
+///   Returns the operations for state vectors of <paramref
+///   name="sizeInBytes" /> bytes.
+/// </summary>
+StateVectorOperations getStateVectorOperations(size_t sizeInBytes);
+
+/// <summary>
+///   Mixes the bits of <paramref name="value" /> (finalizer of MurmurHash3).
+///   Cheap way to derive further hash values from a 64 bit hash.
+/// </summary>
+uint64_t mixBits64(uint64_t value);
+
+/// <summary>
+///   Allocator that default-initializes the elements std::vector::resize
+///   creates instead of value-initializing them. Elements of trivial types
+///   stay uninitialized, so the pages of a large vector are placed near the
+///   thread that writes to them first (first-touch placement on NUMA
+///   systems).
+/// </summary>
+template <typename T>
+class UninitializedAllocator : public std::allocator<T> {
+ public:
+  template <typename U>
+  struct rebind {
+    using other = UninitializedAllocator<U>;
+  };
+
+  UninitializedAllocator() = default;
+  template <typename U>
+  UninitializedAllocator(const UninitializedAllocator<U>&) noexcept {}
+
+  template <typename U>
+  void construct(U* pointer) noexcept(
+      std::is_nothrow_default_constructible<U>::value) {
+    ::new (static_cast<void*>(pointer)) U;
+  }
+
+  template <typename U, typename... TArgs>
+  void construct(U* pointer, TArgs&&... args) {
+    ::new (static_cast<void*>(pointer)) U(std::forward<TArgs>(args)...);
+  }
+};
+
+template <typename T>
+using UninitializedVector = std::vector<T, UninitializedAllocator<T>>;
+
 }  // namespace pemc
 
 #endif  // PEMC_BASIC_RAW_MEMORY_H_
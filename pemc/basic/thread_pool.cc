@@ -0,0 +1,165 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "pemc/basic/thread_pool.h"
+
+#include <algorithm>
+
+#include "pemc/basic/ThrowAssert.hpp"
+
+namespace pemc {
+
+ThreadPool::ThreadPool(int32_t numberOfThreads)
+    : nextTask(0), exceptions(numberOfThreads) {
+  throw_assert(numberOfThreads >= 1, "At least one thread required");
+  threads.reserve(numberOfThreads - 1);
+  for (auto i = 1; i < numberOfThreads; ++i) {
+    threads.emplace_back([this, i]() { work(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  workAvailable.notify_all();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+int32_t ThreadPool::getNumberOfThreads() {
+  return static_cast<int32_t>(threads.size() + 1);
+}
+
+void ThreadPool::runTasks(int32_t threadIndex) {
+  try {
+    if (oneTaskPerThread) {
+      (*task)(threadIndex, threadIndex);
+      return;
+    }
+    auto taskIndex = nextTask.fetch_add(1);
+    while (taskIndex < numberOfTasks) {
+      (*task)(taskIndex, threadIndex);
+      taskIndex = nextTask.fetch_add(1);
+    }
+  } catch (...) {
+    exceptions[threadIndex] = std::current_exception();
+    // Let the other threads stop early.
+    nextTask.store(numberOfTasks);
+  }
+}
+
+void ThreadPool::work(int32_t threadIndex) {
+  int64_t lastGeneration = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      workAvailable.wait(lock, [&]() {
+        return stopping || generation != lastGeneration;
+      });
+      if (stopping)
+        return;
+      lastGeneration = generation;
+    }
+    runTasks(threadIndex);
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      --busyThreads;
+    }
+    workFinished.notify_one();
+  }
+}
+
+void ThreadPool::parallelFor(
+    int64_t _numberOfTasks,
+    const std::function<void(int64_t, int32_t)>& _task) {
+  if (threads.empty()) {
+    for (int64_t taskIndex = 0; taskIndex < _numberOfTasks; ++taskIndex) {
+      _task(taskIndex, 0);
+    }
+    return;
+  }
+  run(_numberOfTasks, _task, false);
+}
+
+void ThreadPool::runOnEveryThread(const std::function<void(int32_t)>& task) {
+  std::function<void(int64_t, int32_t)> taskOfThread =
+      [&task](int64_t, int32_t threadIndex) { task(threadIndex); };
+  if (threads.empty()) {
+    task(0);
+    return;
+  }
+  run(getNumberOfThreads(), taskOfThread, true);
+}
+
+void ThreadPool::run(int64_t _numberOfTasks,
+                     const std::function<void(int64_t, int32_t)>& _task,
+                     bool _oneTaskPerThread) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    task = &_task;
+    numberOfTasks = _numberOfTasks;
+    oneTaskPerThread = _oneTaskPerThread;
+    nextTask.store(0);
+    busyThreads = static_cast<int32_t>(threads.size());
+    ++generation;
+  }
+  workAvailable.notify_all();
+  runTasks(0);
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    workFinished.wait(lock, [&]() { return busyThreads == 0; });
+    task = nullptr;
+  }
+  for (auto& exception : exceptions) {
+    if (exception) {
+      auto firstException = exception;
+      std::fill(exceptions.begin(), exceptions.end(), nullptr);
+      std::rethrow_exception(firstException);
+    }
+  }
+}
+
+SpinningBarrier::SpinningBarrier(int32_t _numberOfThreads)
+    : numberOfThreads(_numberOfThreads) {
+  throw_assert(numberOfThreads >= 1, "At least one thread required");
+}
+
+void SpinningBarrier::arriveAndWait() {
+  auto generationOnArrival = generation.load(std::memory_order_acquire);
+  if (waitingThreads.fetch_add(1, std::memory_order_acq_rel) ==
+      numberOfThreads - 1) {
+    // The last thread releases the others.
+    waitingThreads.store(0, std::memory_order_relaxed);
+    generation.fetch_add(1, std::memory_order_acq_rel);
+    return;
+  }
+  while (generation.load(std::memory_order_acquire) == generationOnArrival) {
+    std::this_thread::yield();
+  }
+}
+
+}  // namespace pemc
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef PEMC_BASIC_THREAD_POOL_H_
+#define PEMC_BASIC_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pemc {
+
+// A fixed set of threads for data parallel loops. The thread that calls
+// parallelFor participates as thread 0, so a pool of n threads starts n-1
+// threads. The threads wait for work between the loops and are joined by the
+// destructor. parallelFor must not be called by multiple threads at once.
+class ThreadPool {
+ private:
+  std::vector<std::thread> threads;
+
+  std::mutex mutex;
+  std::condition_variable workAvailable;
+  std::condition_variable workFinished;
+  // incremented for each loop
+  int64_t generation = 0;
+  bool stopping = false;
+  int32_t busyThreads = 0;
+
+  // The current loop.
+  const std::function<void(int64_t, int32_t)>* task = nullptr;
+  int64_t numberOfTasks = 0;
+  std::atomic<int64_t> nextTask;
+  // Each thread runs the task with its own index once (runOnEveryThread).
+  bool oneTaskPerThread = false;
+  std::vector<std::exception_ptr> exceptions;
+
+  void work(int32_t threadIndex);
+  void runTasks(int32_t threadIndex);
+  void run(int64_t _numberOfTasks,
+           const std::function<void(int64_t, int32_t)>& _task,
+           bool _oneTaskPerThread);
+
+ public:
+  ThreadPool(int32_t numberOfThreads);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  int32_t getNumberOfThreads();
+
+  // Calls task(taskIndex, threadIndex) for every taskIndex in
+  // [0, _numberOfTasks) and blocks until all calls have returned. The tasks
+  // are distributed dynamically. threadIndex is in [0, getNumberOfThreads())
+  // and identifies the calling thread, e.g., to select per thread buffers.
+  // Rethrows the first exception thrown by a task.
+  void parallelFor(int64_t _numberOfTasks,
+                   const std::function<void(int64_t, int32_t)>& _task);
+
+  // Calls task(threadIndex) once on every thread and blocks until all calls
+  // have returned. In contrast to parallelFor, the work of each thread is
+  // fixed, so the data a thread touches first stays on its NUMA node, and
+  // all calls run at the same time, so they may wait for each other (see
+  // SpinningBarrier). Rethrows the first exception thrown by a task.
+  void runOnEveryThread(const std::function<void(int32_t)>& task);
+};
+
+// Barrier for the threads of runOnEveryThread, which meet very often, e.g.,
+// once per iteration of a numerical algorithm. The threads spin (and yield)
+// instead of sleeping, because the phases between the meetings are short.
+// A thread that throws between the meetings makes the others wait forever,
+// so the phases must not throw.
+class SpinningBarrier {
+ private:
+  const int32_t numberOfThreads;
+  std::atomic<int32_t> waitingThreads{0};
+  std::atomic<int64_t> generation{0};
+
+ public:
+  explicit SpinningBarrier(int32_t _numberOfThreads);
+
+  // Blocks until all numberOfThreads threads have called arriveAndWait.
+  // Writes before the call are visible to all threads after it.
+  void arriveAndWait();
+};
+
+}  // namespace pemc
+
+#endif  // PEMC_BASIC_THREAD_POOL_H_
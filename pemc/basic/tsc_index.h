@@ -29,10 +29,21 @@
 
 namespace pemc {
 
+// Models with more than 2^31 states or transitions need 64 bit indexes. They
+// are enabled with the build option large_indexes (defines
+// PEMC_LARGE_INDEXES). The number of elements of a single state (e.g., its
+// number of outgoing transitions) always fits into 32 bits.
+#ifdef PEMC_LARGE_INDEXES
+  using StateIndex = int64_t; // StateIndex must allow the value -1.
+  using TransitionIndex = int64_t;
+  using TargetIndex = int64_t;
+  using ChoiceIndex = int64_t;
+#else
   using StateIndex = int32_t; // StateIndex must allow the value -1.
   using TransitionIndex = int32_t;
   using TargetIndex = int32_t;
   using ChoiceIndex = int32_t;
+#endif
   using NoOfElements = int32_t;
 }
 
@@ -33,6 +33,10 @@
 
 using namespace pemc;
 
+static_assert(sizeof(pemc_index) == sizeof(StateIndex) &&
+                  sizeof(pemc_index) == sizeof(TransitionIndex),
+              "pemc_index does not match the index types of pemc");
+
 namespace {
 
 class CApiModel;
@@ -56,14 +60,19 @@ int32_t pemc_choose_by_no_of_options(
 class CApiModel : public AbstractModel {
  private:
   pemc_model_functions model_functions;
+  // NULL unless the model has been passed to an entry point for state vector
+  // resident models.
+  pemc_use_state_vector_function_type use_state_vector;
   pemc_model_specific_interface pemc_interface;
 
  public:
   unsigned char* model;
 
   CApiModel(pemc_model_functions _model_functions,
+            pemc_use_state_vector_function_type _use_state_vector,
             unsigned char* optional_value_for_model_create) {
     model_functions = _model_functions;
+    use_state_vector = _use_state_vector;
 
     pemc_interface.pemc_choose_by_no_of_options =
         (pemc_choose_by_no_of_options_function_type)
@@ -108,6 +117,16 @@ class CApiModel : public AbstractModel {
                    });
   }
 
+  virtual bool isStateVectorResident() {
+    return use_state_vector != nullptr;
+  }
+
+  virtual void useStateVector(gsl::span<gsl::byte> stateVector) {
+    use_state_vector(
+        model, reinterpret_cast<unsigned char*>(stateVector.data()),
+        stateVector.size_bytes());
+  }
+
   virtual void resetToInitialState() {
     model_functions.reset_to_initial_state(model);
   }
@@ -231,15 +250,21 @@ int32_t pemc_choose_by_no_of_options(
 
 // main functionality
 
-static int32_t check_reachability_in_executable_model(
+using CApiModelCreator = std::function<std::unique_ptr<AbstractModel>()>;
+
+static CApiModelCreator createCApiModelCreator(
     pemc_model_functions model_functions,
-    unsigned char* optional_value_for_model_create,
-    pemc_formula_ref* formula_ref) {
-  auto modelCreator = [&model_functions, &optional_value_for_model_create]() {
-    return std::make_unique<CApiModel>(model_functions,
+    pemc_use_state_vector_function_type use_state_vector,
+    unsigned char* optional_value_for_model_create) {
+  return [model_functions, use_state_vector,
+          optional_value_for_model_create]() {
+    return std::make_unique<CApiModel>(model_functions, use_state_vector,
                                        optional_value_for_model_create);
   };
+}
 
+static int32_t checkReachability(const CApiModelCreator& modelCreator,
+                                 pemc_formula_ref* formula_ref) {
   pemc_ref_formula(formula_ref);
   auto formula =
       *reinterpret_cast<std::shared_ptr<Formula>*>(formula_ref->formula);
@@ -253,16 +278,9 @@ static int32_t check_reachability_in_executable_model(
   return result;
 }
 
-static pemc_lmc_ref* build_lmc_from_executable_model(
-    pemc_model_functions model_functions,
-    unsigned char* optional_value_for_model_create,
-    const pemc_formula_ref** formulas,
-    int32_t num_formulas) {
-  auto modelCreator = [&model_functions, &optional_value_for_model_create]() {
-    return std::make_unique<CApiModel>(model_functions,
-                                       optional_value_for_model_create);
-  };
-
+static pemc_lmc_ref* buildLmc(const CApiModelCreator& modelCreator,
+                              const pemc_formula_ref** formulas,
+                              int32_t num_formulas) {
   // create a c++ array with the formulas
   std::vector<std::shared_ptr<Formula>> formulasAsVec;
   std::transform(
@@ -288,6 +306,53 @@ static pemc_lmc_ref* build_lmc_from_executable_model(
   return pemc_lmc;
 }
 
+static int32_t check_reachability_in_executable_model(
+    pemc_model_functions model_functions,
+    unsigned char* optional_value_for_model_create,
+    pemc_formula_ref* formula_ref) {
+  return checkReachability(
+      createCApiModelCreator(model_functions, nullptr,
+                             optional_value_for_model_create),
+      formula_ref);
+}
+
+static pemc_lmc_ref* build_lmc_from_executable_model(
+    pemc_model_functions model_functions,
+    unsigned char* optional_value_for_model_create,
+    const pemc_formula_ref** formulas,
+    int32_t num_formulas) {
+  return buildLmc(createCApiModelCreator(model_functions, nullptr,
+                                         optional_value_for_model_create),
+                  formulas, num_formulas);
+}
+
+static int32_t check_reachability_in_resident_executable_model(
+    pemc_resident_model_functions resident_model_functions,
+    unsigned char* optional_value_for_model_create,
+    pemc_formula_ref* formula_ref) {
+  throw_assert(resident_model_functions.use_state_vector != nullptr,
+               "A resident model requires use_state_vector");
+  return checkReachability(
+      createCApiModelCreator(resident_model_functions.model_functions,
+                             resident_model_functions.use_state_vector,
+                             optional_value_for_model_create),
+      formula_ref);
+}
+
+static pemc_lmc_ref* build_lmc_from_resident_executable_model(
+    pemc_resident_model_functions resident_model_functions,
+    unsigned char* optional_value_for_model_create,
+    const pemc_formula_ref** formulas,
+    int32_t num_formulas) {
+  throw_assert(resident_model_functions.use_state_vector != nullptr,
+               "A resident model requires use_state_vector");
+  return buildLmc(
+      createCApiModelCreator(resident_model_functions.model_functions,
+                             resident_model_functions.use_state_vector,
+                             optional_value_for_model_create),
+      formulas, num_formulas);
+}
+
 static double calculate_probability_to_reach_state_within_bound(
     pemc_lmc_ref* lmc_ref,
     pemc_formula_ref* formula_ref,
@@ -355,5 +420,13 @@ extern "C" int32_t assign_pemc_functions(pemc_functions* target) {
 
   // debugging
   target->test = (test_function_type)test;
+
+  // state vector resident models
+  target->check_reachability_in_resident_executable_model =
+      (check_reachability_in_resident_executable_model_function_type)
+          check_reachability_in_resident_executable_model;
+  target->build_lmc_from_resident_executable_model =
+      (build_lmc_from_resident_executable_model_function_type)
+          build_lmc_from_resident_executable_model;
   return 0;
 }
\ No newline at end of file
@@ -38,7 +38,19 @@
 extern "C" {
 #endif
 
+// The type of state and transition indexes of pemc. Equals pemc::StateIndex,
+// which is 64 bit wide if pemc has been built with the option large_indexes.
+#ifdef PEMC_LARGE_INDEXES
+typedef int64_t pemc_index;
+#else
+typedef int32_t pemc_index;
+#endif
+
 // function pointer for choices
+// A C model resolves a choice by calling pemc_choose_by_no_of_options and
+// step is executed again for every path (see AbstractModel::choose). The
+// continuation-style choose with choice point snapshots is not offered by the
+// C API.
 
 typedef struct pemc_model_specific_interface_struct
     pemc_model_specific_interface;
@@ -77,7 +89,14 @@ typedef void (*pemc_step_function_type)(unsigned char*);
 
 typedef int32_t (*pemc_get_state_vector_size_function_type)(unsigned char*);
 
+typedef void (*pemc_use_state_vector_function_type)(unsigned char*,  // model
+                                                    unsigned char*,  // position
+                                                    size_t);         // size
+
 // required functions: Those must be provided by the user of pemc
+// Zero-initialize the struct (pemc_model_functions model_functions = {0};)
+// before the fields are assigned, so fields added in later versions of pemc
+// are NULL.
 typedef struct {
   pemc_model_create model_create;
   pemc_model_free model_free;
@@ -88,6 +107,15 @@ typedef struct {
   pemc_get_state_vector_size_function_type get_state_vector_size;
 } pemc_model_functions;
 
+// A state vector resident model keeps its state in the state vector given by
+// use_state_vector. reset_to_initial_state and step modify the state in
+// place, serialize and deserialize are not called and may be NULL. Such
+// models are only passed to the entry points for resident models.
+typedef struct {
+  pemc_model_functions model_functions;
+  pemc_use_state_vector_function_type use_state_vector;
+} pemc_resident_model_functions;
+
 // function pointer for formulas
 
 typedef struct {
@@ -128,6 +156,19 @@ typedef pemc_lmc_ref* (*build_lmc_from_executable_model_function_type)(
     const pemc_formula_ref**,
     int32_t);
 
+typedef int32_t (
+    *check_reachability_in_resident_executable_model_function_type)(
+    pemc_resident_model_functions,
+    unsigned char*,  // optional value for model create
+    pemc_formula_ref*);
+
+typedef pemc_lmc_ref* (
+    *build_lmc_from_resident_executable_model_function_type)(
+    pemc_resident_model_functions,
+    unsigned char*,  // optional value for model create
+    const pemc_formula_ref**,
+    int32_t);
+
 typedef double (
     *calculate_probability_to_reach_state_within_bound_function_type)(
     pemc_lmc_ref*,
@@ -165,6 +206,12 @@ typedef struct {
 
   // debugging
   test_function_type test;
+
+  // state vector resident models
+  check_reachability_in_resident_executable_model_function_type
+      check_reachability_in_resident_executable_model;
+  build_lmc_from_resident_executable_model_function_type
+      build_lmc_from_resident_executable_model;
 } pemc_functions;
 
 PEMC_API int32_t assign_pemc_functions(pemc_functions* target);
@@ -45,10 +45,70 @@ Label AbstractModel::calculateLabel() {
 };
 
 size_t AbstractModel::choose(const gsl::span<Probability>& choices) {
+  throw_assert(!choicePointSnapshotsEnabled,
+               "Only the continuation-style choose supports choice point "
+               "snapshots");
   return choiceResolver->choose(choices);
 }
 
 size_t AbstractModel::choose(size_t numberOfChoices) {
+  throw_assert(!choicePointSnapshotsEnabled,
+               "Only the continuation-style choose supports choice point "
+               "snapshots");
   return choiceResolver->choose(numberOfChoices);
 }
+
+void AbstractModel::enableChoicePointSnapshots(
+    std::function<void()> _pathFinishedHandler) {
+  choicePointSnapshotsEnabled = true;
+  pathFinishedHandler = _pathFinishedHandler;
+}
+
+void AbstractModel::disableChoicePointSnapshots() {
+  choicePointSnapshotsEnabled = false;
+  pathFinishedHandler = nullptr;
+}
+
+void AbstractModel::stepWithChoicePointSnapshots() {
+  choicePointDepth = 0;
+  auto numberOfFinishedPathsBefore = numberOfFinishedPaths;
+  step();
+  // A step without any choice is a single path.
+  if (numberOfFinishedPaths == numberOfFinishedPathsBefore)
+    finishPath();
+}
+
+void AbstractModel::finishPath() {
+  pathFinishedHandler();
+  numberOfFinishedPaths++;
+}
+
+void AbstractModel::beginChoicePoint() {
+  // The snapshots of previous steps are reused.
+  if (choicePointSnapshots.size() <= choicePointDepth) {
+    choicePointSnapshots.emplace_back(getStateVectorSize());
+  }
+  serialize(choicePointSnapshots[choicePointDepth]);
+  choicePointDepth++;
+}
+
+size_t AbstractModel::beginOptionOfChoicePoint(size_t option,
+                                               Probability probability) {
+  // The first option continues with the current state.
+  if (option > 0)
+    deserialize(choicePointSnapshots[choicePointDepth - 1]);
+  choiceResolver->beginOptionOfChoicePoint(probability);
+  return numberOfFinishedPaths;
+}
+
+void AbstractModel::endOptionOfChoicePoint(size_t numberOfFinishedPathsBefore) {
+  // When the continuation made no further choice, the option ends a path.
+  if (numberOfFinishedPaths == numberOfFinishedPathsBefore)
+    finishPath();
+  choiceResolver->endOptionOfChoicePoint();
+}
+
+void AbstractModel::endChoicePoint() {
+  choicePointDepth--;
+}
 }  // namespace pemc
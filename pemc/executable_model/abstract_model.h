@@ -48,6 +48,19 @@
 namespace pemc {
 
   class AbstractModel {
+  private:
+      // Choice point snapshots (see the continuation-style choose below).
+      bool choicePointSnapshotsEnabled = false;
+      size_t choicePointDepth = 0;
+      std::vector<std::vector<gsl::byte>> choicePointSnapshots;
+      size_t numberOfFinishedPaths = 0;
+      std::function<void()> pathFinishedHandler;
+
+      void finishPath();
+      void beginChoicePoint();
+      size_t beginOptionOfChoicePoint(size_t option, Probability probability);
+      void endOptionOfChoicePoint(size_t numberOfFinishedPathsBefore);
+      void endChoicePoint();
   protected:
       IChoiceResolver* choiceResolver = nullptr;
       std::vector<std::function<bool()>> formulaEvaluators;
@@ -63,6 +76,15 @@ namespace pemc {
 
       virtual void deserialize(gsl::span<gsl::byte> position) {}
 
+      // State vector resident models keep their whole state in the state
+      // vector given to useStateVector. resetToInitialState() and step()
+      // modify it in place. Then, the ModelExecutor copies the source state
+      // into the slot of the successor and neither calls serialize nor
+      // deserialize. Choice point snapshots are not used for these models.
+      virtual bool isStateVectorResident() {return false;}
+
+      virtual void useStateVector(gsl::span<gsl::byte> stateVector) {}
+
       virtual void setFormulasForLabel(const std::vector<std::shared_ptr<Formula>>& _formulas) {}
 
       Label calculateLabel();
@@ -71,6 +93,59 @@ namespace pemc {
 
       size_t choose(size_t numberOfChoices);
 
+      // Continuation-style choose. The continuation gets the chosen option and
+      // must contain the rest of step(), i.e., no code may follow the call.
+      // Without choice point snapshots, the option is resolved like above and
+      // the whole step() is reexecuted for every path. With choice point
+      // snapshots, the model is serialized at the choice point and every
+      // option is executed from the restored snapshot. Thus, the code before
+      // the choice point is executed only once.
+      template<typename TContinuation>
+      void choose(const gsl::span<Probability>& choices, TContinuation&& continuation) {
+        if (!choicePointSnapshotsEnabled) {
+          continuation(choose(choices));
+          return;
+        }
+        beginChoicePoint();
+        for (size_t option = 0; option < static_cast<size_t>(choices.size()); ++option) {
+          auto numberOfFinishedPathsBefore = beginOptionOfChoicePoint(option, choices[option]);
+          continuation(option);
+          endOptionOfChoicePoint(numberOfFinishedPathsBefore);
+        }
+        endChoicePoint();
+      }
+
+      template<typename TContinuation>
+      void choose(size_t numberOfChoices, TContinuation&& continuation) {
+        if (!choicePointSnapshotsEnabled) {
+          continuation(choose(numberOfChoices));
+          return;
+        }
+        auto probabilityOfOption = Probability(1.0 / numberOfChoices);
+        beginChoicePoint();
+        for (size_t option = 0; option < numberOfChoices; ++option) {
+          auto numberOfFinishedPathsBefore = beginOptionOfChoicePoint(option, probabilityOfOption);
+          continuation(option);
+          endOptionOfChoicePoint(numberOfFinishedPathsBefore);
+        }
+        endChoicePoint();
+      }
+
+      // Models that only use the continuation-style choose may return true.
+      // Then, choice point snapshots are used if the choice resolver
+      // supports them.
+      virtual bool usesContinuationStyleChoices() {return false;}
+
+      // The pathFinishedHandler is called at the end of every path.
+      void enableChoicePointSnapshots(std::function<void()> _pathFinishedHandler);
+
+      // Returns to the replaying choose, e.g., when the new choice resolver
+      // does not support choice point snapshots.
+      void disableChoicePointSnapshots();
+
+      // Executes step() and calls the pathFinishedHandler for every path.
+      void stepWithChoicePointSnapshots();
+
       virtual void resetToInitialState() {}
 
       virtual void step() {}
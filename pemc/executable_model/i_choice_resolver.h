@@ -49,7 +49,29 @@ namespace pemc {
 
       virtual void endMacroStepExecution() {}
 
+      // Choice point snapshots (see AbstractModel). Instead of prepareNextPath
+      // and choose, the options of every choice point on the current path are
+      // announced. Afterwards, stepFinished is called at the end of the path.
+      virtual bool supportsChoicePointSnapshots() {return false;}
+
+      virtual void beginOptionOfChoicePoint(Probability probabilityOfOption) {}
+
+      virtual void endOptionOfChoicePoint() {}
+
+      // Prefixes (see ModelExecutor::enableParallelChoiceEnumeration). After
+      // setPrefix, the next macro step only enumerates the paths, whose first
+      // choices resolve to the given options.
+      virtual bool supportsPrefixes() {return false;}
+
+      virtual void setPrefix(gsl::span<const size_t> options) {}
+
+      // The number of options of the first choice after the prefix on the
+      // last path. 0 if the path made no further choice.
+      virtual size_t getNumberOfOptionsAfterPrefix() {return 0;}
+
       virtual void* getCustomPayloadOfLastCalculation() {return nullptr;}
+
+      virtual size_t getCustomPayloadElementSize() {return 0;}
   };
 
 }
@@ -41,15 +41,36 @@ ModelExecutor::ModelExecutor(const Configuration& conf)
 
 void ModelExecutor::setModel(std::unique_ptr<AbstractModel> _model) {
   model = std::move(_model);
+  stateVectorResident = model->isStateVectorResident();
   auto modelStateVectorSize = model->getStateVectorSize();
+  modelStateVectorOperations = getStateVectorOperations(modelStateVectorSize);
   temporaryStateStorage.setStateVectorSize(
       modelStateVectorSize, preStateStorageModifierStateVectorSize);
+  if (choiceResolver) {
+    model->setChoiceResolver(choiceResolver.get());
+    updateChoicePointSnapshots();
+  }
 }
 
 void ModelExecutor::setChoiceResolver(
     std::unique_ptr<IChoiceResolver> _choiceResolver) {
   choiceResolver = std::move(_choiceResolver);
   model->setChoiceResolver(choiceResolver.get());
+  updateChoicePointSnapshots();
+}
+
+void ModelExecutor::updateChoicePointSnapshots() {
+  useChoicePointSnapshots = model->usesContinuationStyleChoices() &&
+                            choiceResolver->supportsChoicePointSnapshots() &&
+                            !stateVectorResident;
+  if (useChoicePointSnapshots) {
+    model->enableChoicePointSnapshots([this]() {
+      choiceResolver->stepFinished();
+      addTransition(gsl::span<gsl::byte>());
+    });
+  } else {
+    model->disableChoicePointSnapshots();
+  }
 }
 
 int32_t ModelExecutor::getStateVectorSize() {
@@ -60,6 +81,10 @@ void ModelExecutor::setPreStateStorageModifierStateVectorSize(
     int32_t _preStateStorageModifierStateVectorSize) {
   preStateStorageModifierStateVectorSize =
       _preStateStorageModifierStateVectorSize;
+  for (auto& helper : choiceTreeHelpers) {
+    helper->setPreStateStorageModifierStateVectorSize(
+        _preStateStorageModifierStateVectorSize);
+  }
   if (model) {
     auto modelStateVectorSize = model->getStateVectorSize();
     temporaryStateStorage.setStateVectorSize(
@@ -67,51 +92,273 @@ void ModelExecutor::setPreStateStorageModifierStateVectorSize(
   }
 }
 
-void ModelExecutor::addTransition() {
+gsl::span<gsl::byte> ModelExecutor::beginPath(gsl::span<gsl::byte> state,
+                                              bool initial) {
+  if (!stateVectorResident) {
+    if (initial)
+      model->resetToInitialState();
+    else
+      model->deserialize(state);
+    return gsl::span<gsl::byte>();
+  }
+  // The model works directly on the slot of the target state.
+  auto tempStateIndex = temporaryStateStorage.getFreshStateIndex();
+  auto tempStateSpan = temporaryStateStorage[tempStateIndex];
+  if (!initial)
+    modelStateVectorOperations.copy(state.data(), tempStateSpan.data());
+  model->useStateVector(tempStateSpan);
+  if (initial)
+    model->resetToInitialState();
+  return tempStateSpan;
+}
+
+void ModelExecutor::addTransition(gsl::span<gsl::byte> residentTargetState) {
+  auto label = deferLabels ? Label() : model->calculateLabel();
+  if (stateVectorResident) {
+    transitions.push_back(
+        TraversalTransition(residentTargetState.data(), label));
+    return;
+  }
   auto tempStateIndex = temporaryStateStorage.getFreshStateIndex();
   auto tempStateSpan = temporaryStateStorage[tempStateIndex];
   model->serialize(tempStateSpan);
-  auto label = model->calculateLabel();
   auto newTransition = TraversalTransition(tempStateSpan.data(), label);
   transitions.push_back(newTransition);
 }
 
+gsl::span<TraversalTransition> ModelExecutor::finishTransitions() {
+  // If the temporary state storage grew, the states have moved.
+  if (temporaryStateStorage.hasMovedSinceClear()) {
+    for (size_t i = 0; i < transitions.size(); ++i) {
+      transitions[i].targetState = temporaryStateStorage[i].data();
+    }
+  }
+  return gsl::span<TraversalTransition>(transitions);
+}
+
 gsl::span<TraversalTransition> ModelExecutor::calculateInitialTransitions() {
+  lastCalculationWasParallel = false;
   transitions.clear();
   temporaryStateStorage.clear();
 
   choiceResolver->beginMacroStepExecution();
 
-  while (choiceResolver->prepareNextPath()) {
+  if (useChoicePointSnapshots) {
     model->resetToInitialState();
+    model->stepWithChoicePointSnapshots();
+  } else {
+    while (choiceResolver->prepareNextPath()) {
+      auto targetState = beginPath(gsl::span<gsl::byte>(), true);
+      model->step();
+      choiceResolver->stepFinished();
+      addTransition(targetState);
+    }
+  }
+
+  choiceResolver->endMacroStepExecution();
+  return finishTransitions();
+}
+
+void ModelExecutor::enableParallelChoiceEnumeration(
+    const Configuration& conf,
+    std::function<std::unique_ptr<AbstractModel>()> modelCreator,
+    std::function<std::unique_ptr<IChoiceResolver>()> choiceResolverCreator) {
+  throw_assert(model && choiceResolver,
+               "The model and the choice resolver must be set first");
+  throw_assert(choiceResolver->supportsPrefixes(),
+               "The choice resolver does not support prefixes");
+  choiceTreeHelpers.clear();
+  choiceTreeThreadPool.reset();
+  if (conf.choiceTreeThreads <= 1)
+    return;
+  choiceTreeThreadPool = std::make_unique<ThreadPool>(conf.choiceTreeThreads);
+  for (auto i = 0; i < conf.choiceTreeThreads; ++i) {
+    auto helper = std::make_unique<ModelExecutor>(conf);
+    helper->setModel(modelCreator());
+    helper->setChoiceResolver(choiceResolverCreator());
+    helper->setPreStateStorageModifierStateVectorSize(
+        preStateStorageModifierStateVectorSize);
+    helper->setDeferLabels(deferLabels);
+    choiceTreeHelpers.push_back(std::move(helper));
+  }
+}
+
+size_t ModelExecutor::countOptionsAfterPrefix(
+    gsl::span<gsl::byte> state,
+    const std::vector<size_t>& prefix) {
+  choiceResolver->setPrefix(prefix);
+  choiceResolver->beginMacroStepExecution();
+  choiceResolver->prepareNextPath();
+  // The slot that a state vector resident model steps in is not kept.
+  temporaryStateStorage.clear();
+  beginPath(state, false);
+  model->step();
+  auto numberOfOptions = choiceResolver->getNumberOfOptionsAfterPrefix();
+  choiceResolver->endMacroStepExecution();
+  return numberOfOptions;
+}
+
+void ModelExecutor::beginPrefixes() {
+  transitions.clear();
+  temporaryStateStorage.clear();
+  payloadOfPrefixes.clear();
+}
+
+void ModelExecutor::enumeratePrefix(gsl::span<gsl::byte> state,
+                                    const std::vector<size_t>& prefix) {
+  auto transitionsBefore = transitions.size();
+  choiceResolver->setPrefix(prefix);
+  choiceResolver->beginMacroStepExecution();
+
+  while (choiceResolver->prepareNextPath()) {
+    auto targetState = beginPath(state, false);
     model->step();
     choiceResolver->stepFinished();
-    addTransition();
+    addTransition(targetState);
   }
 
   choiceResolver->endMacroStepExecution();
-  return gsl::span<TraversalTransition>(transitions);
+
+  // The payload of the choice resolver only covers this prefix.
+  auto payloadSize = choiceResolver->getCustomPayloadElementSize() *
+                     (transitions.size() - transitionsBefore);
+  auto payload = static_cast<gsl::byte*>(
+      choiceResolver->getCustomPayloadOfLastCalculation());
+  if (payloadSize > 0)
+    payloadOfPrefixes.insert(payloadOfPrefixes.end(), payload,
+                             payload + payloadSize);
+}
+
+bool ModelExecutor::calculateTransitionsOfStateInParallel(
+    gsl::span<gsl::byte> state) {
+  // Split the choice tree level by level into prefixes until there are enough
+  // prefixes to keep all threads busy. The order of the prefixes is the order
+  // in which the paths are enumerated sequentially.
+  const size_t prefixesPerThread = 4;
+  auto targetNumberOfPrefixes =
+      prefixesPerThread * choiceTreeThreadPool->getNumberOfThreads();
+  choiceTreePrefixes.resize(1);
+  choiceTreePrefixes[0].clear();
+  auto splittable = true;
+  while (splittable && choiceTreePrefixes.size() < targetNumberOfPrefixes) {
+    splittable = false;
+    nextChoiceTreePrefixes.clear();
+    for (auto& prefix : choiceTreePrefixes) {
+      auto numberOfOptions = countOptionsAfterPrefix(state, prefix);
+      if (numberOfOptions == 0) {
+        // The prefix is a complete path.
+        nextChoiceTreePrefixes.push_back(prefix);
+        continue;
+      }
+      splittable = true;
+      for (size_t option = 0; option < numberOfOptions; ++option) {
+        nextChoiceTreePrefixes.push_back(prefix);
+        nextChoiceTreePrefixes.back().push_back(option);
+      }
+    }
+    std::swap(choiceTreePrefixes, nextChoiceTreePrefixes);
+  }
+  choiceResolver->setPrefix(gsl::span<const size_t>());
+  if (choiceTreePrefixes.size() < 2)
+    return false;
+
+  // Enumerate the subtrees of the prefixes in parallel.
+  for (auto& helper : choiceTreeHelpers) {
+    helper->beginPrefixes();
+  }
+  choiceTreePrefixResults.resize(choiceTreePrefixes.size());
+  choiceTreeThreadPool->parallelFor(
+      static_cast<int64_t>(choiceTreePrefixes.size()),
+      [this, state](int64_t prefixIndex, int32_t threadIndex) {
+        auto& helper = *choiceTreeHelpers[threadIndex];
+        auto begin = helper.transitions.size();
+        helper.enumeratePrefix(state, choiceTreePrefixes[prefixIndex]);
+        choiceTreePrefixResults[prefixIndex] =
+            ChoiceTreePrefixResult{threadIndex, begin,
+                                   helper.transitions.size()};
+      });
+  for (auto& helper : choiceTreeHelpers) {
+    helper->finishTransitions();
+  }
+
+  // Merge the transitions and payloads in the order of the prefixes. The
+  // target states stay in the temporary state storages of the helpers.
+  transitions.clear();
+  payloadOfPrefixes.clear();
+  auto payloadElementSize = choiceResolver->getCustomPayloadElementSize();
+  for (auto& result : choiceTreePrefixResults) {
+    auto& helper = *choiceTreeHelpers[result.helper];
+    transitions.insert(transitions.end(),
+                       helper.transitions.begin() + result.begin,
+                       helper.transitions.begin() + result.end);
+    payloadOfPrefixes.insert(
+        payloadOfPrefixes.end(),
+        helper.payloadOfPrefixes.begin() + result.begin * payloadElementSize,
+        helper.payloadOfPrefixes.begin() + result.end * payloadElementSize);
+  }
+  lastCalculationWasParallel = true;
+  return true;
 }
 
 gsl::span<TraversalTransition> ModelExecutor::calculateTransitionsOfState(
     gsl::span<gsl::byte> state) {
+  if (choiceTreeThreadPool && !useChoicePointSnapshots &&
+      calculateTransitionsOfStateInParallel(state)) {
+    return gsl::span<TraversalTransition>(transitions);
+  }
+  lastCalculationWasParallel = false;
+
   transitions.clear();
   temporaryStateStorage.clear();
 
   choiceResolver->beginMacroStepExecution();
 
-  while (choiceResolver->prepareNextPath()) {
+  if (useChoicePointSnapshots) {
     model->deserialize(state);
-    model->step();
-    choiceResolver->stepFinished();
-    addTransition();
+    model->stepWithChoicePointSnapshots();
+  } else {
+    while (choiceResolver->prepareNextPath()) {
+      auto targetState = beginPath(state, false);
+      model->step();
+      choiceResolver->stepFinished();
+      addTransition(targetState);
+    }
   }
 
   choiceResolver->endMacroStepExecution();
-  return gsl::span<TraversalTransition>(transitions);
+  return finishTransitions();
 }
 
 void* ModelExecutor::getCustomPayloadOfLastCalculation() {
+  if (lastCalculationWasParallel)
+    return static_cast<void*>(payloadOfPrefixes.data());
   return choiceResolver->getCustomPayloadOfLastCalculation();
 }
+
+size_t ModelExecutor::getCustomPayloadElementSize() {
+  return choiceResolver->getCustomPayloadElementSize();
+}
+
+bool ModelExecutor::supportsDeferredLabels() {
+  return true;
+}
+
+void ModelExecutor::setDeferLabels(bool _deferLabels) {
+  deferLabels = _deferLabels;
+  for (auto& helper : choiceTreeHelpers) {
+    helper->setDeferLabels(_deferLabels);
+  }
+}
+
+Label ModelExecutor::calculateLabelOfState(gsl::span<gsl::byte> state) {
+  if (stateVectorResident) {
+    // States in the state storage are not aligned, so the model reads a copy.
+    labelStateVector.resize(state.size());
+    copyBuffers(state.data(), labelStateVector.data(), state.size());
+    model->useStateVector(gsl::span<gsl::byte>(labelStateVector));
+  } else {
+    model->deserialize(state);
+  }
+  return model->calculateLabel();
+}
 }  // namespace pemc
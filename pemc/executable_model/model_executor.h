@@ -35,6 +35,7 @@
 
 #include "pemc/basic/tsc_index.h"
 #include "pemc/basic/configuration.h"
+#include "pemc/basic/thread_pool.h"
 #include "pemc/basic/label.h"
 #include "pemc/basic/model_capacity.h"
 #include "pemc/basic/raw_memory.h"
@@ -48,6 +49,14 @@
 
 namespace pemc {
 
+  // The transitions of a prefix of the choice tree, which have been
+  // calculated by the helper with the given index.
+  struct ChoiceTreePrefixResult {
+      int32_t helper;
+      size_t begin;
+      size_t end;
+  };
+
   class ModelExecutor : public ITransitionsCalculator {
   protected:
       std::unique_ptr<IChoiceResolver> choiceResolver;
@@ -55,12 +64,49 @@ namespace pemc {
 
       // Create a storage for different state vectors and a vector of transitions
       // that can be reused for different calculations. This should prevent garbage.
+      // Both only grow, so a traversal in a steady state does not allocate.
       TemporaryStateStorage temporaryStateStorage;
       std::vector<TraversalTransition> transitions;
 
       int32_t preStateStorageModifierStateVectorSize = 0;
 
-      void addTransition();
+      bool useChoicePointSnapshots = false;
+
+      bool deferLabels = false;
+
+      bool stateVectorResident = false;
+      StateVectorOperations modelStateVectorOperations{};
+      std::vector<gsl::byte> labelStateVector;
+
+      // Parallel enumeration of the choice tree of a single state. Each
+      // helper has its own model and enumerates the subtrees below some
+      // prefixes of the choice tree.
+      std::unique_ptr<ThreadPool> choiceTreeThreadPool;
+      std::vector<std::unique_ptr<ModelExecutor>> choiceTreeHelpers;
+      std::vector<std::vector<size_t>> choiceTreePrefixes;
+      std::vector<std::vector<size_t>> nextChoiceTreePrefixes;
+      std::vector<ChoiceTreePrefixResult> choiceTreePrefixResults;
+      // The custom payload of the prefixes enumerated by a helper or the
+      // merged custom payload of the helpers.
+      std::vector<gsl::byte> payloadOfPrefixes;
+      bool lastCalculationWasParallel = false;
+
+      // Prepares the model for the next path from state (or from the initial
+      // state if initial is set). Returns the slot of the target state for
+      // state vector resident models.
+      gsl::span<gsl::byte> beginPath(gsl::span<gsl::byte> state, bool initial);
+      void addTransition(gsl::span<gsl::byte> residentTargetState);
+      gsl::span<TraversalTransition> finishTransitions();
+
+      // Runs the first path that starts with prefix and returns the number of
+      // options of the first choice after the prefix (0 if there is none).
+      size_t countOptionsAfterPrefix(gsl::span<gsl::byte> state, const std::vector<size_t>& prefix);
+      void beginPrefixes();
+      // Adds the transitions of all paths that start with prefix.
+      void enumeratePrefix(gsl::span<gsl::byte> state, const std::vector<size_t>& prefix);
+      // Returns false if the choice tree cannot be split.
+      bool calculateTransitionsOfStateInParallel(gsl::span<gsl::byte> state);
+      void updateChoicePointSnapshots();
   public:
       ModelExecutor(const Configuration& conf);
 
@@ -68,6 +114,17 @@ namespace pemc {
 
       void setChoiceResolver(std::unique_ptr<IChoiceResolver> _choiceResolver);
 
+      // Enumerates the choice tree of each state with
+      // conf.choiceTreeThreads threads (see Configuration). The creators must
+      // create models and choice resolvers equivalent to the ones set, the
+      // choice resolver must support prefixes. Call after setModel and
+      // setChoiceResolver. Initial transitions and models with choice point
+      // snapshots are always calculated sequentially.
+      void enableParallelChoiceEnumeration(
+          const Configuration& conf,
+          std::function<std::unique_ptr<AbstractModel>()> modelCreator,
+          std::function<std::unique_ptr<IChoiceResolver>()> choiceResolverCreator);
+
       virtual int32_t getStateVectorSize();
 
       virtual void setPreStateStorageModifierStateVectorSize(int32_t _preStateStorageModifierStateVectorSize);
@@ -78,6 +135,14 @@ namespace pemc {
 
       virtual void* getCustomPayloadOfLastCalculation();
 
+      virtual size_t getCustomPayloadElementSize();
+
+      virtual bool supportsDeferredLabels();
+
+      virtual void setDeferLabels(bool _deferLabels);
+
+      virtual Label calculateLabelOfState(gsl::span<gsl::byte> state);
+
   };
 
 }
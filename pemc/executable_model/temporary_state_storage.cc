@@ -25,6 +25,7 @@
 #include "pemc/executable_model/temporary_state_storage.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <limits>
 
 #include "pemc/basic/ThrowAssert.hpp"
@@ -38,14 +39,11 @@ TemporaryStateStorage::TemporaryStateStorage(StateIndex _capacity) {
       "capacity invalid");
 
   totalCapacity = _capacity;
-
-  throw_assert(sizeof(StateIndex) == 4,
-               "Used StateStorage not compatible with size of StateIndex");
 }
 
 gsl::span<gsl::byte> TemporaryStateStorage::operator[](size_t idx) {
   throw_assert(idx >= 0 && idx < totalCapacity, "idx not in range");
-  return gsl::span<gsl::byte>(stateMemory.data() + idx * stateVectorSize,
+  return gsl::span<gsl::byte>(stateMemory.data() + idx * stateVectorStride,
                               stateVectorSize);
 }
 
@@ -54,15 +52,32 @@ StateIndex TemporaryStateStorage::getNumberOfSavedStates() {
 }
 
 StateIndex TemporaryStateStorage::getFreshStateIndex() {
+  if (savedStates == totalCapacity) {
+    throw_assert(totalCapacity <= std::numeric_limits<StateIndex>::max() / 2,
+                 "capacity exceeded");
+    totalCapacity *= 2;
+    resizeStateBuffer();
+    movedSinceClear = true;
+  }
   auto stateIndex = savedStates;
   savedStates++;
   return stateIndex;
 }
 
+StateIndex TemporaryStateStorage::getCapacity() {
+  return totalCapacity;
+}
+
+bool TemporaryStateStorage::hasMovedSinceClear() {
+  return movedSinceClear;
+}
+
 void TemporaryStateStorage::resizeStateBuffer() {
   stateVectorSize =
       modelStateVectorSize + preStateStorageModifierStateVectorSize;
-  stateMemory.resize(totalCapacity * stateVectorSize);
+  const int32_t alignment = alignof(std::max_align_t);
+  stateVectorStride = (stateVectorSize + alignment - 1) / alignment * alignment;
+  stateMemory.resize(static_cast<size_t>(totalCapacity) * stateVectorStride);
 }
 
 void TemporaryStateStorage::setStateVectorSize(
@@ -76,6 +91,7 @@ void TemporaryStateStorage::setStateVectorSize(
 
 void TemporaryStateStorage::clear() {
   savedStates = 0;
+  movedSinceClear = false;
 }
 
 }  // namespace pemc
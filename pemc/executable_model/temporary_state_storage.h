@@ -41,6 +41,11 @@
 namespace pemc {
 
   ///   We store states in a contiguous array, indexed by a continuous variable.
+  ///   The array is reused for every macro step. If a macro step has more
+  ///   successors than the capacity, the array doubles its capacity and never
+  ///   shrinks. Growing moves the states, so the spans and pointers of
+  ///   previously returned states must be retrieved again (see
+  ///   hasMovedSinceClear).
   ///   The TemporaryStateStorage is not thread safe.
   class TemporaryStateStorage {
   private:
@@ -52,6 +57,9 @@ namespace pemc {
       // The length in bytes of the state vector of the analysis model with the extra bytes
       // required for the preStateStorage modifiers
       int32_t stateVectorSize = 0;
+      // The distance in bytes between two states. State vector resident models
+      // work on the states in place, so every state starts aligned.
+      int32_t stateVectorStride = 0;
 
       // The number of saved states
       StateIndex savedStates = 0;
@@ -61,6 +69,9 @@ namespace pemc {
       // the memory that contains the serialized states
       std::vector<gsl::byte> stateMemory;
 
+      // True, if the states have been moved since the last call of clear().
+      bool movedSinceClear = false;
+
       void resizeStateBuffer();
 
   public:
@@ -72,6 +83,10 @@ namespace pemc {
 
       StateIndex getFreshStateIndex();
 
+      StateIndex getCapacity();
+
+      bool hasMovedSinceClear();
+
       void setStateVectorSize(int32_t _modelStateVectorSize, int32_t _preStateStorageModifierStateVectorSize);
 
       void clear();
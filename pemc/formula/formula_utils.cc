@@ -79,4 +79,10 @@ std::string formulaToString(Formula& formula) {
   return visitor.getResult();
 }
 
+std::tuple<std::string, std::string> phiUntilPsiToStrings(Formula* phi,
+                                                          Formula* psi) {
+  auto phiString = phi == nullptr ? std::string() : formulaToString(*phi);
+  return std::make_tuple(phiString, formulaToString(*psi));
+}
+
 }  // namespace pemc
@@ -26,6 +26,8 @@
 #define PEMC_FORMULA_FORMULA_UTILS_H_
 
 #include <optional>
+#include <string>
+#include <tuple>
 
 #include "pemc/formula/formula.h"
 
@@ -36,5 +38,10 @@ tryExtractPhiUntilPsiWithBound(Formula& formula);
 
 std::string formulaToString(Formula& formula);
 
+// Identifies phi U psi by the strings of phi and psi. phi is nullptr for
+// F psi and gives an empty string.
+std::tuple<std::string, std::string> phiUntilPsiToStrings(Formula* phi,
+                                                          Formula* psi);
+
 }  // namespace pemc
 #endif  // PEMC_FORMULA_FORMULA_UTILS_H_
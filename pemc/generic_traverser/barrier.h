@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef PEMC_GENERIC_TRAVERSER_BARRIER_H_
+#define PEMC_GENERIC_TRAVERSER_BARRIER_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace pemc {
+
+// Synchronizes the workers of a level-synchronous breadth-first traversal.
+// A thread calling arriveAndWait() blocks until all participants have arrived.
+// Afterwards, the barrier can be reused. Everything a thread has written
+// before it arrived is visible to all threads after they have passed.
+class Barrier {
+ private:
+  std::mutex mutex;
+  std::condition_variable allArrived;
+  int32_t participants;
+  int32_t waiting = 0;
+  // incremented each time all participants have arrived
+  int64_t generation = 0;
+
+ public:
+  Barrier(int32_t _participants);
+
+  void arriveAndWait();
+};
+
+}  // namespace pemc
+
+#endif  // PEMC_GENERIC_TRAVERSER_BARRIER_H_
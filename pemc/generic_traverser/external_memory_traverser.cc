@@ -0,0 +1,371 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "pemc/generic_traverser/external_memory_traverser.h"
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+
+#include "pemc/basic/ThrowAssert.hpp"
+#include "pemc/basic/exceptions.h"
+#include "pemc/generic_traverser/external_sorter.h"
+#include "pemc/generic_traverser/traversal_transition.h"
+
+namespace {
+using namespace pemc;
+
+// Transitions are identified by their position in the layer. The identifier
+// is stored in big endian, so memcmp orders it numerically.
+const size_t TransitionIdSize = sizeof(uint64_t);
+
+void encodeTransitionId(uint64_t transitionId, gsl::byte* target) {
+  for (size_t i = 0; i < TransitionIdSize; ++i)
+    target[i] = static_cast<gsl::byte>(transitionId >> (56 - 8 * i));
+}
+
+uint64_t decodeTransitionId(const gsl::byte* source) {
+  uint64_t transitionId = 0;
+  for (size_t i = 0; i < TransitionIdSize; ++i)
+    transitionId = (transitionId << 8) | static_cast<uint8_t>(source[i]);
+  return transitionId;
+}
+
+template <typename T>
+void writeValue(TemporaryFile& file, const T& value) {
+  file.write(reinterpret_cast<const gsl::byte*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool readValue(TemporaryFile& file, T& value) {
+  return file.read(reinterpret_cast<gsl::byte*>(&value), sizeof(T));
+}
+
+class Traversal {
+ public:
+  const Configuration& conf;
+
+  std::unique_ptr<ITransitionsCalculator> transitionsCalculator;
+  std::vector<std::unique_ptr<IPreStateStorageModifier>>
+      preStateStorageModifiers;
+  std::vector<std::unique_ptr<IPostStateStorageModifier>>
+      postStateStorageModifiers;
+
+  int32_t stateVectorSize;
+  size_t customPayloadElementSize;
+
+  StateIndex numberOfStates = 0;
+  StateIndex stutteringStateIndex;
+
+  // Records (state vector, index) of all found states sorted by state vector.
+  std::unique_ptr<TemporaryFile> visited;
+  // Records (index, state vector) of the states of the current layer.
+  std::unique_ptr<TemporaryFile> frontier;
+
+  // Records (state vector, transition id) of the target states found in the
+  // current layer.
+  std::unique_ptr<ExternalSorter> candidates;
+  // The transitions and custom payloads found in the current layer grouped by
+  // source state.
+  std::unique_ptr<TemporaryFile> pendingTransitions;
+  uint64_t nextTransitionId;
+
+  Traversal(const Configuration& _conf, ExternalMemoryTraverser& traverser)
+      : conf(_conf) {
+    transitionsCalculator = traverser.transitionsCalculatorCreator();
+    for (auto& creator : traverser.preStateStorageModifierCreators)
+      preStateStorageModifiers.push_back(creator());
+    for (auto& creator : traverser.postStateStorageModifierCreators)
+      postStateStorageModifiers.push_back(creator());
+
+    auto preStateStorageModifierStateVectorSize = 0;
+    for (auto& modifier : preStateStorageModifiers) {
+      preStateStorageModifierStateVectorSize +=
+          modifier->getModifierStateVectorSize();
+    }
+    transitionsCalculator->setPreStateStorageModifierStateVectorSize(
+        preStateStorageModifierStateVectorSize);
+    stateVectorSize = transitionsCalculator->getStateVectorSize() +
+                      preStateStorageModifierStateVectorSize;
+    for (auto& modifier : preStateStorageModifiers)
+      modifier->setStateVectorSize(stateVectorSize);
+    customPayloadElementSize =
+        transitionsCalculator->getCustomPayloadElementSize();
+
+    visited = std::make_unique<TemporaryFile>(conf.externalMemoryDirectory);
+    frontier = std::make_unique<TemporaryFile>(conf.externalMemoryDirectory);
+  }
+
+  void beginLayer() {
+    candidates = std::make_unique<ExternalSorter>(
+        conf.externalMemoryDirectory, stateVectorSize + TransitionIdSize,
+        stateVectorSize + TransitionIdSize, conf.externalMemoryBufferSize);
+    pendingTransitions =
+        std::make_unique<TemporaryFile>(conf.externalMemoryDirectory);
+    nextTransitionId = 0;
+  }
+
+  void addTransitions(std::optional<StateIndex> stateIndexOfSource,
+                      gsl::span<TraversalTransition> transitions) {
+    auto customPayloadOfLastCalculation =
+        transitionsCalculator->getCustomPayloadOfLastCalculation();
+
+    for (auto& modifier : preStateStorageModifiers) {
+      modifier->applyOnTransitions(stateIndexOfSource, transitions,
+                                   customPayloadOfLastCalculation);
+    }
+
+    writeValue(*pendingTransitions,
+               static_cast<int8_t>(stateIndexOfSource.has_value()));
+    writeValue(*pendingTransitions, stateIndexOfSource.value_or(-1));
+    writeValue(*pendingTransitions, static_cast<uint32_t>(transitions.size()));
+
+    auto candidate = std::vector<gsl::byte>(stateVectorSize + TransitionIdSize);
+    for (auto& transition : transitions) {
+      writeValue(*pendingTransitions, transition.label);
+      writeValue(*pendingTransitions, transition.flags);
+      if (!(transition.flags & (TraversalTransitionFlags::IsToStutteringState |
+                                TraversalTransitionFlags::IsTransitionInvalid))) {
+        std::memcpy(candidate.data(), transition.targetState, stateVectorSize);
+        encodeTransitionId(nextTransitionId, candidate.data() + stateVectorSize);
+        candidates->add(candidate.data());
+      }
+      ++nextTransitionId;
+    }
+
+    if (customPayloadElementSize > 0) {
+      pendingTransitions->write(
+          static_cast<gsl::byte*>(customPayloadOfLastCalculation),
+          customPayloadElementSize * transitions.size());
+    }
+  }
+
+  // Detects the duplicates of the current layer, assigns indexes to the new
+  // states, and applies the postStateStorageModifiers. Returns the number of
+  // new states, which form the next frontier. If beyondHorizon is set, the
+  // new states are replaced by the stuttering state.
+  StateIndex finishLayer(bool beyondHorizon) {
+    candidates->sort();
+
+    // Records (transition id, index of target state).
+    auto resolutions =
+        ExternalSorter(conf.externalMemoryDirectory,
+                       TransitionIdSize + sizeof(StateIndex), TransitionIdSize,
+                       conf.externalMemoryBufferSize);
+    auto newVisited =
+        std::make_unique<TemporaryFile>(conf.externalMemoryDirectory);
+    auto newFrontier =
+        std::make_unique<TemporaryFile>(conf.externalMemoryDirectory);
+    StateIndex newStates = 0;
+
+    // Merge the sorted candidates with the sorted visited states.
+    auto visitedRecordSize = stateVectorSize + sizeof(StateIndex);
+    auto visitedRecord = std::vector<gsl::byte>(visitedRecordSize);
+    visited->rewind();
+    auto hasVisitedRecord = visited->read(visitedRecord.data(), visitedRecordSize);
+
+    auto previousState = std::vector<gsl::byte>(stateVectorSize);
+    auto hasPreviousState = false;
+    StateIndex previousStateIndex = -1;
+    auto resolution =
+        std::vector<gsl::byte>(TransitionIdSize + sizeof(StateIndex));
+
+    while (auto candidate = candidates->next()) {
+      // Equal candidates are adjacent.
+      if (!hasPreviousState ||
+          std::memcmp(candidate, previousState.data(), stateVectorSize) != 0) {
+        while (hasVisitedRecord &&
+               std::memcmp(visitedRecord.data(), candidate, stateVectorSize) <
+                   0) {
+          newVisited->write(visitedRecord.data(), visitedRecordSize);
+          hasVisitedRecord =
+              visited->read(visitedRecord.data(), visitedRecordSize);
+        }
+        if (hasVisitedRecord &&
+            std::memcmp(visitedRecord.data(), candidate, stateVectorSize) ==
+                0) {
+          std::memcpy(&previousStateIndex,
+                      visitedRecord.data() + stateVectorSize,
+                      sizeof(StateIndex));
+        } else if (beyondHorizon) {
+          previousStateIndex = stutteringStateIndex;
+        } else {
+          previousStateIndex = numberOfStates++;
+          ++newStates;
+          newVisited->write(candidate, stateVectorSize);
+          writeValue(*newVisited, previousStateIndex);
+          writeValue(*newFrontier, previousStateIndex);
+          newFrontier->write(candidate, stateVectorSize);
+        }
+        std::memcpy(previousState.data(), candidate, stateVectorSize);
+        hasPreviousState = true;
+      }
+      std::memcpy(resolution.data(), candidate + stateVectorSize,
+                  TransitionIdSize);
+      std::memcpy(resolution.data() + TransitionIdSize, &previousStateIndex,
+                  sizeof(StateIndex));
+      resolutions.add(resolution.data());
+    }
+    while (hasVisitedRecord) {
+      newVisited->write(visitedRecord.data(), visitedRecordSize);
+      hasVisitedRecord = visited->read(visitedRecord.data(), visitedRecordSize);
+    }
+    candidates.reset();
+    visited = std::move(newVisited);
+    frontier = std::move(newFrontier);
+
+    applyPostStateStorageModifiers(resolutions);
+    pendingTransitions.reset();
+
+    return newStates;
+  }
+
+  void applyPostStateStorageModifiers(ExternalSorter& resolutions) {
+    resolutions.sort();
+    pendingTransitions->rewind();
+
+    auto transitions = std::vector<TraversalTransition>();
+    auto customPayload = std::vector<gsl::byte>();
+    uint64_t transitionId = 0;
+
+    int8_t hasSource;
+    while (readValue(*pendingTransitions, hasSource)) {
+      StateIndex stateIndexOfSource;
+      uint32_t transitionCount;
+      readValue(*pendingTransitions, stateIndexOfSource);
+      readValue(*pendingTransitions, transitionCount);
+
+      transitions.resize(transitionCount);
+      for (auto& transition : transitions) {
+        transition = TraversalTransition();
+        readValue(*pendingTransitions, transition.label);
+        readValue(*pendingTransitions, transition.flags);
+      }
+      customPayload.resize(customPayloadElementSize * transitionCount);
+      pendingTransitions->read(customPayload.data(), customPayload.size());
+
+      for (auto& transition : transitions) {
+        if (transition.flags & TraversalTransitionFlags::IsTransitionInvalid) {
+          ++transitionId;
+          continue;
+        }
+        if (transition.flags & TraversalTransitionFlags::IsToStutteringState) {
+          transition.targetStateIndex = stutteringStateIndex;
+        } else {
+          auto resolution = resolutions.next();
+          throw_assert(resolution != nullptr &&
+                           decodeTransitionId(resolution) == transitionId,
+                       "transition could not be resolved");
+          std::memcpy(&transition.targetStateIndex,
+                      resolution + TransitionIdSize, sizeof(StateIndex));
+        }
+        transition.flags =
+            transition.flags |
+            TraversalTransitionFlags::IsTargetStateTransformedToIndex;
+        ++transitionId;
+      }
+
+      auto source = hasSource ? std::make_optional(stateIndexOfSource)
+                              : std::optional<StateIndex>();
+      auto customPayloadPointer =
+          customPayloadElementSize > 0
+              ? static_cast<void*>(customPayload.data())
+              : nullptr;
+      for (auto& modifier : postStateStorageModifiers) {
+        modifier->applyOnTransitions(source, transitions,
+                                     customPayloadPointer);
+      }
+    }
+  }
+
+  void traverse(cancellation_token cancellationToken) {
+    // The states found by finishLayer() have depth layer.
+    auto horizon = conf.traversalHorizon;
+    auto layer = 0;
+    beginLayer();
+    addTransitions(std::optional<StateIndex>(),
+                   transitionsCalculator->calculateInitialTransitions());
+    auto newStates = finishLayer(horizon == 0);
+
+    auto state = std::vector<gsl::byte>(stateVectorSize);
+    while (newStates > 0 && !cancellationToken.is_canceled()) {
+      auto currentFrontier = std::move(frontier);
+      currentFrontier->rewind();
+      beginLayer();
+      StateIndex stateIndexToTraverse;
+      while (readValue(*currentFrontier, stateIndexToTraverse) &&
+             currentFrontier->read(state.data(), stateVectorSize)) {
+        if (cancellationToken.is_canceled()) {
+          return;
+        }
+        auto transitions =
+            transitionsCalculator->calculateTransitionsOfState(state);
+        addTransitions(std::make_optional(stateIndexToTraverse), transitions);
+      }
+      ++layer;
+      newStates = finishLayer(horizon >= 0 && layer >= horizon);
+    }
+  }
+};
+}  // namespace
+
+namespace pemc {
+
+ExternalMemoryTraverser::ExternalMemoryTraverser(const Configuration& _conf)
+    : conf(_conf) {}
+
+StateIndex ExternalMemoryTraverser::getNoOfStates() {
+  return numberOfStates;
+}
+
+void ExternalMemoryTraverser::enableStutteringState() {
+  createStutteringState = true;
+}
+
+std::optional<StateIndex> ExternalMemoryTraverser::getStutteringStateIndex() {
+  return createStutteringState ? std::make_optional(stutteringStateIndex)
+                               : std::optional<StateIndex>();
+}
+
+double ExternalMemoryTraverser::getOmissionProbability() {
+  return 0.0;
+}
+
+void ExternalMemoryTraverser::traverse(cancellation_token cancellationToken) {
+  auto traversal = Traversal(conf, *this);
+
+  // create a stuttering state if demanded. A horizon requires it.
+  if (conf.traversalHorizon >= 0) {
+    createStutteringState = true;
+  }
+  if (createStutteringState) {
+    stutteringStateIndex = traversal.numberOfStates++;
+  }
+  traversal.stutteringStateIndex = stutteringStateIndex;
+
+  traversal.traverse(cancellationToken);
+  numberOfStates = traversal.numberOfStates;
+}
+
+}  // namespace pemc
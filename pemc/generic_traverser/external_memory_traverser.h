@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef PEMC_GENERIC_TRAVERSER_EXTERNAL_MEMORY_TRAVERSER_H_
+#define PEMC_GENERIC_TRAVERSER_EXTERNAL_MEMORY_TRAVERSER_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "pemc/basic/cancellation_token.h"
+#include "pemc/basic/configuration.h"
+#include "pemc/basic/tsc_index.h"
+#include "pemc/generic_traverser/i_post_state_storage_modifier.h"
+#include "pemc/generic_traverser/i_pre_state_storage_modifier.h"
+#include "pemc/generic_traverser/i_transitions_calculator.h"
+
+namespace pemc {
+
+///   Traverses the state space breadth first and keeps the found states on
+///   disk instead of in a StateStorage (delayed duplicate detection, see
+///   Stern and Dill, "Using magnetic disk instead of main memory in the Murphi
+///   verifier"). The successors of a whole layer are collected in sorted runs
+///   on disk and merged with the sorted file of visited states afterwards.
+///   Only the buffers of the runs are kept in memory.
+///   Because the index of a target state is only known after the duplicate
+///   detection of its layer, the transitions and the custom payload are also
+///   written to disk and the postStateStorageModifiers are applied after the
+///   duplicate detection. The custom payload must therefore consist of one
+///   element of size getCustomPayloadElementSize() per transition.
+///   The traversal is single threaded and always exact
+///   (Configuration::stateStorageType is ignored). It is breadth first anyway,
+///   so Configuration::traversalHorizon is supported.
+class ExternalMemoryTraverser {
+ private:
+  const Configuration& conf;
+  bool createStutteringState = false;
+
+  StateIndex numberOfStates = 0;
+
+ public:
+  ExternalMemoryTraverser(const Configuration& _conf);
+
+  // a transitionsCalculator calculates the successors of a given state.
+  std::function<std::unique_ptr<ITransitionsCalculator>()>
+      transitionsCalculatorCreator;
+
+  // preStateStorageModifier can access and modify the transistions returned by
+  // the transitionsOfStateCalculator before the states are checked for
+  // duplicates. Note that order matters.
+  std::vector<std::function<std::unique_ptr<IPreStateStorageModifier>()>>
+      preStateStorageModifierCreators;
+
+  // postStateStorageModifier can access and modify the transistions after
+  // their target states have been assigned a unique index. Note that order
+  // matters.
+  std::vector<std::function<std::unique_ptr<IPostStateStorageModifier>()>>
+      postStateStorageModifierCreators;
+
+  StateIndex stutteringStateIndex;
+
+  StateIndex getNoOfStates();
+
+  // Creates the stuttering state, to which the transitions flagged with
+  // IsToStutteringState lead. Implied by Configuration::traversalHorizon.
+  void enableStutteringState();
+
+  // The index of the stuttering state, if one has been created.
+  std::optional<StateIndex> getStutteringStateIndex();
+
+  // The duplicate detection is exact, so no state is omitted.
+  double getOmissionProbability();
+
+  void traverse(cancellation_token cancellationToken);
+};
+
+}  // namespace pemc
+
+#endif  // PEMC_GENERIC_TRAVERSER_EXTERNAL_MEMORY_TRAVERSER_H_
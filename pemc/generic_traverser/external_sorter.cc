@@ -0,0 +1,210 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "pemc/generic_traverser/external_sorter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <random>
+
+#include "pemc/basic/ThrowAssert.hpp"
+#include "pemc/basic/exceptions.h"
+
+namespace pemc {
+
+namespace {
+// Size of the buffer of the C stream of a TemporaryFile.
+const size_t FileBufferSize = 1 << 20;
+
+std::atomic<int64_t> temporaryFileCounter(0);
+}  // namespace
+
+TemporaryFile::TemporaryFile(const std::string& directory) {
+  if (directory.empty()) {
+    file = std::tmpfile();
+  } else {
+    // The random part prevents collisions with other processes.
+    auto randomPart = std::random_device()();
+    path = directory + "/pemc-" + std::to_string(randomPart) + "-" +
+           std::to_string(temporaryFileCounter++) + ".tmp";
+    file = std::fopen(path.c_str(), "w+b");
+  }
+  if (file == nullptr)
+    throw OutOfMemoryException("Failed to create a temporary file in \"" +
+                               directory + "\".");
+  std::setvbuf(file, nullptr, _IOFBF, FileBufferSize);
+}
+
+TemporaryFile::~TemporaryFile() {
+  std::fclose(file);
+  if (!path.empty())
+    std::remove(path.c_str());
+}
+
+void TemporaryFile::write(const gsl::byte* data, size_t sizeInBytes) {
+  if (std::fwrite(data, 1, sizeInBytes, file) != sizeInBytes)
+    throw OutOfMemoryException(
+        "Failed to write to a temporary file. Check the free disk space.");
+}
+
+bool TemporaryFile::read(gsl::byte* data, size_t sizeInBytes) {
+  return std::fread(data, 1, sizeInBytes, file) == sizeInBytes;
+}
+
+void TemporaryFile::rewind() {
+  std::fflush(file);
+  std::fseek(file, 0, SEEK_SET);
+}
+
+ExternalSorter::Merger::Merger(ExternalSorter& _sorter,
+                               std::vector<TemporaryFile*> _runs)
+    : sorter(_sorter),
+      runs(_runs),
+      heads(_runs.size(), std::vector<gsl::byte>(_sorter.recordSize)),
+      current(_sorter.recordSize),
+      isGreater([this](size_t a, size_t b) {
+        // Equal keys are returned in the order of the runs.
+        auto comparison =
+            std::memcmp(heads[a].data(), heads[b].data(), sorter.keySize);
+        return comparison > 0 || (comparison == 0 && a > b);
+      }),
+      queue(isGreater) {
+  for (size_t i = 0; i < runs.size(); ++i) {
+    runs[i]->rewind();
+    if (runs[i]->read(heads[i].data(), sorter.recordSize))
+      queue.push(i);
+  }
+}
+
+const gsl::byte* ExternalSorter::Merger::next() {
+  if (queue.empty())
+    return nullptr;
+  auto run = queue.top();
+  queue.pop();
+  std::swap(current, heads[run]);
+  if (runs[run]->read(heads[run].data(), sorter.recordSize))
+    queue.push(run);
+  return current.data();
+}
+
+ExternalSorter::ExternalSorter(const std::string& _directory,
+                               size_t _recordSize,
+                               size_t _keySize,
+                               size_t bufferSizeInBytes)
+    : directory(_directory), recordSize(_recordSize), keySize(_keySize) {
+  throw_assert(keySize > 0 && keySize <= recordSize, "keySize invalid");
+  maximalRecordsInMemory = std::max<size_t>(1, bufferSizeInBytes / recordSize);
+}
+
+void ExternalSorter::add(const gsl::byte* record) {
+  throw_assert(!isSorted, "records cannot be added after sort()");
+  // The buffer grows on demand up to its maximal size.
+  if (buffer.size() < (recordsInBuffer + 1) * recordSize)
+    buffer.resize(std::min(maximalRecordsInMemory,
+                           std::max<size_t>(16, recordsInBuffer * 2)) *
+                  recordSize);
+  std::memcpy(buffer.data() + recordsInBuffer * recordSize, record,
+              recordSize);
+  ++recordsInBuffer;
+  ++numberOfRecords;
+  if (recordsInBuffer == maximalRecordsInMemory)
+    writeRun();
+}
+
+void ExternalSorter::sortBuffer() {
+  auto order = std::vector<size_t>(recordsInBuffer);
+  for (size_t i = 0; i < recordsInBuffer; ++i)
+    order[i] = i;
+  auto data = buffer.data();
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return std::memcmp(data + a * recordSize, data + b * recordSize,
+                       keySize) < 0;
+  });
+  auto sortedBuffer = std::vector<gsl::byte>(recordsInBuffer * recordSize);
+  for (size_t i = 0; i < recordsInBuffer; ++i)
+    std::memcpy(sortedBuffer.data() + i * recordSize,
+                data + order[i] * recordSize, recordSize);
+  buffer.swap(sortedBuffer);
+}
+
+void ExternalSorter::writeRun() {
+  sortBuffer();
+  auto run = std::make_unique<TemporaryFile>(directory);
+  run->write(buffer.data(), recordsInBuffer * recordSize);
+  runs.push_back(std::move(run));
+  recordsInBuffer = 0;
+}
+
+void ExternalSorter::sort() {
+  throw_assert(!isSorted, "sort() has already been called");
+  isSorted = true;
+  if (runs.empty()) {
+    // Everything fits into memory.
+    sortBuffer();
+    readRecordsInBuffer = 0;
+    return;
+  }
+  if (recordsInBuffer > 0)
+    writeRun();
+  buffer = std::vector<gsl::byte>();
+
+  // Merge the runs in several passes if there are too many runs to be merged
+  // at once.
+  while (runs.size() > MaximalRunsPerMerge) {
+    auto mergedRuns = std::vector<std::unique_ptr<TemporaryFile>>();
+    for (size_t first = 0; first < runs.size(); first += MaximalRunsPerMerge) {
+      auto last = std::min(runs.size(), first + MaximalRunsPerMerge);
+      auto runsToMerge = std::vector<TemporaryFile*>();
+      for (auto i = first; i < last; ++i)
+        runsToMerge.push_back(runs[i].get());
+      auto mergedRun = std::make_unique<TemporaryFile>(directory);
+      auto partialMerger = Merger(*this, runsToMerge);
+      while (auto record = partialMerger.next())
+        mergedRun->write(record, recordSize);
+      mergedRuns.push_back(std::move(mergedRun));
+    }
+    runs = std::move(mergedRuns);
+  }
+
+  auto runsToMerge = std::vector<TemporaryFile*>();
+  for (auto& run : runs)
+    runsToMerge.push_back(run.get());
+  merger = std::make_unique<Merger>(*this, runsToMerge);
+}
+
+const gsl::byte* ExternalSorter::next() {
+  throw_assert(isSorted, "sort() has not been called");
+  if (merger)
+    return merger->next();
+  if (readRecordsInBuffer == recordsInBuffer)
+    return nullptr;
+  return buffer.data() + (readRecordsInBuffer++) * recordSize;
+}
+
+int64_t ExternalSorter::getNumberOfRecords() {
+  return numberOfRecords;
+}
+
+}  // namespace pemc
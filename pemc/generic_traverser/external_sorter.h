@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef PEMC_GENERIC_TRAVERSER_EXTERNAL_SORTER_H_
+#define PEMC_GENERIC_TRAVERSER_EXTERNAL_SORTER_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <gsl/gsl_byte>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+
+namespace pemc {
+
+/// A binary file that is deleted when it is destroyed. The file is written
+/// sequentially and read sequentially after rewind() has been called.
+class TemporaryFile {
+ private:
+  std::FILE* file = nullptr;
+  std::string path;
+
+ public:
+  // If directory is empty, the temporary directory of the system is used.
+  TemporaryFile(const std::string& directory);
+  ~TemporaryFile();
+
+  TemporaryFile(const TemporaryFile&) = delete;
+  TemporaryFile& operator=(const TemporaryFile&) = delete;
+
+  void write(const gsl::byte* data, size_t sizeInBytes);
+
+  // Returns false if the end of the file has been reached.
+  bool read(gsl::byte* data, size_t sizeInBytes);
+
+  // Continues reading or writing at the beginning of the file.
+  void rewind();
+};
+
+///   Sorts records of a fixed size that do not fit into memory by their first
+///   keySize bytes (compared with memcmp; encode numbers in big endian).
+///   Records are collected in a buffer of bounded size, which is sorted and
+///   written as run to a temporary file when it is full. Afterwards, the runs
+///   are merged while the sorted records are read with next().
+class ExternalSorter {
+ private:
+  // The maximal number of runs that are merged at once.
+  static const size_t MaximalRunsPerMerge = 64;
+
+  class Merger {
+   private:
+    ExternalSorter& sorter;
+    std::vector<TemporaryFile*> runs;
+    std::vector<std::vector<gsl::byte>> heads;
+    std::vector<gsl::byte> current;
+    std::function<bool(size_t, size_t)> isGreater;
+    std::priority_queue<size_t, std::vector<size_t>, decltype(isGreater)> queue;
+
+   public:
+    Merger(ExternalSorter& _sorter, std::vector<TemporaryFile*> _runs);
+
+    // Returns nullptr if all records have been returned.
+    const gsl::byte* next();
+  };
+
+  std::string directory;
+  size_t recordSize;
+  size_t keySize;
+  size_t maximalRecordsInMemory;
+
+  std::vector<gsl::byte> buffer;
+  size_t recordsInBuffer = 0;
+  size_t readRecordsInBuffer = 0;
+  int64_t numberOfRecords = 0;
+
+  std::vector<std::unique_ptr<TemporaryFile>> runs;
+  std::unique_ptr<Merger> merger;
+
+  bool isSorted = false;
+
+  void sortBuffer();
+
+  void writeRun();
+
+ public:
+  ExternalSorter(const std::string& _directory,
+                 size_t _recordSize,
+                 size_t _keySize,
+                 size_t bufferSizeInBytes);
+
+  void add(const gsl::byte* record);
+
+  // Must be called after all records have been added and before next().
+  void sort();
+
+  // Returns the next record in sorted order, which is valid until the next
+  // call. Returns nullptr if all records have been returned.
+  const gsl::byte* next();
+
+  int64_t getNumberOfRecords();
+};
+
+}  // namespace pemc
+
+#endif  // PEMC_GENERIC_TRAVERSER_EXTERNAL_SORTER_H_
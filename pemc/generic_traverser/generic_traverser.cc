@@ -25,12 +25,18 @@
 #include "pemc/generic_traverser/generic_traverser.h"
 
 #include <algorithm>
+#include <exception>
 #include <limits>
 #include <optional>
+#include <thread>
 
 #include "pemc/basic/ThrowAssert.hpp"
 #include "pemc/basic/exceptions.h"
+#include "pemc/generic_traverser/barrier.h"
+#include "pemc/generic_traverser/load_balancer.h"
+#include "pemc/generic_traverser/lossy_state_storage.h"
 #include "pemc/generic_traverser/path_tracker.h"
+#include "pemc/generic_traverser/state_storage.h"
 #include "pemc/generic_traverser/traversal_transition.h"
 
 namespace {
@@ -45,11 +51,34 @@ class Worker {
       postStateStorageModifiers;
   PathTracker pathTracker;
   GenericTraverser& traverser;
-
-  Worker(const Configuration& conf, GenericTraverser& _traverser)
+  int32_t workerIndex;
+  // Breadth-first: new states are collected in nextLayer instead of
+  // pathTracker. Each worker has its own output buffer.
+  bool breadthFirst;
+  std::vector<StateIndex> nextLayer;
+  // Set while expanding the last layer before the horizon. Then, states that
+  // have not been found yet are not added, but replaced by the stuttering
+  // state.
+  bool redirectNewStatesToStutteringState = false;
+  // The transitions come without labels. The label of each new state is
+  // calculated once and cached in traverser.stateLabels.
+  bool deferLabels = false;
+  int32_t modelStateVectorSize = 0;
+  // The hashes of the successors are derived from the hash of the source
+  // state. Then, the states are added with their hash.
+  bool incrementalHashing = false;
+  int32_t stateVectorSize = 0;
+
+  Worker(const Configuration& conf,
+         GenericTraverser& _traverser,
+         int32_t _workerIndex)
       : pathTracker(PathTracker(conf.maximalSearchDepth)),
-        traverser(_traverser) {
-    // currently only single core traversal implemented.
+        traverser(_traverser),
+        workerIndex(_workerIndex),
+        breadthFirst(conf.traversalStrategy ==
+                     TraversalStrategy::BreadthFirst) {
+    // Each worker has its own instances of the transitionsCalculator and of
+    // the modifiers. Thus, they need not be thread safe.
 
     // instantiate an instance of ITransitionsCalculator, which can calculate
     // the successor transitions of a given state (ModelExecutor is the most
@@ -76,6 +105,10 @@ class Worker {
         getPreStateStorageModifierStateVectorSize();
     transitionsCalculator->setPreStateStorageModifierStateVectorSize(
         preStateStorageModifierStateVectorSize);
+    auto wholeStateVectorSize = transitionsCalculator->getStateVectorSize() +
+                                preStateStorageModifierStateVectorSize;
+    for (auto& preStateStorageModifier : preStateStorageModifiers)
+      preStateStorageModifier->setStateVectorSize(wholeStateVectorSize);
 
     // create an instance of each IPostStateStorageModifier
     postStateStorageModifiers =
@@ -90,6 +123,27 @@ class Worker {
                creator) { return creator(); });
   }
 
+  bool canDeferLabels() {
+    if (!transitionsCalculator->supportsDeferredLabels())
+      return false;
+    return std::none_of(preStateStorageModifiers.begin(),
+                        preStateStorageModifiers.end(),
+                        [](auto& modifier) {
+                          return modifier->requiresLabels();
+                        });
+  }
+
+  void enableDeferredLabels() {
+    deferLabels = true;
+    modelStateVectorSize = transitionsCalculator->getStateVectorSize();
+    transitionsCalculator->setDeferLabels(true);
+  }
+
+  Label calculateLabelOfState(gsl::byte* state) {
+    return transitionsCalculator->calculateLabelOfState(
+        gsl::span<gsl::byte>(state, modelStateVectorSize));
+  }
+
   int32_t getPreStateStorageModifierStateVectorSize() {
     auto preStateStorageModifierStateVectorSize = 0;
     for (auto& preStateStorageModifier : preStateStorageModifiers) {
@@ -99,8 +153,15 @@ class Worker {
     return preStateStorageModifierStateVectorSize;
   }
 
+  void enableIncrementalHashing() {
+    incrementalHashing = true;
+    stateVectorSize = traverser.stateStorage->getStateVectorSize();
+  }
+
+  // sourceState is empty for the initial transitions.
   void handleTransitions(std::optional<StateIndex> stateIndexOfSource,
-                         gsl::span<TraversalTransition> transitions) {
+                         gsl::span<TraversalTransition> transitions,
+                         gsl::span<gsl::byte> sourceState) {
     // handle transitions
 
     // new states and transitions calculated during this method call
@@ -114,19 +175,72 @@ class Worker {
                                    customPayloadOfLastCalculation);
     }
 
-    pathTracker.pushFrame();
+    uint64_t hashOfSource = 0;
+    if (incrementalHashing && !sourceState.empty())
+      hashOfSource = hashBufferLinear64(sourceState.data(), stateVectorSize);
+
+    if (!breadthFirst)
+      pathTracker.pushFrame();
     for (auto& transition : transitions) {
       StateIndex targetStateIndex;
       bool isNewState;
 
+      if (transition.flags & TraversalTransitionFlags::IsTransitionInvalid)
+        continue;
+
+      // Only the states of the state storage have a cached label.
+      bool hasCachedLabel = true;
       if (transition.flags & TraversalTransitionFlags::IsToStutteringState) {
         isNewState = false;
+        hasCachedLabel = false;
         targetStateIndex = traverser.stutteringStateIndex;
+      } else if (incrementalHashing) {
+        auto hash = sourceState.empty()
+                        ? hashBufferLinear64(transition.targetState,
+                                             stateVectorSize)
+                        : updateLinearHash64(hashOfSource, sourceState.data(),
+                                             transition.targetState,
+                                             stateVectorSize);
+        if (redirectNewStatesToStutteringState) {
+          isNewState = false;
+          if (!traverser.stateStorage->findStateWithHash(
+                  transition.targetState, hash, targetStateIndex)) {
+            hasCachedLabel = false;
+            targetStateIndex = traverser.stutteringStateIndex;
+          }
+        } else {
+          isNewState = traverser.stateStorage->addStateWithHash(
+              transition.targetState, hash, targetStateIndex);
+        }
+      } else if (redirectNewStatesToStutteringState) {
+        isNewState = false;
+        if (!traverser.stateStorage->findState(transition.targetState,
+                                               targetStateIndex)) {
+          hasCachedLabel = false;
+          targetStateIndex = traverser.stutteringStateIndex;
+        }
       } else {
         isNewState = traverser.stateStorage->addState(transition.targetState,
                                                       targetStateIndex);
       }
 
+      if (deferLabels) {
+        if (isNewState) {
+          try {
+            transition.label = calculateLabelOfState(transition.targetState);
+          } catch (...) {
+            // Do not let other workers wait forever for this label.
+            traverser.stateLabels->setLabel(targetStateIndex, Label());
+            throw;
+          }
+          traverser.stateLabels->setLabel(targetStateIndex, transition.label);
+        } else if (hasCachedLabel) {
+          transition.label = traverser.stateLabels->getLabel(targetStateIndex);
+        } else {
+          transition.label = calculateLabelOfState(transition.targetState);
+        }
+      }
+
       // Replace the targetState pointer with the unique indexes of the
       // transition's target state.
       transition.targetStateIndex = targetStateIndex;
@@ -135,7 +249,10 @@ class Worker {
 
       if (isNewState) {
         ++newStatesCount;
-        pathTracker.pushStateIndex(targetStateIndex);
+        if (breadthFirst)
+          nextLayer.push_back(targetStateIndex);
+        else
+          pathTracker.pushStateIndex(targetStateIndex);
       }
 
       ++newCalculatedTransitionCount;
@@ -147,25 +264,144 @@ class Worker {
     }
   }
 
-  void traverse(cancellation_token cancellationToken) {
-    // traverse initial transitions
+  void traverseInitialTransitions() {
     auto initialTransitions =
         transitionsCalculator->calculateInitialTransitions();
-    handleTransitions(std::optional<StateIndex>(), initialTransitions);
+    handleTransitions(std::optional<StateIndex>(), initialTransitions,
+                      gsl::span<gsl::byte>());
+  }
 
+  // stateBuffer is used to reconstruct compressed states.
+  void traverseState(StateIndex stateIndexToTraverse,
+                     std::vector<gsl::byte>& stateBuffer) {
+    auto stateToTraverse =
+        traverser.stateStorage->getState(stateIndexToTraverse, stateBuffer);
+    auto transitions =
+        transitionsCalculator->calculateTransitionsOfState(stateToTraverse);
+    handleTransitions(std::make_optional(stateIndexToTraverse), transitions,
+                      stateToTraverse);
+    traverser.stateStorage->releaseState(stateIndexToTraverse);
+  }
+
+  void traverse(cancellation_token cancellationToken,
+                LoadBalancer& loadBalancer) {
+    auto stateBuffer =
+        std::vector<gsl::byte>(traverser.stateStorage->getStateVectorSize());
     StateIndex stateIndexToTraverse;
-    while (pathTracker.tryGetStateIndex(stateIndexToTraverse)) {
-      if (cancellationToken.is_canceled()) {
-        return;
+    do {
+      while (pathTracker.tryGetStateIndex(stateIndexToTraverse)) {
+        if (cancellationToken.is_canceled() || loadBalancer.isTerminated()) {
+          return;
+        }
+        traverseState(stateIndexToTraverse, stateBuffer);
+        loadBalancer.balance(workerIndex);
       }
+    } while (loadBalancer.waitForWork(workerIndex, cancellationToken));
+  }
 
-      auto stateToTraverse = (*traverser.stateStorage)[stateIndexToTraverse];
-      auto transitions =
-          transitionsCalculator->calculateTransitionsOfState(stateToTraverse);
-      handleTransitions(std::make_optional(stateIndexToTraverse), transitions);
+  // Expands the states of layer. The workers take chunks of the layer
+  // by incrementing nextChunk until the layer has been consumed.
+  void traverseLayer(const std::vector<StateIndex>& layer,
+                     std::atomic<size_t>& nextChunk,
+                     cancellation_token cancellationToken) {
+    const size_t ChunkSize = 64;
+    auto stateBuffer =
+        std::vector<gsl::byte>(traverser.stateStorage->getStateVectorSize());
+    while (true) {
+      auto begin = nextChunk.fetch_add(ChunkSize);
+      if (begin >= layer.size())
+        return;
+      auto end = std::min(begin + ChunkSize, layer.size());
+      for (auto i = begin; i < end; ++i) {
+        if (cancellationToken.is_canceled())
+          return;
+        traverseState(layer[i], stateBuffer);
+      }
     }
   }
 };
+
+// Level-synchronous breadth-first traversal. The states of the initial layer
+// are in the nextLayer of the first worker. Returns the number of saved states
+// before each layer and after the last layer (see
+// GenericTraverser::layerStarts).
+std::vector<StateIndex> traverseBreadthFirst(
+    std::vector<std::unique_ptr<Worker>>& workers,
+    IStateStorage& stateStorage,
+    StateIndex statesBeforeInitialLayer,
+    int32_t horizon,
+    cancellation_token cancellationToken) {
+  auto numberOfWorkers = static_cast<int32_t>(workers.size());
+  auto layerStarts = std::vector<StateIndex>{statesBeforeInitialLayer};
+  auto currentLayer = std::vector<StateIndex>();
+  std::atomic<size_t> nextChunk{0};
+  std::atomic<bool> failed{false};
+  auto finished = false;
+  auto exceptions = std::vector<std::exception_ptr>(numberOfWorkers);
+  auto barrier = Barrier(numberOfWorkers);
+
+  // Must be called by a single thread while no worker expands states.
+  auto startNextLayer = [&]() {
+    currentLayer.clear();
+    for (auto& worker : workers) {
+      currentLayer.insert(currentLayer.end(), worker->nextLayer.begin(),
+                          worker->nextLayer.end());
+      worker->nextLayer.clear();
+    }
+    nextChunk = 0;
+    // All states of the layer have been found while expanding the previous
+    // layer. The number of saved states is the end of the layer.
+    if (!currentLayer.empty())
+      layerStarts.push_back(stateStorage.getNumberOfSavedStates());
+    // The successors of the states at depth horizon-1 are beyond the horizon
+    // unless they have been found before.
+    auto depthOfCurrentLayer = static_cast<int32_t>(layerStarts.size()) - 2;
+    for (auto& worker : workers) {
+      worker->redirectNewStatesToStutteringState =
+          horizon >= 0 && depthOfCurrentLayer + 1 >= horizon;
+    }
+    finished =
+        currentLayer.empty() || failed || cancellationToken.is_canceled();
+  };
+
+  startNextLayer();
+
+  auto runWorker = [&](int32_t workerIndex) {
+    while (!finished) {
+      if (!failed) {
+        try {
+          workers[workerIndex]->traverseLayer(currentLayer, nextChunk,
+                                              cancellationToken);
+        } catch (...) {
+          exceptions[workerIndex] = std::current_exception();
+          failed = true;
+        }
+      }
+      barrier.arriveAndWait();
+      if (workerIndex == 0)
+        startNextLayer();
+      barrier.arriveAndWait();
+    }
+  };
+
+  if (numberOfWorkers == 1) {
+    runWorker(0);
+  } else {
+    auto threads = std::vector<std::thread>();
+    threads.reserve(numberOfWorkers);
+    for (auto i = 0; i < numberOfWorkers; ++i) {
+      threads.emplace_back(runWorker, i);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+  for (auto& exception : exceptions) {
+    if (exception)
+      std::rethrow_exception(exception);
+  }
+  return layerStarts;
+}
 }  // namespace
 
 namespace pemc {
@@ -177,32 +413,156 @@ StateIndex GenericTraverser::getNoOfStates() {
   return stateStorage->getNumberOfSavedStates();
 }
 
+int32_t GenericTraverser::getNumberOfLayers() {
+  throw_assert(conf.traversalStrategy == TraversalStrategy::BreadthFirst,
+               "Layers are only known after a breadth-first traversal.");
+  return layerStarts.empty() ? 0 : static_cast<int32_t>(layerStarts.size() - 1);
+}
+
+int32_t GenericTraverser::getStateDepth(StateIndex stateIndex) {
+  throw_assert(conf.traversalStrategy == TraversalStrategy::BreadthFirst &&
+                   conf.stateStorageType == StateStorageType::Exact,
+               "Depths are only known after a breadth-first traversal with "
+               "an exact state storage.");
+  // Reserved states (e.g., the stuttering state) are not in any layer.
+  if (layerStarts.empty() || stateIndex < layerStarts.front() ||
+      stateIndex >= layerStarts.back())
+    return -1;
+  auto layerEnd =
+      std::upper_bound(layerStarts.begin(), layerStarts.end(), stateIndex);
+  return static_cast<int32_t>(layerEnd - layerStarts.begin() - 1);
+}
+
+void GenericTraverser::enableStutteringState() {
+  createStutteringState = true;
+}
+
+std::optional<StateIndex> GenericTraverser::getStutteringStateIndex() {
+  return createStutteringState ? std::make_optional(stutteringStateIndex)
+                               : std::optional<StateIndex>();
+}
+
+double GenericTraverser::getOmissionProbability() {
+  throw_assert(stateStorage, "traverse() has not been called, yet.");
+  return stateStorage->getOmissionProbability();
+}
+
 void GenericTraverser::traverse(cancellation_token cancellationToken) {
-  // currently only single core traversal implemented. Therefore, instantiate a
-  // single worker.
-  auto worker = Worker(conf, *this);
+  throw_assert(conf.numberOfWorkers >= 1, "At least one worker required");
+  // Instantiate the workers. The creators are called from this thread only,
+  // so they do not need to be thread safe.
+  auto workers = std::vector<std::unique_ptr<Worker>>();
+  workers.reserve(conf.numberOfWorkers);
+  for (auto i = 0; i < conf.numberOfWorkers; ++i) {
+    workers.push_back(std::make_unique<Worker>(conf, *this, i));
+  }
+  auto& firstWorker = *workers[0];
 
   // After the first worker has been initialized, it can be used to derive the
   // stateVectorSize and the traversalModifierStateVectorSize.
   auto modelStateVectorSize =
-      worker.transitionsCalculator->getStateVectorSize();
+      firstWorker.transitionsCalculator->getStateVectorSize();
   auto preStateStorageModifierStateVectorSize =
-      worker.getPreStateStorageModifierStateVectorSize();
+      firstWorker.getPreStateStorageModifierStateVectorSize();
 
   // Now the state state storage is initialized with the stateVectorSize
-  stateStorage =
-      std::make_unique<StateStorage>(conf.modelCapacity->getMaximalStates());
+  if (conf.stateStorageType == StateStorageType::Exact) {
+    auto maximalTreeNodes = conf.compressStateVectors
+                                ? conf.modelCapacity->getMaximalTreeNodes()
+                                : int64_t(0);
+    stateStorage = std::make_unique<StateStorage>(
+        conf.modelCapacity->getInitialStates(),
+        conf.modelCapacity->getMaximalStates(), maximalTreeNodes);
+  } else {
+    // Only the states waiting to be traversed are kept.
+    stateStorage = std::make_unique<LossyStateStorage>(
+        conf.stateStorageType, conf.lossyStateStorageMemory,
+        conf.bitstateHashFunctions, conf.modelCapacity->getMaximalStates());
+  }
   stateStorage->setStateVectorSize(modelStateVectorSize,
                                    preStateStorageModifierStateVectorSize);
   stateStorage->clear();
+  if (conf.incrementalStateHashing &&
+      stateStorage->supportsIncrementalHashing()) {
+    stateStorage->enableIncrementalHashing();
+    for (auto& worker : workers) {
+      worker->enableIncrementalHashing();
+    }
+  }
+
+  // Calculate the labels once per state if possible.
+  auto deferLabels =
+      conf.calculateLabelsPerState &&
+      conf.stateStorageType == StateStorageType::Exact &&
+      std::all_of(workers.begin(), workers.end(),
+                  [](auto& worker) { return worker->canDeferLabels(); });
+  stateLabels.reset();
+  if (deferLabels) {
+    stateLabels = std::make_unique<StateLabels>(
+        conf.modelCapacity->getInitialStates());
+    for (auto& worker : workers) {
+      worker->enableDeferredLabels();
+    }
+  }
 
-  // create a stuttering state if demanded.
+  // create a stuttering state if demanded. A horizon requires it.
+  if (conf.traversalHorizon >= 0) {
+    throw_assert(conf.traversalStrategy == TraversalStrategy::BreadthFirst,
+                 "A traversal horizon requires a breadth-first traversal.");
+    createStutteringState = true;
+  }
   if (createStutteringState) {
     stutteringStateIndex = stateStorage->reserveStateIndex();
   }
 
+  // The initial states are found by the first worker. The other workers get
+  // their work by splitting the path tracker of a busy worker or, when
+  // traversing breadth-first, by taking chunks of the current layer.
+  layerStarts.clear();
+  auto statesBeforeInitialLayer = stateStorage->getNumberOfSavedStates();
+  // With horizon 0 not even the initial states are added.
+  firstWorker.redirectNewStatesToStutteringState = conf.traversalHorizon == 0;
+  firstWorker.traverseInitialTransitions();
+
+  if (conf.traversalStrategy == TraversalStrategy::BreadthFirst) {
+    layerStarts = traverseBreadthFirst(workers, *stateStorage,
+                                       statesBeforeInitialLayer,
+                                       conf.traversalHorizon,
+                                       cancellationToken);
+    return;
+  }
+
+  auto pathTrackers = std::vector<PathTracker*>();
+  for (auto& worker : workers) {
+    pathTrackers.push_back(&worker->pathTracker);
+  }
+  auto loadBalancer = LoadBalancer(pathTrackers);
+
   // conduct the actual traversal
-  worker.traverse(cancellationToken);
+  if (conf.numberOfWorkers == 1) {
+    firstWorker.traverse(cancellationToken, loadBalancer);
+    return;
+  }
+  auto exceptions = std::vector<std::exception_ptr>(conf.numberOfWorkers);
+  auto threads = std::vector<std::thread>();
+  threads.reserve(conf.numberOfWorkers);
+  for (auto i = 0; i < conf.numberOfWorkers; ++i) {
+    threads.emplace_back([&, i]() {
+      try {
+        workers[i]->traverse(cancellationToken, loadBalancer);
+      } catch (...) {
+        exceptions[i] = std::current_exception();
+        loadBalancer.abort();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto& exception : exceptions) {
+    if (exception)
+      std::rethrow_exception(exception);
+  }
 }
 
 }  // namespace pemc
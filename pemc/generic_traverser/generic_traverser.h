@@ -30,6 +30,7 @@
 #include <functional>
 #include <gsl/span>
 #include <limits>
+#include <optional>
 #include <stack>
 #include <vector>
 
@@ -42,8 +43,9 @@
 #include "pemc/formula/formula.h"
 #include "pemc/generic_traverser/i_post_state_storage_modifier.h"
 #include "pemc/generic_traverser/i_pre_state_storage_modifier.h"
+#include "pemc/generic_traverser/i_state_storage.h"
 #include "pemc/generic_traverser/i_transitions_calculator.h"
-#include "pemc/generic_traverser/state_storage.h"
+#include "pemc/generic_traverser/state_labels.h"
 
 namespace pemc {
 
@@ -52,10 +54,19 @@ class GenericTraverser {
   const Configuration& conf;
   bool createStutteringState = false;
 
+  // Only used by breadth-first traversals: the number of saved states before
+  // each layer and after the last layer. The states of layer d (the states
+  // that are d steps after the initial distribution) have the indexes
+  // [layerStarts[d], layerStarts[d+1]).
+  std::vector<StateIndex> layerStarts;
+
  public:
   GenericTraverser(const Configuration& _conf);
 
   // a transitionsCalculator calculates the successors of a given state.
+  // All creators are called once per worker (see
+  // Configuration::numberOfWorkers). The created instances are used by a
+  // single worker thread only.
   std::function<std::unique_ptr<ITransitionsCalculator>()>
       transitionsCalculatorCreator;
 
@@ -74,12 +85,36 @@ class GenericTraverser {
       postStateStorageModifierCreators;
 
   // stores all encoutered states and maps each state to a unique index.
-  std::unique_ptr<StateStorage> stateStorage;
+  // The type of the storage is selected by Configuration::stateStorageType.
+  std::unique_ptr<IStateStorage> stateStorage;
 
   StateIndex stutteringStateIndex;
 
+  // The labels of the found states. Only set if the labels are calculated
+  // once per state (see Configuration::calculateLabelsPerState).
+  std::unique_ptr<StateLabels> stateLabels;
+
   StateIndex getNoOfStates();
 
+  // Creates the stuttering state, to which the transitions flagged with
+  // IsToStutteringState lead. Implied by Configuration::traversalHorizon.
+  void enableStutteringState();
+
+  // The index of the stuttering state, if one has been created.
+  std::optional<StateIndex> getStutteringStateIndex();
+
+  // The estimated probability that a state has been omitted, because the
+  // state storage is lossy.
+  double getOmissionProbability();
+
+  // The number of layers of a breadth-first traversal.
+  int32_t getNumberOfLayers();
+
+  // The number of steps from the initial distribution to the state, if the
+  // states have been found breadth-first by an exact state storage. The
+  // targets of the initial transitions have depth 0. -1 for reserved states.
+  int32_t getStateDepth(StateIndex stateIndex);
+
   void traverse(cancellation_token cancellationToken);
 };
 
@@ -51,9 +51,19 @@ class IPreStateStorageModifier {
 
   virtual int32_t getModifierStateVectorSize() { return 0; }
 
+  // Called by the traverser after all pre state storage modifiers have been
+  // created. _stateVectorSize is the size of the whole state vector of the
+  // transitions, i.e., the model part and the parts of all modifiers.
+  virtual void setStateVectorSize(int32_t _stateVectorSize) {}
+
+  // If false, the modifier does not look at the labels of the transitions.
+  // Then, the labels may be calculated after the state storage (see
+  // Configuration::calculateLabelsPerState).
+  virtual bool requiresLabels() { return true; }
+
   virtual void applyOnTransitions(std::optional<StateIndex> stateIndexOfSource,
                                   gsl::span<TraversalTransition> transitions,
-                                  void* customPayLoad);
+                                  void* customPayLoad) = 0;
 };
 
 }  // namespace pemc
@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef PEMC_GENERIC_TRAVERSER_I_STATE_STORAGE_H_
+#define PEMC_GENERIC_TRAVERSER_I_STATE_STORAGE_H_
+
+#include <cstdint>
+#include <gsl/gsl_byte>
+#include <gsl/span>
+
+#include "pemc/basic/exceptions.h"
+#include "pemc/basic/tsc_index.h"
+
+namespace pemc {
+
+///   Remembers the states found by the GenericTraverser and maps each new
+///   state to an index, under which the state can be retrieved until it has
+///   been released. addState, getState and releaseState can be used
+///   simultaneously by multiple threads.
+class IStateStorage {
+ public:
+  IStateStorage() = default;
+  virtual ~IStateStorage() = default;
+
+  virtual void setStateVectorSize(
+      int32_t _modelStateVectorSize,
+      int32_t _preStateStorageModifierStateVectorSize) = 0;
+
+  virtual int32_t getStateVectorSize() = 0;
+
+  virtual void clear() = 0;
+
+  virtual StateIndex reserveStateIndex() = 0;
+
+  // Returns true if the state is new.
+  virtual bool addState(gsl::byte* state, StateIndex& index) = 0;
+
+  // Incremental hashing: the caller passes hashBufferLinear64 of the state
+  // (usually derived from the hash of the source state with
+  // updateLinearHash64), so the state storage need not hash the whole state.
+  virtual bool supportsIncrementalHashing() { return false; }
+
+  // Afterwards, the states are identified by their linear hash. Must be
+  // called before the first state is added.
+  virtual void enableIncrementalHashing() {
+    throw NotImplementedYetException();
+  }
+
+  // As addState, but with the linear hash of the state.
+  virtual bool addStateWithHash(gsl::byte* state,
+                                uint64_t hash,
+                                StateIndex& index) {
+    return addState(state, index);
+  }
+
+  // As findState, but with the linear hash of the state.
+  virtual bool findStateWithHash(gsl::byte* state,
+                                 uint64_t hash,
+                                 StateIndex& index) {
+    return findState(state, index);
+  }
+
+  // Returns true if the state has already been added and sets its index.
+  // Does not add the state. Only supported by exact state storages.
+  virtual bool findState(gsl::byte* state, StateIndex& index) {
+    throw NotImplementedYetException();
+  }
+
+  // Returns the state with the given index. Implementations may use buffer,
+  // which must be of size getStateVectorSize(), to reconstruct the state.
+  virtual gsl::span<gsl::byte> getState(StateIndex idx,
+                                        gsl::span<gsl::byte> buffer) = 0;
+
+  // Called when the state with the given index has been traversed and is not
+  // needed anymore.
+  virtual void releaseState(StateIndex idx) {}
+
+  virtual StateIndex getNumberOfSavedStates() = 0;
+
+  // The estimated probability that a new state has been mistaken for an
+  // already found state. 0 for exact state storages.
+  virtual double getOmissionProbability() { return 0.0; }
+};
+
+}  // namespace pemc
+
+#endif  // PEMC_GENERIC_TRAVERSER_I_STATE_STORAGE_H_
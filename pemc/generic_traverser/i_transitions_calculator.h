@@ -33,6 +33,7 @@
 #include <stack>
 #include <limits>
 
+#include "pemc/basic/exceptions.h"
 #include "pemc/basic/tsc_index.h"
 #include "pemc/basic/label.h"
 #include "pemc/basic/model_capacity.h"
@@ -56,6 +57,23 @@ namespace pemc {
       virtual gsl::span<TraversalTransition> calculateTransitionsOfState(gsl::span<gsl::byte> state) = 0;
 
       virtual void* getCustomPayloadOfLastCalculation() = 0;
+
+      // The custom payload contains one element of this size per transition.
+      // Traversers that need to store the payload (e.g. ExternalMemoryTraverser)
+      // require it. 0 means that there is no payload.
+      virtual size_t getCustomPayloadElementSize() { return 0; }
+
+      // If the labels are deferred, the transitions are calculated without
+      // labels and the traverser calculates the label of each new target
+      // state with calculateLabelOfState. Only valid if the label of a
+      // transition depends on its target state alone.
+      virtual bool supportsDeferredLabels() { return false; }
+
+      virtual void setDeferLabels(bool _deferLabels) {}
+
+      virtual Label calculateLabelOfState(gsl::span<gsl::byte> state) {
+        throw NotImplementedYetException();
+      }
   };
 
 }
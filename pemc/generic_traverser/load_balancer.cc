@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "pemc/generic_traverser/load_balancer.h"
+
+#include <chrono>
+
+namespace pemc {
+
+LoadBalancer::LoadBalancer(std::vector<PathTracker*> _pathTrackers)
+    : pathTrackers(_pathTrackers), awaitingWork(_pathTrackers.size(), false) {}
+
+void LoadBalancer::balance(int32_t workerIndex) {
+  // Fast path without lock: nobody is waiting for work.
+  if (idleWorkers.load(std::memory_order_relaxed) == 0)
+    return;
+  auto& pathTracker = *pathTrackers[workerIndex];
+  if (!pathTracker.canSplit())
+    return;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto workerCount = static_cast<int32_t>(pathTrackers.size());
+  for (auto i = 0; i < workerCount && pathTracker.canSplit(); ++i) {
+    if (!awaitingWork[i])
+      continue;
+    // The idle worker waits on the condition variable and does not touch its
+    // path tracker until awaitingWork[i] has been reset under the lock.
+    if (pathTracker.splitWork(*pathTrackers[i])) {
+      awaitingWork[i] = false;
+      idleWorkers--;
+    }
+  }
+  workAvailable.notify_all();
+}
+
+bool LoadBalancer::waitForWork(int32_t workerIndex,
+                               cancellation_token cancellationToken) {
+  std::unique_lock<std::mutex> lock(mutex);
+  if (terminated)
+    return false;
+  awaitingWork[workerIndex] = true;
+  idleWorkers++;
+  if (idleWorkers == static_cast<int32_t>(pathTrackers.size())) {
+    // Every worker is idle, so nobody can create new work.
+    terminated = true;
+    workAvailable.notify_all();
+    return false;
+  }
+  while (awaitingWork[workerIndex] && !terminated) {
+    // Poll the cancellation token, because a canceled worker does not
+    // register itself as idle.
+    workAvailable.wait_for(lock, std::chrono::milliseconds(10));
+    if (cancellationToken.is_canceled())
+      return false;
+  }
+  return !terminated;
+}
+
+void LoadBalancer::abort() {
+  std::lock_guard<std::mutex> lock(mutex);
+  terminated = true;
+  workAvailable.notify_all();
+}
+
+bool LoadBalancer::isTerminated() {
+  return terminated;
+}
+
+}  // namespace pemc
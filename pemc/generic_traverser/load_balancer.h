@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef PEMC_GENERIC_TRAVERSER_LOAD_BALANCER_H_
+#define PEMC_GENERIC_TRAVERSER_LOAD_BALANCER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "pemc/basic/cancellation_token.h"
+#include "pemc/generic_traverser/path_tracker.h"
+
+namespace pemc {
+
+// The LoadBalancer distributes the work of a parallel traversal between the
+// workers. A worker that ran out of work registers itself as idle and waits.
+// Busy workers regularly check whether there are idle workers and, if so,
+// split their own path tracker and hand over a part of it (work stealing).
+// The traversal has finished when all workers are idle at the same time.
+class LoadBalancer {
+ private:
+  std::mutex mutex;
+  std::condition_variable workAvailable;
+  // the path trackers of the workers. They are not owned by the LoadBalancer.
+  std::vector<PathTracker*> pathTrackers;
+  // awaitingWork[i] is true, when worker i has registered itself as idle and
+  // has not received any work, yet.
+  std::vector<bool> awaitingWork;
+  // number of idle workers. Read without lock by busy workers.
+  std::atomic<int32_t> idleWorkers{0};
+  // set when all workers are idle or when the traversal has been aborted.
+  std::atomic<bool> terminated{false};
+
+ public:
+  LoadBalancer(std::vector<PathTracker*> _pathTrackers);
+
+  // Called regularly by busy worker workerIndex. If other workers are idle,
+  // the path tracker of workerIndex is split and work is handed over.
+  void balance(int32_t workerIndex);
+
+  // Called by worker workerIndex when its path tracker is empty. Blocks until
+  // the worker received new work (returns true) or until the traversal has
+  // finished or has been canceled (returns false).
+  bool waitForWork(int32_t workerIndex, cancellation_token cancellationToken);
+
+  // Lets all waiting workers return, e.g., when a worker failed.
+  void abort();
+
+  bool isTerminated();
+};
+
+}  // namespace pemc
+
+#endif  // PEMC_GENERIC_TRAVERSER_LOAD_BALANCER_H_
@@ -0,0 +1,209 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "pemc/generic_traverser/lossy_state_storage.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "pemc/basic/ThrowAssert.hpp"
+#include "pemc/basic/exceptions.h"
+#include "pemc/basic/raw_memory.h"
+
+namespace pemc {
+
+namespace {
+// Number of segments of the numerical integration of the expected number of
+// omissions of the bitstate table.
+const int64_t IntegrationSegments = 100000;
+
+uint64_t hashState(gsl::byte* state, int32_t stateVectorSize) {
+  return hashBuffer64(state, stateVectorSize, 0);
+}
+}  // namespace
+
+LossyStateStorage::LossyStateStorage(StateStorageType _type,
+                                     int64_t memoryInBytes,
+                                     int32_t _numberOfHashFunctions,
+                                     StateIndex maximalPendingStates) {
+  throw_assert(_type != StateStorageType::Exact, "type must be lossy");
+  throw_assert(memoryInBytes >= static_cast<int64_t>(sizeof(uint64_t)), "memory invalid");
+  throw_assert(_numberOfHashFunctions >= 1, "numberOfHashFunctions invalid");
+  type = _type;
+  numberOfHashFunctions = _numberOfHashFunctions;
+  tableSize = static_cast<uint64_t>(memoryInBytes) / sizeof(uint64_t);
+  table = std::make_unique<std::atomic<uint64_t>[]>(tableSize);
+  poolChunks.resize((maximalPendingStates + ChunkCapacity - 1) / ChunkCapacity);
+}
+
+void LossyStateStorage::setStateVectorSize(
+    int32_t _modelStateVectorSize,
+    int32_t _preStateStorageModifierStateVectorSize) {
+  modelStateVectorSize = _modelStateVectorSize;
+  preStateStorageModifierStateVectorSize =
+      _preStateStorageModifierStateVectorSize;
+  stateVectorSize =
+      modelStateVectorSize + preStateStorageModifierStateVectorSize;
+  // chunks are allocated with the new size on demand
+  for (auto& chunk : poolChunks)
+    chunk.reset();
+}
+
+int32_t LossyStateStorage::getStateVectorSize() {
+  return stateVectorSize;
+}
+
+void LossyStateStorage::clear() {
+  savedStates = 0;
+  for (uint64_t i = 0; i < tableSize; ++i) {
+    table[i].store(0);
+  }
+  freeSlots.clear();
+  usedSlots = 0;
+}
+
+StateIndex LossyStateStorage::acquireSlot() {
+  std::lock_guard<std::mutex> lock(poolMutex);
+  if (!freeSlots.empty()) {
+    auto slot = freeSlots.back();
+    freeSlots.pop_back();
+    return slot;
+  }
+  auto slot = usedSlots;
+  auto chunk = static_cast<size_t>(slot / ChunkCapacity);
+  if (chunk >= poolChunks.size())
+    throw OutOfMemoryException(
+        "Too many states are waiting to be traversed. Try increasing the "
+        "state capacity.");
+  if (!poolChunks[chunk]) {
+    poolChunks[chunk] = std::unique_ptr<gsl::byte[]>(
+        new gsl::byte[static_cast<size_t>(ChunkCapacity) * stateVectorSize]);
+  }
+  ++usedSlots;
+  return slot;
+}
+
+gsl::byte* LossyStateStorage::getSlotMemory(StateIndex slot) {
+  return poolChunks[slot / ChunkCapacity].get() +
+         static_cast<size_t>(slot % ChunkCapacity) * stateVectorSize;
+}
+
+StateIndex LossyStateStorage::reserveStateIndex() {
+  savedStates++;
+  return acquireSlot();
+}
+
+bool LossyStateStorage::addToBitstateTable(uint64_t hash) {
+  // Double hashing derives the k bit positions from two hashes, see Kirsch
+  // and Mitzenmacher, "Less hashing, same performance".
+  auto numberOfBits = tableSize * 64;
+  auto secondHash = mixBits64(hash) | 1;
+  auto isNewState = false;
+  for (auto i = 0; i < numberOfHashFunctions; ++i) {
+    auto bit = (hash + i * secondHash) % numberOfBits;
+    auto mask = uint64_t(1) << (bit % 64);
+    auto previousWord = table[bit / 64].fetch_or(mask);
+    if ((previousWord & mask) == 0)
+      isNewState = true;
+  }
+  return isNewState;
+}
+
+bool LossyStateStorage::addToHashCompactionTable(uint64_t hash) {
+  // 0 marks an empty slot
+  auto fingerprint = hash == 0 ? uint64_t(1) : hash;
+  auto position = mixBits64(hash) % tableSize;
+  for (size_t i = 0; i < ProbeThreshold; ++i) {
+    auto currentValue = table[position].load();
+    if (currentValue == 0) {
+      uint64_t expected = 0;
+      if (table[position].compare_exchange_strong(expected, fingerprint))
+        return true;
+      currentValue = expected;
+    }
+    if (currentValue == fingerprint)
+      return false;
+    position = (position + 1) % tableSize;
+  }
+  throw OutOfMemoryException(
+      "Failed to find an empty fingerprint slot within a reasonable amount of "
+      "time. Try increasing the memory of the lossy state storage.");
+}
+
+bool LossyStateStorage::addState(gsl::byte* state, StateIndex& index) {
+  auto hash = hashState(state, stateVectorSize);
+  auto isNewState = type == StateStorageType::Bitstate
+                        ? addToBitstateTable(hash)
+                        : addToHashCompactionTable(hash);
+  if (!isNewState) {
+    index = -1;
+    return false;
+  }
+  savedStates++;
+  index = acquireSlot();
+  copyBuffers(state, getSlotMemory(index), stateVectorSize);
+  return true;
+}
+
+gsl::span<gsl::byte> LossyStateStorage::getState(StateIndex idx,
+                                                 gsl::span<gsl::byte> buffer) {
+  throw_assert(idx >= 0, "idx not in range");
+  return gsl::span<gsl::byte>(getSlotMemory(idx), stateVectorSize);
+}
+
+void LossyStateStorage::releaseState(StateIndex idx) {
+  std::lock_guard<std::mutex> lock(poolMutex);
+  freeSlots.push_back(idx);
+}
+
+StateIndex LossyStateStorage::getNumberOfSavedStates() {
+  return savedStates;
+}
+
+double LossyStateStorage::getOmissionProbability() {
+  double n = savedStates;
+  double expectedOmissions;
+  if (type == StateStorageType::Bitstate) {
+    // The i-th new state is mistaken for a found state if all its k bits have
+    // already been set, which happens with probability (1-e^(-k*i/m))^k.
+    // The sum over all states is approximated by the midpoint rule.
+    double k = numberOfHashFunctions;
+    double m = static_cast<double>(tableSize) * 64;
+    auto segments = std::max<int64_t>(
+        1, std::min<int64_t>(IntegrationSegments, savedStates));
+    auto width = n / segments;
+    expectedOmissions = 0.0;
+    for (int64_t j = 0; j < segments; ++j) {
+      auto i = (j + 0.5) * width;
+      expectedOmissions += std::pow(-std::expm1(-k * i / m), k) * width;
+    }
+  } else {
+    // Two of the n states have the same 64 bit fingerprint (birthday bound).
+    expectedOmissions = n * (n - 1) / std::ldexp(1.0, 65);
+  }
+  // Probability that at least one omission occured.
+  return -std::expm1(-expectedOmissions);
+}
+
+}  // namespace pemc
@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef PEMC_GENERIC_TRAVERSER_LOSSY_STATE_STORAGE_H_
+#define PEMC_GENERIC_TRAVERSER_LOSSY_STATE_STORAGE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <gsl/span>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "pemc/basic/configuration.h"
+#include "pemc/basic/tsc_index.h"
+#include "pemc/generic_traverser/i_state_storage.h"
+
+namespace pemc {
+
+///   Remembers found states lossy to save memory, see Holzmann, "An analysis
+///   of bitstate hashing". Either k bits per state are set in a bit table
+///   (StateStorageType::Bitstate) or a 64 bit fingerprint per state is stored
+///   (StateStorageType::HashCompaction). A new state may be mistaken for an
+///   already found state if its bits or its fingerprint collide; then the
+///   state and its successors might be omitted. getOmissionProbability()
+///   estimates the probability of such an omission.
+///   The state vectors of new states are only kept in a pool until they have
+///   been released with releaseState(). Thus, the returned indexes are only
+///   valid until then and are reused afterwards. The index of a state that has
+///   been found before is -1.
+class LossyStateStorage : public IStateStorage {
+ private:
+  // The number of states per chunk of the pool.
+  static const StateIndex ChunkCapacity = 4096;
+
+  // The number of attempts that are made to find an empty fingerprint slot.
+  static const size_t ProbeThreshold = 1000;
+
+  StateStorageType type;
+  int32_t numberOfHashFunctions;
+
+  int32_t modelStateVectorSize = 0;
+  int32_t preStateStorageModifierStateVectorSize = 0;
+  int32_t stateVectorSize = 0;
+
+  std::atomic<StateIndex> savedStates;
+
+  // Bit table (Bitstate) or fingerprints (HashCompaction). 0 means empty.
+  uint64_t tableSize;
+  std::unique_ptr<std::atomic<uint64_t>[]> table;
+
+  // The pool of the state vectors that have not been released, yet. The
+  // chunks are never moved.
+  std::vector<std::unique_ptr<gsl::byte[]>> poolChunks;
+  std::mutex poolMutex;
+  std::vector<StateIndex> freeSlots;
+  StateIndex usedSlots = 0;
+
+  StateIndex acquireSlot();
+
+  gsl::byte* getSlotMemory(StateIndex slot);
+
+  bool addToBitstateTable(uint64_t hash);
+
+  bool addToHashCompactionTable(uint64_t hash);
+
+ public:
+  // memoryInBytes is the size of the table, maximalPendingStates the maximal
+  // number of states that are in the pool at the same time.
+  LossyStateStorage(StateStorageType _type,
+                    int64_t memoryInBytes,
+                    int32_t _numberOfHashFunctions,
+                    StateIndex maximalPendingStates);
+
+  virtual void setStateVectorSize(
+      int32_t _modelStateVectorSize,
+      int32_t _preStateStorageModifierStateVectorSize);
+
+  virtual int32_t getStateVectorSize();
+
+  virtual void clear();
+
+  virtual StateIndex reserveStateIndex();
+
+  virtual bool addState(gsl::byte* state, StateIndex& index);
+
+  virtual gsl::span<gsl::byte> getState(StateIndex idx,
+                                        gsl::span<gsl::byte> buffer);
+
+  virtual void releaseState(StateIndex idx);
+
+  virtual StateIndex getNumberOfSavedStates();
+
+  virtual double getOmissionProbability();
+};
+
+}  // namespace pemc
+
+#endif  // PEMC_GENERIC_TRAVERSER_LOSSY_STATE_STORAGE_H_
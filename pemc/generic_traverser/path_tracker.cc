@@ -32,7 +32,7 @@
 
 namespace pemc {
 
-PathTracker::PathTracker(int32_t _capacity) {
+PathTracker::PathTracker(StateIndex _capacity) {
   capacity = _capacity;
   pathFrames.reserve(_capacity);
   stateIndexEntries.reserve(_capacity);
@@ -40,7 +40,7 @@ PathTracker::PathTracker(int32_t _capacity) {
 
 void PathTracker::updateLowestSplittableFrame() {
   auto pathFrameCount = getPathFrameCount();
-  for (auto i = std::max(0, lowestSplittableFrame); i < pathFrameCount; ++i) {
+  for (auto i = std::max<StateIndex>(0, lowestSplittableFrame); i < pathFrameCount; ++i) {
     if (pathFrames[i].count > 1) {
       lowestSplittableFrame = i;
       return;
@@ -53,17 +53,18 @@ bool PathTracker::canSplit() {
   return lowestSplittableFrame != -1;
 }
 
-int32_t PathTracker::getPathFrameCount() {
+StateIndex PathTracker::getPathFrameCount() {
   return pathFrames.size();
 }
 
 void PathTracker::clear() {
   pathFrames.clear();
   stateIndexEntries.clear();
+  lowestSplittableFrame = -1;
 }
 
 void PathTracker::pushFrame() {
-  auto indexOfFirstStateIndexEntry = 0;
+  StateIndex indexOfFirstStateIndexEntry = 0;
   if (pathFrames.size() != 0) {
     auto& lastFrame = pathFrames.back();
     indexOfFirstStateIndexEntry =
@@ -128,10 +129,16 @@ bool PathTracker::tryGetStateIndex(StateIndex& stateIndex) {
       stateIndexEntries.erase(
           stateIndexEntries.begin() + firstStateIndexEntryToDelete,
           stateIndexEntries.end());
+      // Frames below the lowest splittable frame are never splittable. Thus,
+      // only the removed frame and the frame that just lost its topmost state
+      // might invalidate lowestSplittableFrame.
+      if (lowestSplittableFrame >= getPathFrameCount() - 1)
+        updateLowestSplittableFrame();
     } else {
       // Erase all remaining stateIndexEntries
       stateIndexEntries.erase(stateIndexEntries.begin(),
                               stateIndexEntries.end());
+      lowestSplittableFrame = -1;
     }
   }
 
@@ -140,13 +147,12 @@ bool PathTracker::tryGetStateIndex(StateIndex& stateIndex) {
 }
 
 bool PathTracker::splitWork(PathTracker& other) {
-  throw NotTestedYetException();  // "multi core not supported, yet"
   throw_assert(canSplit(), "Cannot split the state stack.");
   throw_assert(other.pathFrames.size() == 0, "Expected an empty state stack.");
 
   // We go through each frame and split the first frame with more than two
   // states in half
-  for (auto i = 0; i < pathFrames.size(); ++i) {
+  for (size_t i = 0; i < pathFrames.size(); ++i) {
     other.pushFrame();
 
     switch (pathFrames[i].count) {
@@ -172,7 +178,7 @@ bool PathTracker::splitWork(PathTracker& other) {
         auto thisCount = pathFrames[i].count - otherCount;
 
         // Add the first otherCount states to the other stack
-        for (auto j = 0; j < otherCount; ++j) {
+        for (StateIndex j = 0; j < otherCount; ++j) {
           other.pushStateIndex(
               stateIndexEntries[pathFrames[i].indexOfFirstStateIndexEntry + j]);
         }
@@ -41,9 +41,9 @@
 namespace pemc {
   struct PathFrame {
     // the offset into the states array where the index of the frame's first state is stored.
-    int32_t indexOfFirstStateIndexEntry; //offset
+    StateIndex indexOfFirstStateIndexEntry; //offset
     // the number of states the frame consists of.
-    int32_t count;
+    StateIndex count;
   };
 
   ///   When enumerating all states of a model in a depth-first fashion, we have to store the next states (that are computed all
@@ -58,22 +58,22 @@ namespace pemc {
       std::vector<StateIndex> stateIndexEntries;
 
       ///   The lowest index of a splittable frame. -1 if no frame is splittable.
-      int32_t lowestSplittableFrame = -1;
+      StateIndex lowestSplittableFrame = -1;
 
       //   Maximal number of stateIndexEntries.
-      int32_t capacity = 1 << 20;
+      StateIndex capacity = 1 << 20;
 
       ///   Finds the next splittable frame, if any.
       void updateLowestSplittableFrame();
 
   public:
-      PathTracker(int32_t _capacity);
+      PathTracker(StateIndex _capacity);
 
       ///   Indicates whether the pathFrames can be split.
       bool canSplit();
 
       ///   Gets the number of path frames.
-      int32_t getPathFrameCount();
+      StateIndex getPathFrameCount();
 
       ///   Clears all pathFrames and its stateIndexEntries.
       void clear();
@@ -88,6 +88,9 @@ namespace pemc {
       ///   Returns false to indicate that the path tracker was empty and no stateIndex was returned.
       bool tryGetStateIndex(StateIndex& stateIndex);
 
+      ///   Moves about half of the states of the lowest splittable frame to the
+      ///   empty path tracker other. Returns false if no work could be split.
+      ///   Not thread safe: The caller must ensure that other is not in use.
       bool splitWork(PathTracker& other);
 
       ///   Gets the path the path tracker currently represents, i.e.,
@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "pemc/generic_traverser/state_labels.h"
+
+#include <thread>
+
+#include "pemc/basic/ThrowAssert.hpp"
+
+namespace pemc {
+
+StateLabels::StateLabels(StateIndex _firstChunkCapacity)
+    : firstChunkCapacity(_firstChunkCapacity) {
+  throw_assert(firstChunkCapacity > 0, "The capacity must be positive.");
+  clear();
+}
+
+std::atomic<int32_t>& StateLabels::getEntry(StateIndex stateIndex) {
+  // The chunk j>0 contains the indexes in
+  // [firstChunkCapacity << (j-1), firstChunkCapacity << j).
+  auto quotient = static_cast<uint64_t>(stateIndex / firstChunkCapacity);
+  size_t chunk = 0;
+  while (quotient > 0) {
+    quotient >>= 1;
+    ++chunk;
+  }
+  auto chunkStart =
+      chunk == 0 ? StateIndex(0) : firstChunkCapacity << (chunk - 1);
+
+  auto chunkPointer = chunkPointers[chunk].load(std::memory_order_acquire);
+  if (chunkPointer == nullptr) {
+    std::lock_guard<std::mutex> lock(allocationMutex);
+    chunkPointer = chunkPointers[chunk].load(std::memory_order_acquire);
+    if (chunkPointer == nullptr) {
+      auto chunkCapacity = chunk == 0 ? firstChunkCapacity : chunkStart;
+      chunks[chunk] = std::make_unique<std::atomic<int32_t>[]>(chunkCapacity);
+      for (StateIndex i = 0; i < chunkCapacity; ++i) {
+        chunks[chunk][i].store(NotSet, std::memory_order_relaxed);
+      }
+      chunkPointer = chunks[chunk].get();
+      chunkPointers[chunk].store(chunkPointer, std::memory_order_release);
+    }
+  }
+  return chunkPointer[stateIndex - chunkStart];
+}
+
+void StateLabels::setLabel(StateIndex stateIndex, Label label) {
+  getEntry(stateIndex).store(label.value, std::memory_order_release);
+}
+
+Label StateLabels::getLabel(StateIndex stateIndex) {
+  auto& entry = getEntry(stateIndex);
+  auto value = entry.load(std::memory_order_acquire);
+  while (value == NotSet) {
+    std::this_thread::yield();
+    value = entry.load(std::memory_order_acquire);
+  }
+  auto label = Label();
+  label.value = value;
+  return label;
+}
+
+void StateLabels::clear() {
+  for (size_t chunk = 0; chunk < MaximalChunks; ++chunk) {
+    chunks[chunk].reset();
+    chunkPointers[chunk].store(nullptr);
+  }
+}
+
+}  // namespace pemc
@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef PEMC_GENERIC_TRAVERSER_STATE_LABELS_H_
+#define PEMC_GENERIC_TRAVERSER_STATE_LABELS_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "pemc/basic/label.h"
+#include "pemc/basic/tsc_index.h"
+
+namespace pemc {
+
+///   Caches the label of each state, indexed by its StateIndex. Used when the
+///   labels are calculated once per state instead of once per transition
+///   (see Configuration::calculateLabelsPerState). The labels are kept in
+///   chunks like the states of the StateStorage: chunk 0 contains the first
+///   firstChunkCapacity labels, chunk j>0 contains the next
+///   firstChunkCapacity << (j-1) labels. Chunks are allocated on demand and
+///   never moved.
+///   setLabel and getLabel can be used simultaneously by multiple threads.
+///   getLabel waits until the label of the state has been set, because a
+///   worker may find a state that another worker has just added.
+class StateLabels {
+ private:
+  // Marks a label, which has not been set yet. Valid labels have less than
+  // 31 bits, so they are never negative.
+  static const int32_t NotSet = -1;
+
+  static const size_t MaximalChunks = sizeof(StateIndex) * 8;
+
+  StateIndex firstChunkCapacity;
+
+  std::array<std::unique_ptr<std::atomic<int32_t>[]>, MaximalChunks> chunks;
+  std::array<std::atomic<std::atomic<int32_t>*>, MaximalChunks> chunkPointers;
+  std::mutex allocationMutex;
+
+  std::atomic<int32_t>& getEntry(StateIndex stateIndex);
+
+ public:
+  StateLabels(StateIndex _firstChunkCapacity);
+
+  void setLabel(StateIndex stateIndex, Label label);
+
+  Label getLabel(StateIndex stateIndex);
+
+  void clear();
+};
+
+}  // namespace pemc
+
+#endif  // PEMC_GENERIC_TRAVERSER_STATE_LABELS_H_
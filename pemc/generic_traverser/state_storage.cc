@@ -21,11 +21,11 @@
 // LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
-
 #include "pemc/generic_traverser/state_storage.h"
 
 #include <limits>
 #include <algorithm>
+#include <mutex>
 
 #include "pemc/basic/exceptions.h"
 #include "pemc/basic/ThrowAssert.hpp"
@@ -33,34 +33,104 @@
 
 namespace pemc {
 
-  StateStorage::StateStorage(StateIndex _capacity) {
-    throw_assert(_capacity >= 1024 && _capacity<=std::numeric_limits<StateIndex>::max(), "capacity invalid");
+  StateStorage::StateStorage(StateIndex _capacity)
+    : StateStorage(_capacity, _capacity) {
+  }
 
-	  totalCapacity = _capacity;
+  StateStorage::StateStorage(StateIndex _initialCapacity, StateIndex _maximalCapacity, int64_t _maximalTreeNodes) {
+    throw_assert(_initialCapacity >= 1024 && _initialCapacity <= _maximalCapacity, "capacity invalid");
+    throw_assert(_maximalCapacity <= std::numeric_limits<StateIndex>::max(), "capacity invalid");
+
+    maximalCapacity = _maximalCapacity;
+    maximalTreeNodes = _maximalTreeNodes;
+    totalCapacity = _maximalCapacity;
+    growable = false;
+
+    if (_initialCapacity < _maximalCapacity) {
+      // Chunks are addressed by shifts, therefore the first chunk has a size
+      // that is a power of two.
+      StateIndex initialCapacity = 1024;
+      while (initialCapacity < _initialCapacity)
+        initialCapacity <<= 1;
+      if (initialCapacity < _maximalCapacity) {
+        totalCapacity = initialCapacity;
+        growable = true;
+      }
+    }
+    firstChunkCapacity = totalCapacity;
+    allocatedCapacity = 0;
 
     indexMapper = std::make_unique<std::vector<std::atomic<StateIndex>>>(totalCapacity);
 
-    hashes = std::make_unique<alignedStateIndexVector>(totalCapacity);
-
-    throw_assert(sizeof(StateIndex)==4, "Used StateStorage not compatible with size of StateIndex");
+    hashes = std::make_unique<alignedBucketVector>(totalCapacity);
   }
 
+  gsl::byte* StateStorage::getStateMemory(StateIndex idx) {
+    if (idx < firstChunkCapacity)
+      return stateMemoryChunks[0].get() + static_cast<size_t>(idx) * storedStateVectorSize;
+    // Chunk j>0 starts at firstChunkCapacity << (j-1).
+    auto chunk = size_t(1);
+    auto chunkStart = firstChunkCapacity;
+    while (idx - chunkStart >= chunkStart) {
+      chunkStart <<= 1;
+      ++chunk;
+    }
+    return stateMemoryChunks[chunk].get() + static_cast<size_t>(idx - chunkStart) * storedStateVectorSize;
+  }
 
   gsl::span<gsl::byte> StateStorage::operator [](size_t idx) {
-    throw_assert(idx >= 0 && idx < totalCapacity, "idx not in range");
-    return gsl::span<gsl::byte>(stateMemory.data() + idx * stateVectorSize, stateVectorSize);
+    // Every valid index has been counted in savedStates by addState or
+    // reserveStateIndex before it has been handed out.
+    throw_assert(idx < static_cast<size_t>(savedStates.load(std::memory_order_relaxed)), "idx not in range");
+    throw_assert(!treeCompression, "compressed states must be retrieved with getState()");
+    return gsl::span<gsl::byte>(getStateMemory(static_cast<StateIndex>(idx)), stateVectorSize);
+  }
+
+  gsl::span<gsl::byte> StateStorage::getState(StateIndex idx, gsl::span<gsl::byte> buffer) {
+    if (!treeCompression)
+      return this->operator[](idx);
+    throw_assert(idx >= 0 && idx < savedStates.load(std::memory_order_relaxed), "idx not in range");
+    throw_assert(buffer.size() >= stateVectorSize, "buffer too small");
+    uint64_t root;
+    copyBuffers(getStateMemory(idx), reinterpret_cast<gsl::byte*>(&root), sizeof(uint64_t));
+    treeCompression->decompress(root, buffer.data());
+    return gsl::span<gsl::byte>(buffer.data(), stateVectorSize);
+  }
+
+  int32_t StateStorage::getStateVectorSize() {
+    return stateVectorSize;
+  }
+
+  bool StateStorage::isCompressed() {
+    return treeCompression != nullptr;
+  }
+
+  int64_t StateStorage::getStateMemoryUsage() {
+    auto usage = int64_t(allocatedCapacity) * storedStateVectorSize;
+    if (treeCompression)
+      usage += maximalTreeNodes * (sizeof(uint64_t) + sizeof(uint8_t));
+    return usage;
   }
 
   StateIndex StateStorage::getNumberOfSavedStates() {
     return savedStates;
   }
 
+  StateIndex StateStorage::getCapacity() {
+    return totalCapacity;
+  }
+
   StateIndex StateStorage::reserveStateIndex(){
+    std::unique_lock<std::shared_mutex> lock(growMutex, std::defer_lock);
+    if (growable)
+      lock.lock();
+
     auto freshCompactIndex = savedStates.fetch_add(1); //returns old value
 
     // Use the index pointing at the last possible element in the buffers and decrease the size.
     reservedStatesCapacity++;
     cachedStatesCapacity--;
+    reservedStateIndexes.push_back(freshCompactIndex);
 
     // Add BucketsPerCacheLine so returnIndex does not interfere with the maximal possible index returned by addState
     // which is _cachedStatesCapacity+BucketsPerCacheLine-1.
@@ -73,72 +143,276 @@ namespace pemc {
     return freshCompactIndex;
   }
 
+  void StateStorage::storeReservedStateIndexes() {
+    for (size_t i = 0; i < reservedStateIndexes.size(); ++i) {
+      auto hashBasedIndex = cachedStatesCapacity + BucketsPerCacheLine + reservedStateIndexes.size() - 1 - i;
+      (*indexMapper)[hashBasedIndex].store(reservedStateIndexes[i]);
+    }
+  }
+
+  size_t StateStorage::getHashedIndex(uint64_t fingerprint, int32_t probe) {
+    return mixBits64(fingerprint + static_cast<uint64_t>(probe) * 0x9E3779B97F4A7C15ULL) % cachedStatesCapacity;
+  }
+
+  uint64_t StateStorage::hashState(gsl::byte* state) {
+    if (incrementalHashing)
+      return hashBufferLinear64(state, storedStateVectorSize);
+    return storedStateOperations.hash64(state, 0);
+  }
+
+  bool StateStorage::supportsIncrementalHashing() {
+    return !treeCompression;
+  }
+
+  void StateStorage::enableIncrementalHashing() {
+    throw_assert(supportsIncrementalHashing(), "incremental hashing is not supported with tree compression");
+    throw_assert(savedStates.load() == reservedStatesCapacity, "states have already been added");
+    incrementalHashing = true;
+  }
+
   bool StateStorage::addState(gsl::byte* state, StateIndex& index){
+    // With tree compression, the root identifies the state.
+    uint64_t root;
+    if (treeCompression) {
+      root = treeCompression->compress(state);
+      state = reinterpret_cast<gsl::byte*>(&root);
+    }
+    return addHashedState(state, hashState(state), index);
+  }
+
+  bool StateStorage::addStateWithHash(gsl::byte* state, uint64_t hash, StateIndex& index){
+    throw_assert(incrementalHashing, "incremental hashing has not been enabled");
+    return addHashedState(state, hash, index);
+  }
+
+  bool StateStorage::addHashedState(gsl::byte* state, uint64_t hash, StateIndex& index){
+    bool isNewState;
+    if (!growable) {
+      if (tryAddState(state, hash, index, isNewState))
+        return isNewState;
+      throw OutOfMemoryException(
+        "Failed to find an empty hash table slot within a reasonable amount of time. Try increasing the state capacity.");
+    }
+
+    while (true) {
+      StateIndex observedCapacity;
+      {
+        std::shared_lock<std::shared_mutex> lock(growMutex);
+        observedCapacity = totalCapacity;
+        if (!needsToGrow() && tryAddState(state, hash, index, isNewState))
+          return isNewState;
+        if (totalCapacity >= maximalCapacity)
+          throw OutOfMemoryException(
+            "Failed to find an empty hash table slot within a reasonable amount of time. Try increasing the maximal state capacity.");
+      }
+      grow(observedCapacity);
+    }
+  }
+
+  bool StateStorage::tryAddState(gsl::byte* state, uint64_t hash, StateIndex& index, bool& isNewState){
 
 			// We don't have to do any out of bounds checks here
-			auto hash = hashBuffer(state, stateVectorSize, 0);
+			// We store 62 bit fingerprints as 64 bit integers, with the most significant bit #63 being set
+			// indicating the 'written' state and bit #62 indicating whether writing is not yet finished
+			// 'empty' is represented by 0
+			auto fingerprint = hash & FingerprintMask;
 			for (auto i = 1; i < ProbeThreshold; ++i) {
-				// We store 30 bit hash values as 32 bit integers, with the most significant bit #31 being set
-				// indicating the 'written' state and bit #30 indicating whether writing is not yet finished
-				// 'empty' is represented by 0
-				// We ignore two most significant bits of the original hash, which has no influence on the
-				// correctness of the algorithm, but might result in more state comparisons
-				auto hashedIndex = hashBuffer(reinterpret_cast<gsl::byte*>(&hash), sizeof(StateIndex), i * 8345723) % cachedStatesCapacity;
-				auto memoizedHash = hashedIndex & 0x3FFFFFFF;
+				auto hashedIndex = getHashedIndex(fingerprint, i);
 				auto cacheLineStart = (hashedIndex / BucketsPerCacheLine) * BucketsPerCacheLine;
 
-				for (auto j = 0; j < BucketsPerCacheLine; ++j)
+				for (size_t j = 0; j < BucketsPerCacheLine; ++j)
 				{
-					auto offset = static_cast<int32_t>(cacheLineStart + (hashedIndex + j) % BucketsPerCacheLine);
+					auto offset = static_cast<size_t>(cacheLineStart + (hashedIndex + j) % BucketsPerCacheLine);
 					auto currentValue = (*hashes)[offset].load();
 
-          auto expected = 0;
-          auto desired = (StateIndex)memoizedHash | (1 << 30);
-          auto successFullyChanged = (*hashes)[offset].compare_exchange_strong(expected, desired);
+					if (currentValue == 0) {
+						Bucket expected = 0;
+						auto successFullyChanged = (*hashes)[offset].compare_exchange_strong(expected, fingerprint | WritingFlag);
 
-					if (currentValue == 0 && successFullyChanged) {
-						auto freshCompactIndex = savedStates.fetch_add(1); //returns old value
-						(*indexMapper)[offset].store(freshCompactIndex);
+						if (successFullyChanged) {
+							auto freshCompactIndex = savedStates.fetch_add(1); //returns old value
+							(*indexMapper)[offset].store(freshCompactIndex);
 
-						copyBuffers(state, this->operator[](freshCompactIndex).data(), stateVectorSize);
-            // add memory fence to ensure the buffer was copied completely
-            // memory_order_release should be enough (could change to sequential consistency)
-            std::atomic_thread_fence(std::memory_order_release);
+							storedStateOperations.copy(state, getStateMemory(freshCompactIndex));
+							// add memory fence to ensure the buffer was copied completely
+							// memory_order_release should be enough (could change to sequential consistency)
+							std::atomic_thread_fence(std::memory_order_release);
 
-						(*hashes)[offset].store((StateIndex)memoizedHash | (1 << 31));
+							(*hashes)[offset].store(fingerprint | WrittenFlag);
 
-
-						index = freshCompactIndex;
-						return true;
+							index = freshCompactIndex;
+							isNewState = true;
+							return true;
+						}
+						// Another thread has taken the bucket in the meantime
+						currentValue = expected;
 					}
 
-					// We have to read the hash value again as it might have been written now where it previously was not
-					currentValue = (*hashes)[offset].load();
-					if ((currentValue & 0x3FFFFFFF) == memoizedHash) {
-						while ((currentValue & 1 << 31) == 0)
+					if ((currentValue & FingerprintMask) == fingerprint) {
+						while ((currentValue & WrittenFlag) == 0)
 							currentValue = (*hashes)[offset].load();
 
 						auto compactIndex = (*indexMapper)[offset].load();
 
-            // add memory fence to ensure the buffer was copied to completely (in another thread)
-            // memory_order_acquire should be enough (could change to sequential consistency)
-            std::atomic_thread_fence(std::memory_order_acquire);
-            // now compare
-						if (compactIndex!=-1 && areBuffersEqual(state, this->operator[](compactIndex).data(), stateVectorSize)) {
+						// add memory fence to ensure the buffer was copied to completely (in another thread)
+						// memory_order_acquire should be enough (could change to sequential consistency)
+						std::atomic_thread_fence(std::memory_order_acquire);
+						// now compare. Different states with the same fingerprint are
+						// unlikely, but possible.
+						if (compactIndex!=-1 && storedStateOperations.areEqual(state, getStateMemory(compactIndex))) {
 							index = compactIndex;
-							return false;
+							isNewState = false;
+							return true;
 						}
 					}
 				}
 			}
 
-			throw OutOfMemoryException(
-				"Failed to find an empty hash table slot within a reasonable amount of time. Try increasing the state capacity.");
+			return false;
 	}
 
+  bool StateStorage::findState(gsl::byte* state, StateIndex& index){
+    uint64_t root;
+    if (treeCompression) {
+      root = treeCompression->compress(state);
+      state = reinterpret_cast<gsl::byte*>(&root);
+    }
+
+    return findHashedState(state, hashState(state), index);
+  }
+
+  bool StateStorage::findStateWithHash(gsl::byte* state, uint64_t hash, StateIndex& index){
+    throw_assert(incrementalHashing, "incremental hashing has not been enabled");
+    return findHashedState(state, hash, index);
+  }
+
+  bool StateStorage::findHashedState(gsl::byte* state, uint64_t hash, StateIndex& index){
+    std::shared_lock<std::shared_mutex> lock(growMutex, std::defer_lock);
+    if (growable)
+      lock.lock();
+    return tryFindState(state, hash, index);
+  }
+
+  bool StateStorage::tryFindState(gsl::byte* state, uint64_t hash, StateIndex& index){
+    // Follows the probe sequence of tryAddState. The state would have been
+    // added to the first empty bucket, so the search ends there.
+    auto fingerprint = hash & FingerprintMask;
+    for (auto i = 1; i < ProbeThreshold; ++i) {
+      auto hashedIndex = getHashedIndex(fingerprint, i);
+      auto cacheLineStart = (hashedIndex / BucketsPerCacheLine) * BucketsPerCacheLine;
+
+      for (size_t j = 0; j < BucketsPerCacheLine; ++j) {
+        auto offset = static_cast<size_t>(cacheLineStart + (hashedIndex + j) % BucketsPerCacheLine);
+        auto currentValue = (*hashes)[offset].load();
+        if (currentValue == 0)
+          return false;
+        if ((currentValue & FingerprintMask) == fingerprint) {
+          while ((currentValue & WrittenFlag) == 0)
+            currentValue = (*hashes)[offset].load();
+          auto compactIndex = (*indexMapper)[offset].load();
+          std::atomic_thread_fence(std::memory_order_acquire);
+          if (compactIndex!=-1 && storedStateOperations.areEqual(state, getStateMemory(compactIndex))) {
+            index = compactIndex;
+            return true;
+          }
+        }
+      }
+    }
+    return false;
+  }
+
+  bool StateStorage::needsToGrow() {
+    // Grow at a load factor of 50%. The remaining half leaves enough room for
+    // the threads that add states concurrently.
+    return totalCapacity < maximalCapacity && savedStates.load() >= cachedStatesCapacity / 2;
+  }
+
+  void StateStorage::grow(StateIndex observedCapacity) {
+    std::unique_lock<std::shared_mutex> lock(growMutex);
+    if (totalCapacity != observedCapacity)
+      return;
+
+    auto newCapacity = static_cast<StateIndex>(std::min<int64_t>(int64_t(totalCapacity) * 2, maximalCapacity));
+    allocateChunks(newCapacity);
+
+    totalCapacity = newCapacity;
+    auto oldIndexMapper = std::move(indexMapper);
+    auto oldHashes = std::move(hashes);
+    indexMapper = std::make_unique<std::vector<std::atomic<StateIndex>>>(totalCapacity);
+    hashes = std::make_unique<alignedBucketVector>(totalCapacity);
+    for (auto& entry : *hashes) {
+      entry.store(0);
+    }
+    for (auto& entry : *indexMapper) {
+      entry.store(-1);
+    }
+    cachedStatesCapacity = totalCapacity - BucketsPerCacheLine - reservedStatesCapacity;
+    storeReservedStateIndexes();
+
+    // Rehash all states. The buckets contain the fingerprints, thus the states
+    // themselves need not be read. No other thread accesses the hash table and
+    // all buckets are written completely. Reserved states have no bucket.
+    for (size_t oldOffset = 0; oldOffset < oldHashes->size(); ++oldOffset) {
+      auto bucket = (*oldHashes)[oldOffset].load(std::memory_order_relaxed);
+      if (bucket != 0)
+        insertWhileGrowing(bucket & FingerprintMask, (*oldIndexMapper)[oldOffset].load(std::memory_order_relaxed));
+    }
+  }
+
+  void StateStorage::insertWhileGrowing(Bucket fingerprint, StateIndex compactIndex) {
+    // The first empty bucket can be taken without compare and swap.
+    for (auto i = 1; i < ProbeThreshold; ++i) {
+      auto hashedIndex = getHashedIndex(fingerprint, i);
+      auto cacheLineStart = (hashedIndex / BucketsPerCacheLine) * BucketsPerCacheLine;
+      for (size_t j = 0; j < BucketsPerCacheLine; ++j) {
+        auto offset = static_cast<size_t>(cacheLineStart + (hashedIndex + j) % BucketsPerCacheLine);
+        if ((*hashes)[offset].load(std::memory_order_relaxed) == 0) {
+          (*indexMapper)[offset].store(compactIndex, std::memory_order_relaxed);
+          (*hashes)[offset].store(fingerprint | WrittenFlag, std::memory_order_relaxed);
+          return;
+        }
+      }
+    }
+    throw OutOfMemoryException(
+      "Failed to find an empty hash table slot while rehashing. Try increasing the maximal state capacity.");
+  }
+
+  void StateStorage::allocateChunks(StateIndex capacity) {
+    if (storedStateVectorSize == 0)
+      return;
+    while (allocatedCapacity < capacity) {
+      size_t chunk = 0;
+      StateIndex chunkSize = firstChunkCapacity;
+      if (allocatedCapacity > 0) {
+        // allocatedCapacity is firstChunkCapacity << (chunk-1), which is also
+        // the size of the chunk.
+        chunkSize = allocatedCapacity;
+        for (auto start = firstChunkCapacity; start < allocatedCapacity; start <<= 1)
+          ++chunk;
+        ++chunk;
+        // The last chunk only needs to contain the states up to the maximal capacity.
+        chunkSize = std::min(chunkSize, maximalCapacity - allocatedCapacity);
+      }
+      throw_assert(chunk < MaximalChunks, "too many chunks");
+      stateMemoryChunks[chunk] = std::unique_ptr<gsl::byte[]>(new gsl::byte[static_cast<size_t>(chunkSize) * storedStateVectorSize]());
+      allocatedCapacity += chunkSize;
+    }
+  }
+
   void StateStorage::resizeStateBuffer(){
     stateVectorSize = modelStateVectorSize + preStateStorageModifierStateVectorSize;
-    stateMemory.resize(totalCapacity * stateVectorSize);
+    storedStateVectorSize = stateVectorSize;
+    treeCompression.reset();
+    // State vectors that are not larger than the root are stored as they are.
+    if (maximalTreeNodes > 0 && stateVectorSize > static_cast<int32_t>(sizeof(uint64_t))) {
+      treeCompression = std::make_unique<TreeCompression>(maximalTreeNodes, stateVectorSize);
+      storedStateVectorSize = sizeof(uint64_t);
+    }
+    storedStateOperations = getStateVectorOperations(storedStateVectorSize);
+    for (auto& chunk : stateMemoryChunks)
+      chunk.reset();
+    allocatedCapacity = 0;
+    allocateChunks(totalCapacity);
   }
 
   void StateStorage::setStateVectorSize(int32_t _modelStateVectorSize, int32_t _preStateStorageModifierStateVectorSize){
@@ -151,6 +425,10 @@ namespace pemc {
      savedStates = 0;
 
      reservedStatesCapacity = 0;
+     reservedStateIndexes.clear();
+
+     if (treeCompression)
+       treeCompression->clear();
 
      // capacity is reduced, because offset returned by this.add() may be up to
      // BucketsPerCacheLine-1 positions bigger than cachedStatesCapacity
@@ -29,6 +29,9 @@
 #include <gsl/span>
 #include <cstdint>
 #include <atomic>
+#include <array>
+#include <memory>
+#include <shared_mutex>
 #include <boost/align/aligned_allocator.hpp>
 
 #include "pemc/basic/tsc_index.h"
@@ -37,6 +40,8 @@
 #include "pemc/basic/model_capacity.h"
 #include "pemc/basic/raw_memory.h"
 #include "pemc/formula/formula.h"
+#include "pemc/generic_traverser/i_state_storage.h"
+#include "pemc/generic_traverser/tree_compression.h"
 
 namespace pemc {
 
@@ -44,22 +49,47 @@ namespace pemc {
   ///   Therefore, we use state hashes and one level of indirection.
   ///   The hashes are stored in a separate array, using open addressing,
   ///   see Laarman, "Scalable Multi-Core Model Checking", Algorithm 2.3.
+  ///   Each bucket keeps a 62 bit fingerprint of the state, so a matching
+  ///   bucket almost always belongs to the same state and the comparison with
+  ///   the (distant) state memory is rarely done in vain.
   ///   The method addState can be used simultaneously by multiple threads.
+  ///   If the initial capacity is smaller than the maximal capacity, the
+  ///   storage starts small and doubles its capacity (stop-the-world rehash)
+  ///   whenever the hash table is half full. The states are kept in chunks
+  ///   that are never moved, so a StateIndex and the span returned by
+  ///   operator[] stay valid while the storage grows.
+  ///   Optionally, the state vectors can be tree compressed. Then, only the
+  ///   root of the compressed state vector is stored here and states must be
+  ///   retrieved with getState() instead of operator[].
   ///   Note: Must be cleared with clear() before used.
-  class StateStorage {
+  class StateStorage : public IStateStorage {
   private:
 
       // The assumed size of a cache line in bytes.
       static const size_t CacheLineSize = 64;
 
       // The number of attempts that are made to find an empty bucket.
-      static const size_t ProbeThreshold = 1000;
+      static const int32_t ProbeThreshold = 1000;
+
+      // A bucket of the hash table. It contains a 62 bit fingerprint of the
+      // state and two flags, independent of the size of StateIndex.
+      using Bucket = uint64_t;
+
+      // Bucket flag: the state has been written completely.
+      static const Bucket WrittenFlag = 1ULL << 63;
+      // Bucket flag: the state is being written.
+      static const Bucket WritingFlag = 1ULL << 62;
+      // The bits of the fingerprint.
+      static const Bucket FingerprintMask = WritingFlag - 1;
 
       // The number of buckets that can be stored in a cache line.
-      static const size_t BucketsPerCacheLine = CacheLineSize / sizeof(StateIndex);
+      static const size_t BucketsPerCacheLine = CacheLineSize / sizeof(Bucket);
+
+      // The maximal number of chunks of stateMemory.
+      static const size_t MaximalChunks = sizeof(StateIndex) * 8;
 
       // special std::vector that is aligned for more speed
-      using alignedStateIndexVector = std::vector<std::atomic<StateIndex>, boost::alignment::aligned_allocator<std::atomic<StateIndex>, CacheLineSize> >;
+      using alignedBucketVector = std::vector<std::atomic<Bucket>, boost::alignment::aligned_allocator<std::atomic<Bucket>, CacheLineSize> >;
 
       // The length in bytes of a state vector required for the analysis model.
       int32_t modelStateVectorSize = 0;
@@ -68,39 +98,133 @@ namespace pemc {
       // The length in bytes of the state vector of the analysis model with the extra bytes
 		  // required for the preStateStorage modifiers
       int32_t stateVectorSize = 0;
+      // The length in bytes of the entries in stateMemory. Equals
+      // stateVectorSize or the size of the root if the states are compressed.
+      int32_t storedStateVectorSize = 0;
+      // Compare, copy and hash the entries in stateMemory. Specialised for
+      // storedStateVectorSize.
+      StateVectorOperations storedStateOperations{};
+      // The fingerprints are linear hashes (see hashBufferLinear64).
+      bool incrementalHashing = false;
+
+      // The number of nodes of the tree compression. 0 disables compression.
+      int64_t maximalTreeNodes;
+      // Only set if state vectors are compressed.
+      std::unique_ptr<TreeCompression> treeCompression;
 
       // The number of saved states
       std::atomic<StateIndex> savedStates;
   	  // The number of states that can be cached and the number of reserved states.
       StateIndex totalCapacity;
+      // The capacity the storage may grow to.
+      StateIndex maximalCapacity;
+      // True, if the capacity may grow up to maximalCapacity.
+      bool growable;
       // The number of states that can be cached.
   		StateIndex cachedStatesCapacity;
       // The number of reserved states
       StateIndex reservedStatesCapacity;
 
-      // the memory that contains the serialized states
-      std::vector<gsl::byte> stateMemory;
+      // The memory that contains the serialized states. Chunk 0 contains the
+      // first firstChunkCapacity states, chunk j>0 contains the next
+      // firstChunkCapacity << (j-1) states. Thus, growing only adds chunks.
+      std::array<std::unique_ptr<gsl::byte[]>, MaximalChunks> stateMemoryChunks;
+      // The number of states in chunk 0. Power of two in growable mode.
+      StateIndex firstChunkCapacity;
+      // The number of states that fit into the allocated chunks.
+      StateIndex allocatedCapacity;
+      // Indexes returned by reserveStateIndex(). They have no entry in the hash table.
+      std::vector<StateIndex> reservedStateIndexes;
       // maps the hashed based index to the index in the stateMemory and.
       std::unique_ptr<std::vector<std::atomic<StateIndex>>> indexMapper;
       // hashes in next line should be aligned for more speed
-      std::unique_ptr<alignedStateIndexVector> hashes;
+      std::unique_ptr<alignedBucketVector> hashes;
+
+      // Shared by addState, exclusive while growing. Only used in growable mode.
+      std::shared_mutex growMutex;
 
       void resizeStateBuffer();
 
+      void allocateChunks(StateIndex capacity);
+
+      gsl::byte* getStateMemory(StateIndex idx);
+
+      // Returns the bucket in hashes for the given probe of the given
+      // fingerprint. Depends only on the fingerprint, so the hash table can be
+      // rehashed without touching the states.
+      size_t getHashedIndex(uint64_t fingerprint, int32_t probe);
+
+      // Inserts an entry into the hash table while no other thread accesses it.
+      void insertWhileGrowing(Bucket fingerprint, StateIndex compactIndex);
+
+      // The hash of a state that is not given by the caller.
+      uint64_t hashState(gsl::byte* state);
+
+      // state is the stored state vector (the root with tree compression).
+      bool addHashedState(gsl::byte* state, uint64_t hash, StateIndex& index);
+
+      bool findHashedState(gsl::byte* state, uint64_t hash, StateIndex& index);
+
+      // Returns false if no empty bucket could be found.
+      bool tryAddState(gsl::byte* state, uint64_t hash, StateIndex& index, bool& isNewState);
+
+      bool tryFindState(gsl::byte* state, uint64_t hash, StateIndex& index);
+
+      bool needsToGrow();
+
+      // Doubles the capacity (at most to maximalCapacity) and rehashes all
+      // states. Does nothing if another thread has already grown the storage
+      // since observedCapacity has been read.
+      void grow(StateIndex observedCapacity);
+
+      // Sets the reserved entries of indexMapper after cachedStatesCapacity.
+      void storeReservedStateIndexes();
+
   public:
       StateStorage(StateIndex _capacity);
 
+      StateStorage(StateIndex _initialCapacity, StateIndex _maximalCapacity, int64_t _maximalTreeNodes = 0);
+
+      // Returns the stored state. Not available if states are compressed.
       gsl::span<gsl::byte> operator [](size_t idx);
 
-      StateIndex getNumberOfSavedStates();
+      // Returns the state with the given index. If the states are compressed,
+      // the state is reconstructed into buffer, which must be of size
+      // getStateVectorSize(). Each thread needs its own buffer.
+      virtual gsl::span<gsl::byte> getState(StateIndex idx, gsl::span<gsl::byte> buffer);
+
+      virtual int32_t getStateVectorSize();
+
+      bool isCompressed();
+
+      // Returns the number of bytes used to store states (without the hash table).
+      int64_t getStateMemoryUsage();
+
+      virtual StateIndex getNumberOfSavedStates();
+
+      StateIndex getCapacity();
+
+      virtual StateIndex reserveStateIndex();
+
+      virtual bool addState(gsl::byte* state, StateIndex& index);
+
+      // Not supported with tree compression, because the stored roots are
+      // hashed.
+      virtual bool supportsIncrementalHashing();
+
+      virtual void enableIncrementalHashing();
+
+      virtual bool addStateWithHash(gsl::byte* state, uint64_t hash, StateIndex& index);
 
-      StateIndex reserveStateIndex();
+      virtual bool findStateWithHash(gsl::byte* state, uint64_t hash, StateIndex& index);
 
-      bool addState(gsl::byte* state, StateIndex& index);
+      // With tree compression, the nodes of the state are added to the tree
+      // even if the state itself is not found.
+      virtual bool findState(gsl::byte* state, StateIndex& index);
 
-      void setStateVectorSize(int32_t _modelStateVectorSize, int32_t _preStateStorageModifierStateVectorSize);
+      virtual void setStateVectorSize(int32_t _modelStateVectorSize, int32_t _preStateStorageModifierStateVectorSize);
 
-      void clear();
+      virtual void clear();
   };
 
 }
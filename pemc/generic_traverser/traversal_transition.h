@@ -75,7 +75,7 @@ namespace pemc {
     return static_cast<TraversalTransitionFlags>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
   }
 
-  inline TraversalTransitionFlags operator|=(TraversalTransitionFlags a, const TraversalTransitionFlags b) {
+  inline TraversalTransitionFlags& operator|=(TraversalTransitionFlags& a, const TraversalTransitionFlags b) {
     a =  static_cast<TraversalTransitionFlags>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
     return a;
   }
@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "pemc/generic_traverser/tree_compression.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "pemc/basic/ThrowAssert.hpp"
+#include "pemc/basic/exceptions.h"
+#include "pemc/basic/raw_memory.h"
+
+namespace pemc {
+
+namespace {
+uint32_t readWord(gsl::byte* state, int32_t stateVectorSize, int32_t word) {
+  // The last word might be incomplete. It is padded with zeros.
+  uint32_t result = 0;
+  auto offset = word * static_cast<int32_t>(sizeof(uint32_t));
+  auto size = std::min<int32_t>(sizeof(uint32_t), stateVectorSize - offset);
+  std::memcpy(&result, state + offset, size);
+  return result;
+}
+
+void writeWord(gsl::byte* state,
+               int32_t stateVectorSize,
+               int32_t word,
+               uint32_t value) {
+  auto offset = word * static_cast<int32_t>(sizeof(uint32_t));
+  auto size = std::min<int32_t>(sizeof(uint32_t), stateVectorSize - offset);
+  std::memcpy(state + offset, &value, size);
+}
+
+uint64_t makePair(uint32_t left, uint32_t right) {
+  return (static_cast<uint64_t>(left) << 32) | right;
+}
+
+uint32_t getLeft(uint64_t pair) {
+  return static_cast<uint32_t>(pair >> 32);
+}
+
+uint32_t getRight(uint64_t pair) {
+  return static_cast<uint32_t>(pair);
+}
+}  // namespace
+
+TreeCompression::TreeCompression(int64_t _capacity, int32_t _stateVectorSize) {
+  throw_assert(_capacity > 0 && _capacity <= std::numeric_limits<uint32_t>::max(),
+               "capacity invalid");
+  throw_assert(_stateVectorSize > 0, "stateVectorSize invalid");
+  capacity = static_cast<size_t>(_capacity);
+  stateVectorSize = _stateVectorSize;
+  numberOfWords = (stateVectorSize + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+  values.resize(capacity);
+  flags = std::make_unique<std::atomic<uint8_t>[]>(capacity);
+}
+
+uint32_t TreeCompression::findOrAdd(uint64_t value) {
+  auto position = mixBits64(value) % capacity;
+  for (size_t i = 0; i < ProbeThreshold; ++i) {
+    auto flag = flags[position].load(std::memory_order_acquire);
+    if (flag == 0) {
+      uint8_t expected = 0;
+      if (flags[position].compare_exchange_strong(expected, 1)) {
+        values[position] = value;
+        flags[position].store(EntryWritten, std::memory_order_release);
+        numberOfNodes++;
+        return static_cast<uint32_t>(position);
+      }
+      flag = expected;
+    }
+    // Another thread might still be writing the value.
+    while (flag != EntryWritten)
+      flag = flags[position].load(std::memory_order_acquire);
+    if (values[position] == value)
+      return static_cast<uint32_t>(position);
+    position = (position + 1) % capacity;
+  }
+  throw OutOfMemoryException(
+      "Failed to find an empty slot in the table of the tree compression "
+      "within a reasonable amount of time. Try increasing the capacity of "
+      "tree nodes.");
+}
+
+uint64_t TreeCompression::compressRange(gsl::byte* state,
+                                        int32_t from,
+                                        int32_t to) {
+  if (to - from <= 2) {
+    auto left = readWord(state, stateVectorSize, from);
+    auto right = to - from == 2 ? readWord(state, stateVectorSize, from + 1) : 0;
+    return makePair(left, right);
+  }
+  auto middle = from + (to - from + 1) / 2;
+  auto left = findOrAdd(compressRange(state, from, middle));
+  auto right = findOrAdd(compressRange(state, middle, to));
+  return makePair(left, right);
+}
+
+void TreeCompression::decompressRange(uint64_t value,
+                                      gsl::byte* state,
+                                      int32_t from,
+                                      int32_t to) {
+  if (to - from <= 2) {
+    writeWord(state, stateVectorSize, from, getLeft(value));
+    if (to - from == 2)
+      writeWord(state, stateVectorSize, from + 1, getRight(value));
+    return;
+  }
+  auto middle = from + (to - from + 1) / 2;
+  decompressRange(values[getLeft(value)], state, from, middle);
+  decompressRange(values[getRight(value)], state, middle, to);
+}
+
+uint64_t TreeCompression::compress(gsl::byte* state) {
+  return compressRange(state, 0, numberOfWords);
+}
+
+void TreeCompression::decompress(uint64_t root, gsl::byte* state) {
+  decompressRange(root, state, 0, numberOfWords);
+}
+
+int64_t TreeCompression::getNumberOfNodes() {
+  return numberOfNodes;
+}
+
+void TreeCompression::clear() {
+  numberOfNodes = 0;
+  for (size_t i = 0; i < capacity; ++i) {
+    flags[i].store(0);
+  }
+}
+
+}  // namespace pemc
@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef PEMC_GENERIC_TRAVERSER_TREE_COMPRESSION_H_
+#define PEMC_GENERIC_TRAVERSER_TREE_COMPRESSION_H_
+
+#include <atomic>
+#include <cstdint>
+#include <gsl/span>
+#include <memory>
+#include <vector>
+
+namespace pemc {
+
+///   Compresses state vectors by splitting them recursively into halves and
+///   storing every half only once, see Laarman, "Scalable Multi-Core Model
+///   Checking", Chapter 4 (tree compression). The leaves of the tree are pairs
+///   of 32 bit words of the state vector, the inner nodes are pairs of 32 bit
+///   indexes of their children. Both are stored in a single lock-free table of
+///   64 bit entries. The root is not stored in the table but returned by
+///   compress(); thus, the 64 bit root identifies the state vector.
+///   The methods compress and decompress can be used simultaneously by
+///   multiple threads.
+///   Note: Must be cleared with clear() before used.
+class TreeCompression {
+ private:
+  // The number of attempts that are made to find an empty entry.
+  static const size_t ProbeThreshold = 1 << 13;
+
+  // Entry flags: 0 means empty, 1 means that the value is being written.
+  static const uint8_t EntryWritten = 2;
+
+  int32_t stateVectorSize;
+  int32_t numberOfWords;
+
+  size_t capacity;
+  std::atomic<int64_t> numberOfNodes;
+
+  std::vector<uint64_t> values;
+  std::unique_ptr<std::atomic<uint8_t>[]> flags;
+
+  uint32_t findOrAdd(uint64_t value);
+
+  uint64_t compressRange(gsl::byte* state, int32_t from, int32_t to);
+
+  void decompressRange(uint64_t value,
+                       gsl::byte* state,
+                       int32_t from,
+                       int32_t to);
+
+ public:
+  TreeCompression(int64_t _capacity, int32_t _stateVectorSize);
+
+  // Returns the root of the compressed state vector. Two state vectors are
+  // equal iff their roots are equal.
+  uint64_t compress(gsl::byte* state);
+
+  // Writes the state vector with the given root into state.
+  void decompress(uint64_t root, gsl::byte* state);
+
+  int64_t getNumberOfNodes();
+
+  void clear();
+};
+
+}  // namespace pemc
+
+#endif  // PEMC_GENERIC_TRAVERSER_TREE_COMPRESSION_H_
@@ -30,11 +30,14 @@
 #include "pemc/basic/ThrowAssert.hpp"
 #include "pemc/basic/exceptions.h"
 #include "pemc/formula/generate_label_based_formula_evaluator.h"
+#include "pemc/lmc/lmc_columns.h"
 
 namespace pemc {
 
 Lmc::Lmc(){};
 
+Lmc::~Lmc() = default;
+
 gsl::span<LmcStateEntry> Lmc::getStates() {
   return gsl::span<LmcStateEntry>(states.data(), stateCount);
 }
@@ -102,53 +105,69 @@ std::function<bool(TransitionIndex)> Lmc::createLabelBasedFormulaEvaluator(
   return evaluator;
 }
 
+LmcColumns& Lmc::getColumns() {
+  std::lock_guard<std::mutex> lock(columnsMutex);
+  if (!columns)
+    columns = std::make_unique<LmcColumns>(*this);
+  return *columns;
+}
+
 void Lmc::initialize(ModelCapacity& modelCapacity) {
+  columns.reset();
   maxNumberOfStates = modelCapacity.getMaximalStates();
   maxNumberOfStates =
       std::min(std::numeric_limits<StateIndex>::max(), maxNumberOfStates);
-  states.resize(maxNumberOfStates);
+  auto initialNumberOfStates =
+      std::min(maxNumberOfStates, modelCapacity.getInitialStates());
+  states.clear();
 
 #ifdef DEBUG
   // For debugging: be able to check if entries have already been written to
   // (indicated by -1)
   initialTransitionFrom = -1;
-  for (auto& stateEntry : states) {
-    stateEntry.from = -1;
-    stateEntry.elements = 0;
-  }
+  LmcStateEntry unwrittenStateEntry;
+  unwrittenStateEntry.from = -1;
+  unwrittenStateEntry.elements = 0;
+  statesInCreation.setFillValue(unwrittenStateEntry);
 #endif
+  statesInCreation.reset(initialNumberOfStates, maxNumberOfStates);
 
   // number of transitions is equal to number of targets
   maxNumberOfTransitions = modelCapacity.getMaximalTargets();
   maxNumberOfTransitions = std::min(std::numeric_limits<TransitionIndex>::max(),
                                     maxNumberOfTransitions);
-  transitions.resize(maxNumberOfTransitions);
+  auto initialNumberOfTransitions =
+      std::min(maxNumberOfTransitions, modelCapacity.getInitialTargets());
+  transitions.clear();
+  transitionsInCreation.reset(initialNumberOfTransitions,
+                              maxNumberOfTransitions);
 
   transitionCount = 0;
   stateCount = 0;
-
-  // TODO: to omit initialization, either use malloc and free, or use custom
-  // allocator (see stackoverflow)
-  // https://stackoverflow.com/questions/35551254/filling-a-vector-with-multiple-threads
-  // https://stackoverflow.com/questions/21028299/is-this-behavior-of-vectorresizesize-type-n-under-c11-and-boost-container/21028912#21028912
 }
 
 TransitionIndex Lmc::getPlaceForNewTransitionEntries(NoOfElements number) {
   auto locationOfFirstNewEntry =
       std::atomic_fetch_add(&transitionCount, number);
-  if (locationOfFirstNewEntry + number >= maxNumberOfTransitions ||
-      locationOfFirstNewEntry < 0)
+  // Compare against maxNumberOfTransitions - number, because
+  // locationOfFirstNewEntry + number may overflow TransitionIndex.
+  if (locationOfFirstNewEntry < 0 ||
+      locationOfFirstNewEntry >= maxNumberOfTransitions - number)
     throw OutOfMemoryException(
         "Unable to store transitions. Try increasing the transition capacity.");
+  transitionsInCreation.grow(locationOfFirstNewEntry + number);
   return locationOfFirstNewEntry;
 }
 
 TransitionIndex Lmc::getPlaceForNewTransitionEntriesOfState(
     StateIndex stateIndex,
     NoOfElements number) {
+  throw_assert(stateIndex >= 0 && stateIndex < maxNumberOfStates,
+               "Unable to store state. Try increasing the state capacity.");
   auto locationOfFirstNewEntry = getPlaceForNewTransitionEntries(number);
 
-  auto& stateEntry = states[stateIndex];
+  statesInCreation.grow(stateIndex + 1);
+  auto& stateEntry = statesInCreation[stateIndex];
   stateEntry.from = locationOfFirstNewEntry;
   stateEntry.elements = number;
   return locationOfFirstNewEntry;
@@ -164,13 +183,17 @@ TransitionIndex Lmc::getPlaceForNewInitialTransitionEntries(
 
 void Lmc::setLmcTransitionEntry(TransitionIndex index,
                                 const LmcTransitionEntry& entry) {
-  transitions[index] = entry;
+  transitionsInCreation[index] = entry;
 }
 
 void Lmc::createStutteringState(StateIndex stutteringStateIndex) {
   // The stuttering state might not be reached at all.
   // Make sure, that all used algorithms to not require a connected state graph.
-  auto& stateEntry = states[stutteringStateIndex];
+  throw_assert(
+      stutteringStateIndex >= 0 && stutteringStateIndex < maxNumberOfStates,
+      "Unable to store state. Try increasing the state capacity.");
+  statesInCreation.grow(stutteringStateIndex + 1);
+  auto& stateEntry = statesInCreation[stutteringStateIndex];
 
 #ifdef DEBUG
   // For debugging: check if entries have already been written to (indicated by
@@ -180,7 +203,7 @@ void Lmc::createStutteringState(StateIndex stutteringStateIndex) {
 #endif
 
   auto locationOfNewEntry = getPlaceForNewTransitionEntries(1);
-  auto& transitionEntry = transitions[locationOfNewEntry];
+  auto& transitionEntry = transitionsInCreation[locationOfNewEntry];
   transitionEntry.label = Label();
   transitionEntry.probability = Probability(1.0);
   transitionEntry.state = stutteringStateIndex;
@@ -189,11 +212,36 @@ void Lmc::createStutteringState(StateIndex stutteringStateIndex) {
   stateEntry.elements = 1;
 }
 
+void Lmc::setHorizon(std::optional<int32_t> _horizon) {
+  horizon = _horizon;
+}
+
+std::optional<int32_t> Lmc::getHorizon() {
+  return horizon;
+}
+
+void Lmc::setTruncatedForPhiUntilPsi(
+    std::optional<std::tuple<std::string, std::string>>
+        _truncatedForPhiUntilPsi) {
+  truncatedForPhiUntilPsi = _truncatedForPhiUntilPsi;
+}
+
+std::optional<std::tuple<std::string, std::string>>
+Lmc::getTruncatedForPhiUntilPsi() {
+  return truncatedForPhiUntilPsi;
+}
+
 void Lmc::finishCreation(StateIndex _stateCount) {
   // Note: Do not miss to count the optional stuttering state!
+  throw_assert(_stateCount >= 0 && _stateCount <= maxNumberOfStates,
+               "Unable to store state. Try increasing the state capacity.");
+  columns.reset();
   stateCount = _stateCount;
+  statesInCreation.grow(stateCount);
   states.resize(stateCount);
+  statesInCreation.moveTo(states.data(), stateCount);
   transitions.resize(transitionCount);
+  transitionsInCreation.moveTo(transitions.data(), transitionCount);
 }
 
 void Lmc::validate() {
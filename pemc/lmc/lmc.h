@@ -28,9 +28,14 @@
 #include <atomic>
 #include <functional>
 #include <gsl/span>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <tuple>
 #include <vector>
 
+#include "pemc/basic/chunked_array.h"
 #include "pemc/basic/dll_defines.h"
 #include "pemc/basic/label.h"
 #include "pemc/basic/model_capacity.h"
@@ -40,9 +45,11 @@
 
 namespace pemc {
 
+class LmcColumns;
+
 struct LmcStateEntry {
   TransitionIndex from;
-  int32_t elements;
+  NoOfElements elements;
 };
 
 // Transition = Target + Probability
@@ -56,25 +63,45 @@ struct LmcTransitionEntry {
       : probability(_probability), label(_label), state(_state) {}
 };
 
+// While the Lmc is created, the states and transitions are written into
+// chunked arrays that grow on demand up to the maximal capacity. On
+// finishCreation, they are moved into contiguous vectors.
 class Lmc {
  private:
   TransitionIndex maxNumberOfTransitions = 0;
   std::atomic<TransitionIndex> transitionCount{0};
   std::vector<LmcTransitionEntry> transitions;
+  ChunkedArray<LmcTransitionEntry> transitionsInCreation;
   TransitionIndex initialTransitionFrom =
       -1;  // is uninitialized at first, but may be something else than 0
-  int32_t initialTransitionElements = 0;
+  NoOfElements initialTransitionElements = 0;
 
   StateIndex maxNumberOfStates = 0;
   StateIndex stateCount = 0;
   std::vector<LmcStateEntry> states;
+  ChunkedArray<LmcStateEntry> statesInCreation;
 
   std::vector<std::string> labelIdentifier;
 
+  // Set if only the states up to a depth have been expanded. Then, the Lmc
+  // only gives exact results for bounds up to the horizon.
+  std::optional<int32_t> horizon;
+
+  // Set if the successors of transitions that satisfy psi or violate phi have
+  // not been expanded (see Pemc::buildLmcFromExecutableModelForFormula).
+  // Then, the Lmc only gives exact results for phi U psi. Contains phi and psi
+  // as strings; phi is empty for F psi.
+  std::optional<std::tuple<std::string, std::string>> truncatedForPhiUntilPsi;
+
+  // Created by the first call of getColumns().
+  std::unique_ptr<LmcColumns> columns;
+  std::mutex columnsMutex;
+
   TransitionIndex getPlaceForNewTransitionEntries(NoOfElements number);
 
  public:
   Lmc();
+  ~Lmc();
 
   gsl::span<LmcStateEntry> getStates();
 
@@ -97,6 +124,19 @@ class Lmc {
                              const LmcTransitionEntry& entry);
   void createStutteringState(StateIndex stutteringStateIndex);
 
+  void setHorizon(std::optional<int32_t> _horizon);
+  std::optional<int32_t> getHorizon();
+
+  void setTruncatedForPhiUntilPsi(
+      std::optional<std::tuple<std::string, std::string>>
+          _truncatedForPhiUntilPsi);
+  std::optional<std::tuple<std::string, std::string>>
+  getTruncatedForPhiUntilPsi();
+
+  // The column layout of the finished Lmc for the model checker. It is copied
+  // once and reused by all queries.
+  LmcColumns& getColumns();
+
   void initialize(ModelCapacity& modelCapacity);
   void finishCreation(StateIndex _stateCount);
   void validate();
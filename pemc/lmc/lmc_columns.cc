@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "pemc/lmc/lmc_columns.h"
+
+#include "pemc/formula/generate_label_based_formula_evaluator.h"
+
+namespace pemc {
+
+LmcColumns::LmcColumns(Lmc& lmc) {
+  auto states = lmc.getStates();
+  auto transitions = lmc.getTransitions();
+  stateCount = static_cast<StateIndex>(states.size());
+
+  auto labelIdentifierOfLmc = lmc.getLabelIdentifier();
+  labelIdentifier.assign(labelIdentifierOfLmc.begin(),
+                         labelIdentifierOfLmc.end());
+
+  // The transitions of the Lmc are stored in the order in which the states
+  // have been expanded. Copy them row by row to get a CSR layout.
+  rowOffsets.resize(stateCount + 2);
+  probabilities.resize(transitions.size());
+  targets.resize(transitions.size());
+  labels.resize(transitions.size());
+
+  TransitionIndex next = 0;
+  auto copyRow = [&](TransitionIndex begin, TransitionIndex end) {
+    for (auto t = begin; t < end; t++) {
+      auto& transition = transitions[t];
+      probabilities[next] = transition.probability;
+      targets[next] = transition.state;
+      labels[next] = transition.label;
+      next++;
+    }
+  };
+
+  TransitionIndex begin, end = 0;
+  for (StateIndex s = 0; s < stateCount; ++s) {
+    rowOffsets[s] = next;
+    std::tie(begin, end) = lmc.getTransitionIndexesOfState(s);
+    copyRow(begin, end);
+  }
+  rowOffsets[stateCount] = next;
+  std::tie(begin, end) = lmc.getInitialTransitionIndexes();
+  copyRow(begin, end);
+  rowOffsets[stateCount + 1] = next;
+
+  probabilities.resize(next);
+  targets.resize(next);
+  labels.resize(next);
+}
+
+std::function<bool(TransitionIndex)>
+LmcColumns::createLabelBasedFormulaEvaluator(Formula* formula) {
+  auto labelEvaluator = generateLabelBasedFormulaEvaluator(
+      gsl::span<std::string>(labelIdentifier), formula);
+  std::function<bool(TransitionIndex)> evaluator =
+      [this, labelEvaluator](TransitionIndex transitionIndex) {
+        return labelEvaluator(this->labels[transitionIndex]);
+      };
+  return evaluator;
+}
+
+}  // namespace pemc
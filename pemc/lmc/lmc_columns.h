@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef PEMC_LMC_LMC_COLUMNS_H_
+#define PEMC_LMC_LMC_COLUMNS_H_
+
+#include <functional>
+#include <gsl/span>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "pemc/basic/label.h"
+#include "pemc/basic/probability.h"
+#include "pemc/basic/tsc_index.h"
+#include "pemc/formula/formula.h"
+#include "pemc/lmc/lmc.h"
+
+namespace pemc {
+
+// Structure-of-arrays copy of an Lmc for the numerical algorithms.
+// The transitions of a state are stored consecutively (CSR layout), so the
+// offset of the next state replaces the number of elements of LmcStateEntry.
+// Probabilities, targets and labels are kept in separate columns. Thus, an
+// iteration over all transitions streams only the probability and target
+// columns (12 bytes per transition instead of the 16 bytes of
+// LmcTransitionEntry) and the labels are only read once per formula.
+// The initial transitions are stored as an additional row after the last
+// state.
+class LmcColumns {
+ private:
+  StateIndex stateCount = 0;
+  std::vector<TransitionIndex> rowOffsets;
+  std::vector<Probability> probabilities;
+  std::vector<StateIndex> targets;
+  std::vector<Label> labels;
+
+  std::vector<std::string> labelIdentifier;
+
+ public:
+  explicit LmcColumns(Lmc& lmc);
+
+  StateIndex getStateCount() const { return stateCount; }
+  TransitionIndex getTransitionCount() const {
+    return static_cast<TransitionIndex>(probabilities.size());
+  }
+
+  // stateCount + 2 entries: one row per state, one row of initial transitions
+  // and the end of the last row.
+  gsl::span<const TransitionIndex> getRowOffsets() const { return rowOffsets; }
+  gsl::span<const Probability> getProbabilities() const {
+    return probabilities;
+  }
+  gsl::span<const StateIndex> getTargets() const { return targets; }
+  gsl::span<const Label> getLabels() const { return labels; }
+
+  std::tuple<TransitionIndex, TransitionIndex> getTransitionIndexesOfState(
+      StateIndex state) const {
+    return std::make_tuple(rowOffsets[state], rowOffsets[state + 1]);
+  }
+  std::tuple<TransitionIndex, TransitionIndex> getInitialTransitionIndexes()
+      const {
+    return getTransitionIndexesOfState(stateCount);
+  }
+
+  // Same as Lmc::createLabelBasedFormulaEvaluator, but the TransitionIndex
+  // refers to the columns.
+  std::function<bool(TransitionIndex)> createLabelBasedFormulaEvaluator(
+      Formula* formula);
+};
+
+}  // namespace pemc
+
+#endif  // PEMC_LMC_LMC_COLUMNS_H_
@@ -24,76 +24,26 @@
 
 #include "pemc/lmc/lmc_model_checker.h"
 
+#include <algorithm>
 #include <boost/timer/timer.hpp>
+#include <cmath>
+#include <tuple>
 #include <utility>
 #include <vector>
 
-#include "pemc/basic/exceptions.h"
+#include "pemc/basic/ThrowAssert.hpp"
+#include "pemc/basic/raw_memory.h"
+#include "pemc/basic/thread_pool.h"
 #include "pemc/formula/formula_utils.h"
+#include "pemc/lmc/lmc_columns.h"
+#include "pemc/lmc/lmc_reduced_matrix.h"
 
 namespace {
 using namespace pemc;
 using boost::timer::cpu_timer;
 
-enum PrecalculatedTransition : uint8_t {
-  Nothing = 0,
-  SatisfiedDirect = 1,
-  ExcludedDirect = 2,
-  Satisfied = 4,  // Satisfied for the current run
-  Excluded = 8,   // Excluded for the current run
-  Mark = 16,
-};
-
-void calculateIteration(Lmc& lmc,
-                        gsl::span<PrecalculatedTransition> precalculations,
-                        gsl::span<Probability> xold,
-                        gsl::span<Probability> xnew) {
-  auto stateCount = lmc.getStates().size();
-  for (StateIndex s = 0; s < stateCount; ++s) {
-    auto transitions = lmc.getTransitions();
-    auto sum = Probability::Zero();
-    TransitionIndex begin, end = 0;
-    std::tie(begin, end) = lmc.getTransitionIndexesOfState(s);
-
-    for (TransitionIndex t = begin; t < end; t++) {
-      auto& transition = transitions[t];
-      auto& precalulated = precalculations[t];
-      if (precalulated & PrecalculatedTransition::Satisfied) {
-        sum += transition.probability;
-
-      } else if (precalulated & PrecalculatedTransition::Excluded) {
-      } else {
-        sum += transition.probability * xold[transition.state];
-      }
-    }
-    xnew[s] = sum;
-  }
-}
-
-Probability calculateInitialProbability(
-    Lmc& lmc,
-    gsl::span<PrecalculatedTransition> precalculations,
-    gsl::span<Probability> x) {
-  auto transitions = lmc.getTransitions();
-  auto sum = Probability::Zero();
-  TransitionIndex begin, end = 0;
-  std::tie(begin, end) = lmc.getInitialTransitionIndexes();
-
-  for (TransitionIndex t = begin; t < end; t++) {
-    auto& transition = transitions[t];
-    auto& precalulated = precalculations[t];
-    if (precalulated & PrecalculatedTransition::Satisfied) {
-      sum += transition.probability;
-    } else if (precalulated & PrecalculatedTransition::Excluded) {
-    } else {
-      sum += transition.probability * x[transition.state];
-    }
-  }
-  return sum;
-}
-
 void precalculateDirectSatisfactionAndExclusion(
-    Lmc& lmc,
+    LmcColumns& columns,
     gsl::span<PrecalculatedTransition> precalculatedTransitions,
     Formula* phi,
     Formula* psi,
@@ -102,12 +52,14 @@ void precalculateDirectSatisfactionAndExclusion(
        << std::endl;
   cpu_timer timer;
 
-  auto psiEvaluator = lmc.createLabelBasedFormulaEvaluator(psi);
-  std::function<bool(TransitionIndex)> returnFalse = [](TransitionIndex t) {
-    return false;
+  auto psiEvaluator = columns.createLabelBasedFormulaEvaluator(psi);
+  // Without phi (finally psi), no transition is excluded.
+  std::function<bool(TransitionIndex)> returnTrue = [](TransitionIndex t) {
+    return true;
   };
   auto phiEvaluator =
-      phi != nullptr ? lmc.createLabelBasedFormulaEvaluator(psi) : returnFalse;
+      phi != nullptr ? columns.createLabelBasedFormulaEvaluator(phi)
+                     : returnTrue;
 
   // bitwise or casts uint8_t implicitly to int
   auto satisfied =
@@ -120,7 +72,7 @@ void precalculateDirectSatisfactionAndExclusion(
   for (TransitionIndex t = 0; t < precalculatedTransitions.size(); t++) {
     if (psiEvaluator(t)) {
       precalculatedTransitions[t] = satisfied;
-    } else if (phiEvaluator(t)) {
+    } else if (!phiEvaluator(t)) {
       precalculatedTransitions[t] = excluded;
     } else {
       precalculatedTransitions[t] = PrecalculatedTransition::Nothing;
@@ -133,39 +85,327 @@ void precalculateDirectSatisfactionAndExclusion(
   cout << "\t\tFinished in " << elapsedTimeStr << "." << std::endl;
 }
 
-Probability calculateBoundedUntil(Lmc& lmc,
-                                  Formula* phi,
-                                  Formula* psi,
-                                  int bound,
-                                  std::ostream& cout) {
+// Returns the states from which a seed state can be reached via undecided
+// transitions.
+std::vector<bool> findStatesReachingSeeds(
+    gsl::span<const TransitionIndex> predecessorOffsets,
+    gsl::span<const StateIndex> predecessors,
+    std::vector<bool> seeds) {
+  std::vector<StateIndex> statesToVisit;
+  for (StateIndex s = 0; s < static_cast<StateIndex>(seeds.size()); ++s) {
+    if (seeds[s])
+      statesToVisit.push_back(s);
+  }
+  while (!statesToVisit.empty()) {
+    auto state = statesToVisit.back();
+    statesToVisit.pop_back();
+    for (auto i = predecessorOffsets[state]; i < predecessorOffsets[state + 1];
+         i++) {
+      auto predecessor = predecessors[i];
+      if (!seeds[predecessor]) {
+        seeds[predecessor] = true;
+        statesToVisit.push_back(predecessor);
+      }
+    }
+  }
+  return seeds;
+}
+
+// Decides the transitions into states whose probability to satisfy phi U psi
+// is 0 or 1 by a graph analysis. Only valid for unbounded formulas. A state
+// has probability 0 if it cannot reach a satisfied transition via undecided
+// transitions. It has probability 1 if it cannot reach such a state or an
+// excluded transition. Then, the iterations only need to calculate the
+// remaining states and converge faster, because the probability mass does
+// not creep towards 1 over many iterations.
+void precalculateProbability0And1(
+    const LmcColumns& columns,
+    gsl::span<PrecalculatedTransition> precalculations,
+    std::ostream& cout) {
+  cout << "Precalculate states with probability 0 and 1." << std::endl;
   cpu_timer timer;
 
-  auto transitions = lmc.getTransitions();
-  std::vector<PrecalculatedTransition> precalculations(transitions.size());
-  precalculateDirectSatisfactionAndExclusion(lmc, precalculations, phi, psi,
-                                             cout);
+  auto stateCount = columns.getStateCount();
+  auto targets = columns.getTargets();
+  auto isSatisfied = [&](TransitionIndex t) {
+    return (precalculations[t] & PrecalculatedTransition::Satisfied) != 0;
+  };
+  auto isExcluded = [&](TransitionIndex t) {
+    return (precalculations[t] & PrecalculatedTransition::Excluded) != 0;
+  };
+
+  // Predecessors via undecided transitions in CSR layout.
+  std::vector<TransitionIndex> predecessorOffsets(stateCount + 1, 0);
+  TransitionIndex begin, end = 0;
+  for (StateIndex s = 0; s < stateCount; ++s) {
+    std::tie(begin, end) = columns.getTransitionIndexesOfState(s);
+    for (auto t = begin; t < end; t++) {
+      if (!isSatisfied(t) && !isExcluded(t))
+        predecessorOffsets[targets[t] + 1]++;
+    }
+  }
+  for (StateIndex s = 0; s < stateCount; ++s)
+    predecessorOffsets[s + 1] += predecessorOffsets[s];
+  std::vector<StateIndex> predecessors(predecessorOffsets[stateCount]);
+  std::vector<TransitionIndex> nextPredecessor(predecessorOffsets.begin(),
+                                               predecessorOffsets.end() - 1);
+  for (StateIndex s = 0; s < stateCount; ++s) {
+    std::tie(begin, end) = columns.getTransitionIndexesOfState(s);
+    for (auto t = begin; t < end; t++) {
+      if (!isSatisfied(t) && !isExcluded(t))
+        predecessors[nextPredecessor[targets[t]]++] = s;
+    }
+  }
+
+  std::vector<bool> hasSatisfied(stateCount, false);
+  std::vector<bool> hasExcluded(stateCount, false);
+  for (StateIndex s = 0; s < stateCount; ++s) {
+    std::tie(begin, end) = columns.getTransitionIndexesOfState(s);
+    for (auto t = begin; t < end; t++) {
+      hasSatisfied[s] = hasSatisfied[s] || isSatisfied(t);
+      hasExcluded[s] = hasExcluded[s] || isExcluded(t);
+    }
+  }
 
-  auto stateCount = lmc.getStates().size();
-  auto probablityVector1 = std::vector<Probability>(stateCount);
-  auto probablityVector2 = std::vector<Probability>(stateCount);
-  auto xold = gsl::span<Probability>(probablityVector1);
-  auto xnew = gsl::span<Probability>(probablityVector2);
+  auto reachesPsi =
+      findStatesReachingSeeds(predecessorOffsets, predecessors, hasSatisfied);
+  auto failures = hasExcluded;
+  for (StateIndex s = 0; s < stateCount; ++s)
+    failures[s] = failures[s] || !reachesPsi[s];
+  auto reachesFailure =
+      findStatesReachingSeeds(predecessorOffsets, predecessors, failures);
 
-  for (auto i = 0; i < bound; i++) {
-    calculateIteration(lmc, precalculations, xold, xnew);
-    std::swap(xold, xnew);
+  StateIndex probability0 = 0;
+  StateIndex probability1 = 0;
+  for (StateIndex s = 0; s < stateCount; ++s) {
+    probability0 += reachesPsi[s] ? 0 : 1;
+    probability1 += reachesFailure[s] ? 0 : 1;
+  }
 
+  for (TransitionIndex t = 0; t < columns.getTransitionCount(); t++) {
+    if (isSatisfied(t) || isExcluded(t))
+      continue;
+    if (!reachesPsi[targets[t]])
+      precalculations[t] = PrecalculatedTransition::Excluded;
+    else if (!reachesFailure[targets[t]])
+      precalculations[t] = PrecalculatedTransition::Satisfied;
+  }
+
+  timer.stop();
+  cout << "\t\t" << probability0 << " states with probability 0 and "
+       << probability1 << " states with probability 1. Finished in "
+       << format(timer.elapsed()) << "." << std::endl;
+}
+
+LmcReducedMatrix compileIterationMatrix(Lmc& lmc,
+                                        Formula* phi,
+                                        Formula* psi,
+                                        bool isUnbounded,
+                                        const Configuration& conf) {
+  auto& cout = *conf.cout;
+
+  // Copied into the column layout by the first query only.
+  auto& columns = lmc.getColumns();
+
+  std::vector<PrecalculatedTransition> precalculations(
+      columns.getTransitionCount());
+  precalculateDirectSatisfactionAndExclusion(columns, precalculations, phi,
+                                             psi, cout);
+  if (isUnbounded)
+    precalculateProbability0And1(columns, precalculations, cout);
+
+  cout << "Compile the iteration matrix of the query." << std::endl;
+  // Only the Gauss-Seidel sweeps of unbounded queries read the CSR arrays.
+  auto keepCsr = isUnbounded &&
+                 conf.lmcIterativeSolver == LmcIterativeSolver::GaussSeidel;
+  LmcReducedMatrix matrix(columns, precalculations, conf.lmcMatrixFormat,
+                          conf.sellSortingScope, keepCsr);
+  cout << "\t\t" << matrix.getRowCount() << " of " << columns.getStateCount()
+       << " states and " << matrix.getNonZeroCount() << " of "
+       << columns.getTransitionCount() << " transitions are undecided."
+       << std::endl;
+  return matrix;
+}
+
+// Largest change between xold and xnew in [rowBegin, rowEnd), absolute and
+// relative to the new value.
+std::tuple<double, double> calculateChange(gsl::span<const Probability> xold,
+                                           gsl::span<const Probability> xnew,
+                                           StateIndex rowBegin,
+                                           StateIndex rowEnd) {
+  auto absoluteChange = 0.0;
+  auto relativeChange = 0.0;
+  for (auto r = rowBegin; r < rowEnd; ++r) {
+    auto change = std::abs(xnew[r].value - xold[r].value);
+    absoluteChange = std::max(absoluteChange, change);
+    if (xnew[r].value != 0.0)
+      relativeChange = std::max(relativeChange, change / xnew[r].value);
+  }
+  return std::make_tuple(absoluteChange, relativeChange);
+}
+
+bool hasConverged(const Configuration& conf,
+                  double absoluteChange,
+                  double relativeChange) {
+  return (conf.lmcAbsoluteTolerance > 0.0 &&
+          absoluteChange <= conf.lmcAbsoluteTolerance) ||
+         (conf.lmcRelativeTolerance > 0.0 &&
+          relativeChange <= conf.lmcRelativeTolerance);
+}
+
+// Iterates x' = A x + b, starting with x = 0, for at most maximalIterations
+// iterations. If checkConvergence is set, stops as soon as the change of an
+// iteration satisfies the tolerances of conf. Returns the probability of the
+// initial row.
+Probability iterateJacobi(LmcReducedMatrix& matrix,
+                          const Configuration& conf,
+                          int64_t maximalIterations,
+                          bool checkConvergence,
+                          LmcIterationStatistics& statistics) {
+  auto& cout = *conf.cout;
+  cout << "\t\tUsing the " << simdInstructionSetToString(
+                                     matrix.getSimdInstructionSet())
+       << " kernel." << std::endl;
+
+  ThreadPool threadPool(conf.lmcModelCheckingThreads);
+  auto numberOfThreads = threadPool.getNumberOfThreads();
+  auto partitions = matrix.partitionRows(numberOfThreads);
+  if (numberOfThreads > 1) {
+    cout << "Place the partitions of " << numberOfThreads << " threads."
+         << std::endl;
+    matrix.placeInMemory(threadPool, partitions);
+  }
+
+  // The vectors stay uninitialized until each thread initializes its rows.
+  auto vectorSize = matrix.getVectorSize();
+  UninitializedVector<Probability> probablityVector1;
+  UninitializedVector<Probability> probablityVector2;
+  probablityVector1.resize(vectorSize);
+  probablityVector2.resize(vectorSize);
+
+  // The changes of the threads. An iteration writes to the half of its
+  // parity, because a thread may already write the changes of the next
+  // iteration while the others still read the changes of this one.
+  std::vector<std::tuple<double, double>> changes(2 * numberOfThreads);
+  int64_t iterations = 0;
+
+  // Each thread calculates the rows of its partition. The threads meet once
+  // per iteration, because the next iteration reads the rows of the others.
+  SpinningBarrier barrier(numberOfThreads);
+  threadPool.runOnEveryThread([&](int32_t threadIndex) {
+    auto rowBegin = partitions[threadIndex];
+    auto rowEnd = partitions[threadIndex + 1];
+    auto vectorEnd = threadIndex == numberOfThreads - 1 ? vectorSize : rowEnd;
+    std::fill(probablityVector1.begin() + rowBegin,
+              probablityVector1.begin() + vectorEnd, Probability::Zero());
+    std::fill(probablityVector2.begin() + rowBegin,
+              probablityVector2.begin() + vectorEnd, Probability::Zero());
+    barrier.arriveAndWait();
+
+    auto xold = gsl::span<Probability>(probablityVector1);
+    auto xnew = gsl::span<Probability>(probablityVector2);
+    for (int64_t i = 0; i < maximalIterations; i++) {
+      matrix.multiplyAndAdd(xold, xnew, rowBegin, rowEnd);
+      auto parity = (i % 2) * numberOfThreads;
+      if (checkConvergence)
+        changes[parity + threadIndex] =
+            calculateChange(xold, xnew, rowBegin, rowEnd);
+      std::swap(xold, xnew);
+      barrier.arriveAndWait();
+
+      // All threads come to the same decision.
+      auto absoluteChange = 0.0;
+      auto relativeChange = 0.0;
+      if (checkConvergence) {
+        for (auto thread = 0; thread < numberOfThreads; ++thread) {
+          absoluteChange = std::max(
+              absoluteChange, std::get<0>(changes[parity + thread]));
+          relativeChange = std::max(
+              relativeChange, std::get<1>(changes[parity + thread]));
+        }
+      }
+      if (threadIndex == 0) {
+        iterations = i + 1;
+        statistics.absoluteResidual = absoluteChange;
+        statistics.relativeResidual = relativeChange;
+        if (i % 10 == 0) {
+          cout << "Calculated " << i << " iterations" << std::endl;
+        }
+      }
+      if (checkConvergence &&
+          hasConverged(conf, absoluteChange, relativeChange))
+        break;
+    }
+  });
+  statistics.iterations = iterations;
+  statistics.converged =
+      !checkConvergence || hasConverged(conf, statistics.absoluteResidual,
+                                        statistics.relativeResidual);
+
+  auto xold = gsl::span<Probability>(iterations % 2 == 0 ? probablityVector1
+                                                         : probablityVector2);
+  return matrix.calculateInitialProbability(xold);
+}
+
+Probability iterateGaussSeidel(LmcReducedMatrix& matrix,
+                               const Configuration& conf,
+                               LmcIterationStatistics& statistics) {
+  auto& cout = *conf.cout;
+  auto x = std::vector<Probability>(matrix.getVectorSize(),
+                                    Probability::Zero());
+  statistics.converged = false;
+  for (int64_t i = 0; i < conf.lmcMaximalIterations; i++) {
+    std::tie(statistics.absoluteResidual, statistics.relativeResidual) =
+        matrix.gaussSeidelSweep(x);
+    statistics.iterations = i + 1;
     if (i % 10 == 0) {
       cout << "Calculated " << i << " iterations" << std::endl;
     }
+    if (hasConverged(conf, statistics.absoluteResidual,
+                     statistics.relativeResidual)) {
+      statistics.converged = true;
+      break;
+    }
   }
+  return matrix.calculateInitialProbability(x);
+}
 
-  auto result = calculateInitialProbability(lmc, precalculations, xold);
+Probability calculateBoundedUntil(Lmc& lmc,
+                                  Formula* phi,
+                                  Formula* psi,
+                                  int bound,
+                                  const Configuration& conf,
+                                  LmcIterationStatistics& statistics) {
+  auto matrix = compileIterationMatrix(lmc, phi, psi, false, conf);
+  return iterateJacobi(matrix, conf, bound, false, statistics);
+}
 
-  timer.stop();
-  auto elapsedTime = timer.elapsed();
-  auto elapsedTimeStr = format(elapsedTime);
+Probability calculateUnboundedUntil(Lmc& lmc,
+                                    Formula* phi,
+                                    Formula* psi,
+                                    const Configuration& conf,
+                                    LmcIterationStatistics& statistics) {
+  auto& cout = *conf.cout;
+  cpu_timer timer;
+
+  auto matrix = compileIterationMatrix(lmc, phi, psi, true, conf);
+  Probability result;
+  if (conf.lmcIterativeSolver == LmcIterativeSolver::GaussSeidel) {
+    cout << "Solve with Gauss-Seidel iterations." << std::endl;
+    result = iterateGaussSeidel(matrix, conf, statistics);
+  } else {
+    cout << "Solve with Jacobi iterations." << std::endl;
+    result =
+        iterateJacobi(matrix, conf, conf.lmcMaximalIterations, true, statistics);
+  }
 
+  timer.stop();
+  cout << (statistics.converged ? "Converged" : "Did not converge")
+       << " after " << statistics.iterations
+       << " iterations with an absolute residual of "
+       << statistics.absoluteResidual << " and a relative residual of "
+       << statistics.relativeResidual << " in " << format(timer.elapsed())
+       << "." << std::endl;
   return result;
 }
 }  // namespace
@@ -181,6 +421,7 @@ Probability LmcModelChecker::calculateProbability(Formula& formulaToCheck) {
   auto matchFormula = tryExtractPhiUntilPsiWithBound(formulaToCheck);
   if (matchFormula == std::nullopt)
     return Probability::Error();
+  lastIterationStatistics = LmcIterationStatistics();
   Formula* phi;
   Formula* psi;
   std::optional<int> bound;
@@ -189,14 +430,37 @@ Probability LmcModelChecker::calculateProbability(Formula& formulaToCheck) {
   *conf.cout << "Checking formula: " << formulaToString(formulaToCheck)
              << std::endl;
 
+  // A truncated Lmc lacks the successors that only matter for other formulas.
+  auto truncation = lmc.getTruncatedForPhiUntilPsi();
+  throw_assert(truncation == std::nullopt ||
+                   *truncation == phiUntilPsiToStrings(phi, psi),
+               "The Lmc has been truncated for the formula "
+                   << std::get<0>(*truncation) << " U "
+                   << std::get<1>(*truncation)
+                   << " and cannot be used for other formulas.");
+
   if (bound != std::nullopt) {
-    return calculateBoundedUntil(lmc, phi, psi, *bound, *conf.cout);
+    auto horizon = lmc.getHorizon();
+    throw_assert(horizon == std::nullopt || *bound <= *horizon,
+                 "The Lmc has been built with horizon "
+                     << horizon.value_or(0) << ", which is smaller than the bound "
+                     << *bound << ".");
+    return calculateBoundedUntil(lmc, phi, psi, *bound, conf,
+                                 lastIterationStatistics);
   } else {
-    // CalculateUnboundUntil
-    throw NotImplementedYetException();
+    // Beyond the horizon, the Lmc only knows the stuttering state.
+    throw_assert(lmc.getHorizon() == std::nullopt,
+                 "The Lmc has been built with horizon "
+                     << *lmc.getHorizon()
+                     << ", which does not suffice for unbounded formulas.");
+    return calculateUnboundedUntil(lmc, phi, psi, conf,
+                                   lastIterationStatistics);
   }
+}
 
-  return Probability::Error();
+const LmcIterationStatistics& LmcModelChecker::getLastIterationStatistics()
+    const {
+  return lastIterationStatistics;
 }
 
 }  // namespace pemc
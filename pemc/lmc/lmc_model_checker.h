@@ -25,20 +25,36 @@
 #ifndef PEMC_LMC_LMC_MODEL_CHECKER_H_
 #define PEMC_LMC_LMC_MODEL_CHECKER_H_
 
+#include <cstdint>
+
 #include "pemc/basic/configuration.h"
 #include "pemc/lmc/lmc.h"
 #include "pemc/formula/formula.h"
 
 namespace pemc {
 
+  // Describes the iterations of the last query.
+  struct LmcIterationStatistics {
+      int64_t iterations = 0;
+      // Largest change of a state in the last iteration, absolute and
+      // relative to the new value. Only calculated for unbounded formulas.
+      double absoluteResidual = 0.0;
+      double relativeResidual = 0.0;
+      // False if an unbounded formula hit Configuration::lmcMaximalIterations.
+      bool converged = true;
+  };
+
   class LmcModelChecker {
   private:
       Lmc& lmc;
       const Configuration& conf;
+      LmcIterationStatistics lastIterationStatistics;
   public:
       LmcModelChecker(Lmc& _lmc, const Configuration& _conf);
 
       Probability calculateProbability(Formula& formulaToCheck);
+
+      const LmcIterationStatistics& getLastIterationStatistics() const;
   };
 
 }
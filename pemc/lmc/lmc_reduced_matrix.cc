@@ -0,0 +1,390 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "pemc/lmc/lmc_reduced_matrix.h"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+#include "pemc/basic/ThrowAssert.hpp"
+
+namespace pemc {
+
+namespace {
+static_assert(sizeof(Probability) == sizeof(double),
+              "The kernels read Probability as double");
+
+bool isUndecided(PrecalculatedTransition precalculated) {
+  return !(precalculated & PrecalculatedTransition::Satisfied) &&
+         !(precalculated & PrecalculatedTransition::Excluded);
+}
+
+const double* asDoubles(
+    const UninitializedVector<Probability>& probabilities) {
+  return reinterpret_cast<const double*>(probabilities.data());
+}
+
+// Copies the range of values of each thread on this thread.
+template <typename T, typename TRangeOfThread>
+void placeRanges(ThreadPool& threadPool,
+                 UninitializedVector<T>& values,
+                 TRangeOfThread rangeOfThread) {
+  UninitializedVector<T> placedValues;
+  placedValues.resize(values.size());
+  threadPool.runOnEveryThread([&](int32_t threadIndex) {
+    size_t begin, end = 0;
+    std::tie(begin, end) = rangeOfThread(threadIndex);
+    std::copy(values.begin() + begin, values.begin() + end,
+              placedValues.begin() + begin);
+  });
+  values.swap(placedValues);
+}
+}  // namespace
+
+LmcReducedMatrix::LmcReducedMatrix(
+    const LmcColumns& lmcColumns,
+    gsl::span<const PrecalculatedTransition> precalculations,
+    LmcMatrixFormat _format,
+    int32_t sellSortingScope,
+    bool keepCsr)
+    : format(_format), instructionSet(getBestSimdInstructionSet()) {
+  auto stateCount = lmcColumns.getStateCount();
+  auto lmcProbabilities = lmcColumns.getProbabilities();
+  auto lmcTargets = lmcColumns.getTargets();
+  TransitionIndex begin, end = 0;
+
+  // Find the states whose value is read by an undecided transition that is
+  // reachable from the initial transitions. Mark them with 0 first.
+  rowOfState.assign(stateCount, -1);
+  std::vector<StateIndex> statesToVisit;
+  auto markTargetsOfRow = [&](TransitionIndex from, TransitionIndex to) {
+    for (auto t = from; t < to; t++) {
+      auto target = lmcTargets[t];
+      if (isUndecided(precalculations[t]) && rowOfState[target] == -1) {
+        rowOfState[target] = 0;
+        statesToVisit.push_back(target);
+      }
+    }
+  };
+  std::tie(begin, end) = lmcColumns.getInitialTransitionIndexes();
+  markTargetsOfRow(begin, end);
+  while (!statesToVisit.empty()) {
+    auto state = statesToVisit.back();
+    statesToVisit.pop_back();
+    std::tie(begin, end) = lmcColumns.getTransitionIndexesOfState(state);
+    markTargetsOfRow(begin, end);
+  }
+
+  // Renumber densely, keeping the original order for locality.
+  std::vector<StateIndex> stateOfRow;
+  std::vector<TransitionIndex> rowLengths;
+  for (StateIndex s = 0; s < stateCount; ++s) {
+    if (rowOfState[s] == -1)
+      continue;
+    TransitionIndex length = 0;
+    std::tie(begin, end) = lmcColumns.getTransitionIndexesOfState(s);
+    for (auto t = begin; t < end; t++) {
+      if (isUndecided(precalculations[t]))
+        length++;
+    }
+    stateOfRow.push_back(s);
+    rowLengths.push_back(length);
+  }
+  rowCount = static_cast<StateIndex>(stateOfRow.size());
+
+  if (format == LmcMatrixFormat::SellCSigma) {
+    // Sort the rows of each window by descending length. The sort is stable
+    // to keep rows of equal length in their original order.
+    throw_assert(sellSortingScope > 0,
+                 "Invalid sellSortingScope " << sellSortingScope);
+    std::vector<StateIndex> order(rowCount);
+    for (StateIndex r = 0; r < rowCount; ++r)
+      order[r] = r;
+    for (StateIndex window = 0; window < rowCount; window += sellSortingScope) {
+      auto windowEnd = std::min<StateIndex>(rowCount, window + sellSortingScope);
+      std::stable_sort(order.begin() + window, order.begin() + windowEnd,
+                       [&](StateIndex a, StateIndex b) {
+                         return rowLengths[a] > rowLengths[b];
+                       });
+    }
+    std::vector<StateIndex> sortedStates(rowCount);
+    std::vector<TransitionIndex> sortedLengths(rowCount);
+    for (StateIndex r = 0; r < rowCount; ++r) {
+      sortedStates[r] = stateOfRow[order[r]];
+      sortedLengths[r] = rowLengths[order[r]];
+    }
+    stateOfRow.swap(sortedStates);
+    rowLengths.swap(sortedLengths);
+  }
+
+  for (StateIndex r = 0; r < rowCount; ++r) {
+    rowOfState[stateOfRow[r]] = r;
+    nonZeroCount += rowLengths[r];
+  }
+
+  rowOffsets.resize(rowCount + 1);
+  probabilities.resize(nonZeroCount);
+  columns.resize(nonZeroCount);
+  constants.resize(rowCount);
+
+  TransitionIndex next = 0;
+  for (StateIndex row = 0; row < rowCount; ++row) {
+    rowOffsets[row] = next;
+    auto constant = Probability::Zero();
+    std::tie(begin, end) =
+        lmcColumns.getTransitionIndexesOfState(stateOfRow[row]);
+    for (auto t = begin; t < end; t++) {
+      if (precalculations[t] & PrecalculatedTransition::Satisfied) {
+        constant += lmcProbabilities[t];
+      } else if (precalculations[t] & PrecalculatedTransition::Excluded) {
+      } else {
+        probabilities[next] = lmcProbabilities[t];
+        columns[next] = rowOfState[lmcTargets[t]];
+        next++;
+      }
+    }
+    constants[row] = constant;
+  }
+  rowOffsets[rowCount] = next;
+
+  std::tie(begin, end) = lmcColumns.getInitialTransitionIndexes();
+  for (auto t = begin; t < end; t++) {
+    if (precalculations[t] & PrecalculatedTransition::Satisfied) {
+      initialConstant += lmcProbabilities[t];
+    } else if (precalculations[t] & PrecalculatedTransition::Excluded) {
+    } else {
+      initialProbabilities.push_back(lmcProbabilities[t]);
+      initialColumns.push_back(rowOfState[lmcTargets[t]]);
+    }
+  }
+
+  if (format == LmcMatrixFormat::SellCSigma) {
+    createSellCSigma();
+    if (!keepCsr) {
+      hasCsr = false;
+      UninitializedVector<TransitionIndex>().swap(rowOffsets);
+      UninitializedVector<Probability>().swap(probabilities);
+      UninitializedVector<StateIndex>().swap(columns);
+      UninitializedVector<Probability>().swap(constants);
+    }
+  }
+}
+
+void LmcReducedMatrix::createSellCSigma() {
+  auto chunkCount = (rowCount + SellChunkHeight - 1) / SellChunkHeight;
+  sellChunkOffsets.resize(chunkCount + 1);
+  TransitionIndex next = 0;
+  for (StateIndex c = 0; c < chunkCount; ++c) {
+    sellChunkOffsets[c] = next;
+    TransitionIndex width = 0;
+    for (auto r = c * SellChunkHeight;
+         r < std::min(rowCount, (c + 1) * SellChunkHeight); ++r)
+      width = std::max(width, rowOffsets[r + 1] - rowOffsets[r]);
+    next += width * SellChunkHeight;
+  }
+  sellChunkOffsets[chunkCount] = next;
+
+  // Padding entries have a zero probability and read row 0.
+  sellProbabilities.assign(next, Probability::Zero());
+  sellColumns.assign(next, 0);
+  sellConstants.assign(chunkCount * SellChunkHeight, Probability::Zero());
+  for (StateIndex r = 0; r < rowCount; ++r) {
+    auto chunk = r / SellChunkHeight;
+    auto lane = r % SellChunkHeight;
+    auto t = sellChunkOffsets[chunk] + lane;
+    for (auto i = rowOffsets[r]; i < rowOffsets[r + 1]; i++) {
+      sellProbabilities[t] = probabilities[i];
+      sellColumns[t] = columns[i];
+      t += SellChunkHeight;
+    }
+    sellConstants[r] = constants[r];
+  }
+}
+
+std::vector<StateIndex> LmcReducedMatrix::partitionRows(
+    int32_t numberOfPartitions) const {
+  throw_assert(numberOfPartitions >= 1,
+               "Invalid number of partitions " << numberOfPartitions);
+  // Boundaries are searched in the offsets of the units of work: rows for
+  // CSR and chunks for SELL-C-sigma.
+  auto isSell = format == LmcMatrixFormat::SellCSigma;
+  auto& offsets = isSell ? sellChunkOffsets : rowOffsets;
+  auto unitCount = static_cast<StateIndex>(offsets.size() - 1);
+  auto rowsPerUnit = isSell ? SellChunkHeight : 1;
+  auto entryCount = offsets[unitCount];
+
+  std::vector<StateIndex> boundaries(numberOfPartitions + 1);
+  boundaries[0] = 0;
+  for (auto i = 1; i < numberOfPartitions; ++i) {
+    auto entries = static_cast<TransitionIndex>(
+        static_cast<double>(entryCount) * i / numberOfPartitions);
+    auto unit = static_cast<StateIndex>(
+        std::lower_bound(offsets.begin(), offsets.end() - 1, entries) -
+        offsets.begin());
+    boundaries[i] =
+        std::max(boundaries[i - 1], std::min(rowCount, unit * rowsPerUnit));
+  }
+  boundaries[numberOfPartitions] = rowCount;
+  return boundaries;
+}
+
+void LmcReducedMatrix::placeInMemory(
+    ThreadPool& threadPool,
+    gsl::span<const StateIndex> partitionBoundaries) {
+  auto numberOfPartitions = threadPool.getNumberOfThreads();
+  throw_assert(partitionBoundaries.size() == numberOfPartitions + 1,
+               "Expected one partition per thread");
+  auto rowsOfThread = [&](int32_t threadIndex) {
+    return std::make_tuple(static_cast<size_t>(partitionBoundaries[threadIndex]),
+                           static_cast<size_t>(partitionBoundaries[threadIndex + 1]));
+  };
+  // The last thread also takes the elements behind the last row.
+  auto withTail = [numberOfPartitions](auto rangeOfThread, size_t size) {
+    return [=](int32_t threadIndex) {
+      size_t begin, end = 0;
+      std::tie(begin, end) = rangeOfThread(threadIndex);
+      if (threadIndex == numberOfPartitions - 1)
+        end = size;
+      return std::make_tuple(begin, end);
+    };
+  };
+  auto entriesOf = [](const UninitializedVector<TransitionIndex>& offsets,
+                      auto unitsOfThread) {
+    return [&offsets, unitsOfThread](int32_t threadIndex) {
+      size_t begin, end = 0;
+      std::tie(begin, end) = unitsOfThread(threadIndex);
+      return std::make_tuple(static_cast<size_t>(offsets[begin]),
+                             static_cast<size_t>(offsets[end]));
+    };
+  };
+
+  if (hasCsr) {
+    placeRanges(threadPool, rowOffsets,
+                withTail(rowsOfThread, rowOffsets.size()));
+    placeRanges(threadPool, constants, rowsOfThread);
+    placeRanges(threadPool, probabilities, entriesOf(rowOffsets, rowsOfThread));
+    placeRanges(threadPool, columns, entriesOf(rowOffsets, rowsOfThread));
+  }
+
+  if (format == LmcMatrixFormat::SellCSigma) {
+    auto chunksOfThread = [&](int32_t threadIndex) {
+      size_t begin, end = 0;
+      std::tie(begin, end) = rowsOfThread(threadIndex);
+      return std::make_tuple(begin / SellChunkHeight,
+                             (end + SellChunkHeight - 1) / SellChunkHeight);
+    };
+    auto chunkRowsOfThread = [&](int32_t threadIndex) {
+      size_t begin, end = 0;
+      std::tie(begin, end) = chunksOfThread(threadIndex);
+      return std::make_tuple(begin * SellChunkHeight, end * SellChunkHeight);
+    };
+    placeRanges(threadPool, sellChunkOffsets,
+                withTail(chunksOfThread, sellChunkOffsets.size()));
+    placeRanges(threadPool, sellConstants, chunkRowsOfThread);
+    placeRanges(threadPool, sellProbabilities,
+                entriesOf(sellChunkOffsets, chunksOfThread));
+    placeRanges(threadPool, sellColumns,
+                entriesOf(sellChunkOffsets, chunksOfThread));
+  }
+}
+
+void LmcReducedMatrix::setSimdInstructionSet(
+    SimdInstructionSet _instructionSet) {
+  throw_assert(isSimdInstructionSetSupported(_instructionSet),
+               "The processor does not support "
+                   << simdInstructionSetToString(_instructionSet) << ".");
+  instructionSet = _instructionSet;
+}
+
+CsrMatrixView LmcReducedMatrix::getCsrView() const {
+  return CsrMatrixView{rowOffsets.data(), columns.data(),
+                       asDoubles(probabilities), asDoubles(constants)};
+}
+
+SellMatrixView LmcReducedMatrix::getSellView() const {
+  return SellMatrixView{sellChunkOffsets.data(), sellColumns.data(),
+                        asDoubles(sellProbabilities), asDoubles(sellConstants)};
+}
+
+StateIndex LmcReducedMatrix::getVectorSize() const {
+  if (format == LmcMatrixFormat::SellCSigma)
+    return static_cast<StateIndex>(sellConstants.size());
+  return rowCount;
+}
+
+StateIndex LmcReducedMatrix::getRowAlignment() const {
+  return format == LmcMatrixFormat::SellCSigma ? SellChunkHeight : 1;
+}
+
+void LmcReducedMatrix::multiplyAndAdd(gsl::span<const Probability> xold,
+                                      gsl::span<Probability> xnew,
+                                      StateIndex rowBegin,
+                                      StateIndex rowEnd) const {
+  if (rowBegin >= rowEnd)
+    return;
+  auto xoldData = reinterpret_cast<const double*>(xold.data());
+  auto xnewData = reinterpret_cast<double*>(xnew.data());
+  if (format == LmcMatrixFormat::SellCSigma) {
+    throw_assert(rowBegin % SellChunkHeight == 0,
+                 "Row " << rowBegin << " is not the first row of a chunk");
+    multiplyAndAddSell(instructionSet, getSellView(), xoldData, xnewData,
+                       rowBegin / SellChunkHeight,
+                       (rowEnd + SellChunkHeight - 1) / SellChunkHeight);
+  } else {
+    multiplyAndAddCsr(instructionSet, getCsrView(), xoldData, xnewData,
+                      rowBegin, rowEnd);
+  }
+}
+
+std::tuple<double, double> LmcReducedMatrix::gaussSeidelSweep(
+    gsl::span<Probability> x) const {
+  throw_assert(hasCsr, "Gauss-Seidel sweeps require the CSR arrays");
+  auto absoluteChange = 0.0;
+  auto relativeChange = 0.0;
+  for (StateIndex r = 0; r < rowCount; ++r) {
+    auto sum = constants[r].value;
+    auto end = rowOffsets[r + 1];
+    for (auto t = rowOffsets[r]; t < end; t++) {
+      sum += probabilities[t].value * x[columns[t]].value;
+    }
+    auto change = std::abs(sum - x[r].value);
+    absoluteChange = std::max(absoluteChange, change);
+    if (sum != 0.0)
+      relativeChange = std::max(relativeChange, change / sum);
+    x[r] = Probability(sum);
+  }
+  return std::make_tuple(absoluteChange, relativeChange);
+}
+
+Probability LmcReducedMatrix::calculateInitialProbability(
+    gsl::span<const Probability> x) const {
+  auto sum = initialConstant;
+  for (size_t i = 0; i < initialProbabilities.size(); i++) {
+    sum += initialProbabilities[i] * x[initialColumns[i]];
+  }
+  return sum;
+}
+
+}  // namespace pemc
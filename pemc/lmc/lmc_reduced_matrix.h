@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef PEMC_LMC_LMC_REDUCED_MATRIX_H_
+#define PEMC_LMC_LMC_REDUCED_MATRIX_H_
+
+#include <cstdint>
+#include <gsl/span>
+#include <tuple>
+#include <vector>
+
+#include "pemc/basic/configuration.h"
+#include "pemc/basic/probability.h"
+#include "pemc/basic/raw_memory.h"
+#include "pemc/basic/thread_pool.h"
+#include "pemc/basic/tsc_index.h"
+#include "pemc/lmc/lmc_columns.h"
+#include "pemc/lmc/sparse_matrix_kernels.h"
+
+namespace pemc {
+
+enum PrecalculatedTransition : uint8_t {
+  Nothing = 0,
+  SatisfiedDirect = 1,
+  ExcludedDirect = 2,
+  Satisfied = 4,  // Satisfied for the current run
+  Excluded = 8,   // Excluded for the current run
+  Mark = 16,
+};
+
+// The iteration matrix of a query, compiled once from the LmcColumns and the
+// precalculated transitions. Satisfied transitions are summed up into the
+// constant vector b, excluded transitions are dropped and the remaining
+// transitions form the matrix A. Only the states that are reachable from the
+// initial transitions via remaining transitions get a row. These undecided
+// states are renumbered densely in their original order. An iteration is then
+// the branch-free x' = A x + b. The initial transitions form the additional
+// row initialProbabilities/initialColumns/initialConstant, which is not part
+// of A.
+// A is stored as CSR. With LmcMatrixFormat::SellCSigma, the rows are
+// converted to SELL-C-sigma, which the iterations use then. To reduce the
+// padding, the rows are sorted by their length within windows of
+// sellSortingScope rows before they are numbered. The CSR arrays are released
+// after the conversion unless keepCsr is set (Gauss-Seidel sweeps use them).
+class LmcReducedMatrix {
+ private:
+  LmcMatrixFormat format;
+  SimdInstructionSet instructionSet;
+
+  StateIndex rowCount = 0;
+  TransitionIndex nonZeroCount = 0;
+  bool hasCsr = true;
+  UninitializedVector<TransitionIndex> rowOffsets;
+  UninitializedVector<Probability> probabilities;
+  UninitializedVector<StateIndex> columns;
+  UninitializedVector<Probability> constants;
+
+  UninitializedVector<TransitionIndex> sellChunkOffsets;
+  UninitializedVector<Probability> sellProbabilities;
+  UninitializedVector<StateIndex> sellColumns;
+  UninitializedVector<Probability> sellConstants;
+
+  std::vector<Probability> initialProbabilities;
+  std::vector<StateIndex> initialColumns;
+  Probability initialConstant = Probability::Zero();
+
+  // Maps the index of a state of the Lmc to its row, or -1 if it has no row.
+  std::vector<StateIndex> rowOfState;
+
+  void createSellCSigma();
+
+  CsrMatrixView getCsrView() const;
+  SellMatrixView getSellView() const;
+
+ public:
+  LmcReducedMatrix(const LmcColumns& lmcColumns,
+                   gsl::span<const PrecalculatedTransition> precalculations,
+                   LmcMatrixFormat _format = LmcMatrixFormat::Csr,
+                   int32_t sellSortingScope = 256,
+                   bool keepCsr = false);
+
+  LmcMatrixFormat getFormat() const { return format; }
+  SimdInstructionSet getSimdInstructionSet() const { return instructionSet; }
+  // Defaults to the widest instruction set the processor supports.
+  void setSimdInstructionSet(SimdInstructionSet _instructionSet);
+
+  StateIndex getRowCount() const { return rowCount; }
+  TransitionIndex getNonZeroCount() const { return nonZeroCount; }
+  // The CSR arrays; empty if they have been released (see above).
+  bool hasCsrArrays() const { return hasCsr; }
+  gsl::span<const TransitionIndex> getRowOffsets() const { return rowOffsets; }
+  gsl::span<const Probability> getProbabilities() const {
+    return probabilities;
+  }
+  gsl::span<const StateIndex> getColumns() const { return columns; }
+  gsl::span<const Probability> getConstants() const { return constants; }
+  gsl::span<const StateIndex> getRowOfState() const { return rowOfState; }
+
+  // Number of elements of the vectors x. Exceeds the number of rows by the
+  // padding rows of the last SELL chunk.
+  StateIndex getVectorSize() const;
+  // Row ranges passed to multiplyAndAdd must begin at a multiple of this.
+  StateIndex getRowAlignment() const;
+
+  // Splits the rows into numberOfPartitions ranges with about the same number
+  // of entries (including the padding of SELL-C-sigma), because the entries
+  // and not the rows determine the work of an iteration. Returns the
+  // numberOfPartitions + 1 boundaries, aligned to getRowAlignment() except
+  // for the number of rows. Partitions may be empty.
+  std::vector<StateIndex> partitionRows(int32_t numberOfPartitions) const;
+
+  // Copies the arrays such that the entries of the rows of partition i are
+  // written first by thread i of threadPool. Thus, on NUMA systems, thread i
+  // finds its partition in local memory.
+  void placeInMemory(ThreadPool& threadPool,
+                     gsl::span<const StateIndex> partitionBoundaries);
+
+  // xnew[r] = (A xold)[r] + b[r] for all rows r in [rowBegin, rowEnd).
+  // With SELL-C-sigma, rowEnd is rounded up to the end of its chunk. Empty
+  // ranges are ignored.
+  void multiplyAndAdd(gsl::span<const Probability> xold,
+                      gsl::span<Probability> xnew,
+                      StateIndex rowBegin,
+                      StateIndex rowEnd) const;
+  void multiplyAndAdd(gsl::span<const Probability> xold,
+                      gsl::span<Probability> xnew) const {
+    multiplyAndAdd(xold, xnew, 0, rowCount);
+  }
+
+  // One Gauss-Seidel sweep over all rows in their order: x[r] = (A x)[r] +
+  // b[r] in place, so each row reads the new values of the rows before it.
+  // Uses the CSR rows, so they must have been kept. Returns the largest change of a row, absolute and
+  // relative to its new value.
+  std::tuple<double, double> gaussSeidelSweep(gsl::span<Probability> x) const;
+
+  // Evaluates the initial row on x.
+  Probability calculateInitialProbability(gsl::span<const Probability> x) const;
+};
+
+}  // namespace pemc
+
+#endif  // PEMC_LMC_LMC_REDUCED_MATRIX_H_
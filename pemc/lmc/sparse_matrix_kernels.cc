@@ -0,0 +1,296 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "pemc/lmc/sparse_matrix_kernels.h"
+
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define PEMC_X86_64
+#include <immintrin.h>
+#endif
+
+// Wider kernels are compiled with target attributes and selected at runtime.
+#if defined(PEMC_X86_64) && (defined(__GNUC__) || defined(__clang__))
+#define PEMC_RUNTIME_AVX
+#endif
+
+namespace pemc {
+
+namespace {
+
+static_assert(std::is_same<StateIndex, int32_t>::value ||
+                  std::is_same<StateIndex, int64_t>::value,
+              "The gathers expect 32 or 64 bit state indexes");
+
+void multiplyAndAddCsrScalar(const CsrMatrixView& matrix,
+                             const double* xold,
+                             double* xnew,
+                             StateIndex rowBegin,
+                             StateIndex rowEnd) {
+  for (auto r = rowBegin; r < rowEnd; ++r) {
+    auto sum = matrix.constants[r];
+    auto end = matrix.rowOffsets[r + 1];
+    for (auto t = matrix.rowOffsets[r]; t < end; t++) {
+      sum += matrix.probabilities[t] * xold[matrix.columns[t]];
+    }
+    xnew[r] = sum;
+  }
+}
+
+void multiplyAndAddSellScalar(const SellMatrixView& matrix,
+                              const double* xold,
+                              double* xnew,
+                              StateIndex chunkBegin,
+                              StateIndex chunkEnd) {
+  for (auto c = chunkBegin; c < chunkEnd; ++c) {
+    double sums[SellChunkHeight];
+    for (StateIndex lane = 0; lane < SellChunkHeight; ++lane)
+      sums[lane] = matrix.constants[c * SellChunkHeight + lane];
+    auto end = matrix.chunkOffsets[c + 1];
+    for (auto t = matrix.chunkOffsets[c]; t < end; t += SellChunkHeight) {
+      for (StateIndex lane = 0; lane < SellChunkHeight; ++lane)
+        sums[lane] +=
+            matrix.probabilities[t + lane] * xold[matrix.columns[t + lane]];
+    }
+    for (StateIndex lane = 0; lane < SellChunkHeight; ++lane)
+      xnew[c * SellChunkHeight + lane] = sums[lane];
+  }
+}
+
+#if defined(PEMC_RUNTIME_AVX)
+// The masked gathers with a zero source avoid reading an uninitialized
+// source register.
+__attribute__((target("avx2,fma"))) inline __m256d gather4(
+    const double* x,
+    const StateIndex* columns) {
+  auto all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+  if constexpr (sizeof(StateIndex) == 4) {
+    auto indexes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(columns));
+    return _mm256_mask_i32gather_pd(_mm256_setzero_pd(), x, indexes, all, 8);
+  } else {
+    auto indexes =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(columns));
+    return _mm256_mask_i64gather_pd(_mm256_setzero_pd(), x, indexes, all, 8);
+  }
+}
+
+__attribute__((target("avx2,fma"))) inline double horizontalSum(__m256d sums) {
+  auto halves =
+      _mm_add_pd(_mm256_castpd256_pd128(sums), _mm256_extractf128_pd(sums, 1));
+  return _mm_cvtsd_f64(_mm_add_sd(halves, _mm_unpackhi_pd(halves, halves)));
+}
+
+__attribute__((target("avx2,fma"))) void multiplyAndAddCsrAvx2(
+    const CsrMatrixView& matrix,
+    const double* xold,
+    double* xnew,
+    StateIndex rowBegin,
+    StateIndex rowEnd) {
+  for (auto r = rowBegin; r < rowEnd; ++r) {
+    auto t = matrix.rowOffsets[r];
+    auto end = matrix.rowOffsets[r + 1];
+    auto sums = _mm256_setzero_pd();
+    for (; t + 4 <= end; t += 4) {
+      auto probabilities = _mm256_loadu_pd(matrix.probabilities + t);
+      auto values = gather4(xold, matrix.columns + t);
+      sums = _mm256_fmadd_pd(probabilities, values, sums);
+    }
+    auto sum = horizontalSum(sums) + matrix.constants[r];
+    for (; t < end; t++) {
+      sum += matrix.probabilities[t] * xold[matrix.columns[t]];
+    }
+    xnew[r] = sum;
+  }
+}
+
+__attribute__((target("avx2,fma"))) void multiplyAndAddSellAvx2(
+    const SellMatrixView& matrix,
+    const double* xold,
+    double* xnew,
+    StateIndex chunkBegin,
+    StateIndex chunkEnd) {
+  static_assert(SellChunkHeight == 8, "A chunk fills two AVX2 registers");
+  for (auto c = chunkBegin; c < chunkEnd; ++c) {
+    auto constants = matrix.constants + c * SellChunkHeight;
+    auto sums1 = _mm256_loadu_pd(constants);
+    auto sums2 = _mm256_loadu_pd(constants + 4);
+    auto end = matrix.chunkOffsets[c + 1];
+    for (auto t = matrix.chunkOffsets[c]; t < end; t += SellChunkHeight) {
+      auto probabilities1 = _mm256_loadu_pd(matrix.probabilities + t);
+      auto probabilities2 = _mm256_loadu_pd(matrix.probabilities + t + 4);
+      auto values1 = gather4(xold, matrix.columns + t);
+      auto values2 = gather4(xold, matrix.columns + t + 4);
+      sums1 = _mm256_fmadd_pd(probabilities1, values1, sums1);
+      sums2 = _mm256_fmadd_pd(probabilities2, values2, sums2);
+    }
+    _mm256_storeu_pd(xnew + c * SellChunkHeight, sums1);
+    _mm256_storeu_pd(xnew + c * SellChunkHeight + 4, sums2);
+  }
+}
+
+__attribute__((target("avx512f,avx2,fma"))) inline __m512d gather8(
+    const double* x,
+    const StateIndex* columns) {
+  if constexpr (sizeof(StateIndex) == 4) {
+    auto indexes =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(columns));
+    return _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xFF, indexes, x,
+                                    8);
+  } else {
+    auto indexes = _mm512_loadu_si512(columns);
+    return _mm512_mask_i64gather_pd(_mm512_setzero_pd(), 0xFF, indexes, x,
+                                    8);
+  }
+}
+
+__attribute__((target("avx512f,avx2,fma"))) void multiplyAndAddCsrAvx512(
+    const CsrMatrixView& matrix,
+    const double* xold,
+    double* xnew,
+    StateIndex rowBegin,
+    StateIndex rowEnd) {
+  for (auto r = rowBegin; r < rowEnd; ++r) {
+    auto t = matrix.rowOffsets[r];
+    auto end = matrix.rowOffsets[r + 1];
+    auto sums = _mm512_setzero_pd();
+    for (; t + 8 <= end; t += 8) {
+      auto probabilities = _mm512_loadu_pd(matrix.probabilities + t);
+      auto values = gather8(xold, matrix.columns + t);
+      sums = _mm512_fmadd_pd(probabilities, values, sums);
+    }
+    // The masked extractions avoid reading an uninitialized register, too.
+    auto lower =
+        _mm512_mask_extractf64x4_pd(_mm256_setzero_pd(), 0xF, sums, 0);
+    auto upper =
+        _mm512_mask_extractf64x4_pd(_mm256_setzero_pd(), 0xF, sums, 1);
+    auto sum = horizontalSum(_mm256_add_pd(lower, upper)) + matrix.constants[r];
+    for (; t < end; t++) {
+      sum += matrix.probabilities[t] * xold[matrix.columns[t]];
+    }
+    xnew[r] = sum;
+  }
+}
+
+__attribute__((target("avx512f,avx2,fma"))) void multiplyAndAddSellAvx512(
+    const SellMatrixView& matrix,
+    const double* xold,
+    double* xnew,
+    StateIndex chunkBegin,
+    StateIndex chunkEnd) {
+  static_assert(SellChunkHeight == 8, "A chunk fills one AVX-512 register");
+  for (auto c = chunkBegin; c < chunkEnd; ++c) {
+    auto sums = _mm512_loadu_pd(matrix.constants + c * SellChunkHeight);
+    auto end = matrix.chunkOffsets[c + 1];
+    for (auto t = matrix.chunkOffsets[c]; t < end; t += SellChunkHeight) {
+      auto probabilities = _mm512_loadu_pd(matrix.probabilities + t);
+      auto values = gather8(xold, matrix.columns + t);
+      sums = _mm512_fmadd_pd(probabilities, values, sums);
+    }
+    _mm512_storeu_pd(xnew + c * SellChunkHeight, sums);
+  }
+}
+#endif
+
+}  // namespace
+
+bool isSimdInstructionSetSupported(SimdInstructionSet instructionSet) {
+  switch (instructionSet) {
+    case SimdInstructionSet::Scalar:
+      return true;
+#if defined(PEMC_RUNTIME_AVX)
+    case SimdInstructionSet::Avx2:
+      return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case SimdInstructionSet::Avx512:
+      return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+      return false;
+  }
+}
+
+SimdInstructionSet getBestSimdInstructionSet() {
+  static const auto best = [] {
+    if (isSimdInstructionSetSupported(SimdInstructionSet::Avx512))
+      return SimdInstructionSet::Avx512;
+    if (isSimdInstructionSetSupported(SimdInstructionSet::Avx2))
+      return SimdInstructionSet::Avx2;
+    return SimdInstructionSet::Scalar;
+  }();
+  return best;
+}
+
+const char* simdInstructionSetToString(SimdInstructionSet instructionSet) {
+  switch (instructionSet) {
+    case SimdInstructionSet::Avx2:
+      return "AVX2";
+    case SimdInstructionSet::Avx512:
+      return "AVX-512";
+    default:
+      return "scalar";
+  }
+}
+
+void multiplyAndAddCsr(SimdInstructionSet instructionSet,
+                       const CsrMatrixView& matrix,
+                       const double* xold,
+                       double* xnew,
+                       StateIndex rowBegin,
+                       StateIndex rowEnd) {
+  switch (instructionSet) {
+#if defined(PEMC_RUNTIME_AVX)
+    case SimdInstructionSet::Avx2:
+      multiplyAndAddCsrAvx2(matrix, xold, xnew, rowBegin, rowEnd);
+      return;
+    case SimdInstructionSet::Avx512:
+      multiplyAndAddCsrAvx512(matrix, xold, xnew, rowBegin, rowEnd);
+      return;
+#endif
+    default:
+      multiplyAndAddCsrScalar(matrix, xold, xnew, rowBegin, rowEnd);
+  }
+}
+
+void multiplyAndAddSell(SimdInstructionSet instructionSet,
+                        const SellMatrixView& matrix,
+                        const double* xold,
+                        double* xnew,
+                        StateIndex chunkBegin,
+                        StateIndex chunkEnd) {
+  switch (instructionSet) {
+#if defined(PEMC_RUNTIME_AVX)
+    case SimdInstructionSet::Avx2:
+      multiplyAndAddSellAvx2(matrix, xold, xnew, chunkBegin, chunkEnd);
+      return;
+    case SimdInstructionSet::Avx512:
+      multiplyAndAddSellAvx512(matrix, xold, xnew, chunkBegin, chunkEnd);
+      return;
+#endif
+    default:
+      multiplyAndAddSellScalar(matrix, xold, xnew, chunkBegin, chunkEnd);
+  }
+}
+
+}  // namespace pemc
@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef PEMC_LMC_SPARSE_MATRIX_KERNELS_H_
+#define PEMC_LMC_SPARSE_MATRIX_KERNELS_H_
+
+#include "pemc/basic/tsc_index.h"
+
+namespace pemc {
+
+// Instruction sets of the kernels. Scalar is always supported.
+enum class SimdInstructionSet { Scalar, Avx2, Avx512 };
+
+bool isSimdInstructionSetSupported(SimdInstructionSet instructionSet);
+
+// The widest instruction set the processor supports.
+SimdInstructionSet getBestSimdInstructionSet();
+
+const char* simdInstructionSetToString(SimdInstructionSet instructionSet);
+
+// Compressed sparse rows. The entries of row r are
+// [rowOffsets[r], rowOffsets[r + 1]).
+struct CsrMatrixView {
+  const TransitionIndex* rowOffsets;
+  const StateIndex* columns;
+  const double* probabilities;
+  const double* constants;
+};
+
+// SELL-C-sigma with C = SellChunkHeight. The rows are grouped into chunks of
+// SellChunkHeight rows. A chunk is stored column by column: its j-th entries
+// of all rows are consecutive. Rows shorter than the longest row of their
+// chunk are padded with zero probabilities. Thus, the entries of chunk c are
+// [chunkOffsets[c], chunkOffsets[c + 1]) and every SIMD lane computes one row.
+// Padding rows at the end have a constant of zero.
+const StateIndex SellChunkHeight = 8;
+
+struct SellMatrixView {
+  const TransitionIndex* chunkOffsets;
+  const StateIndex* columns;
+  const double* probabilities;
+  const double* constants;
+};
+
+// xnew[r] = sum_t probabilities[t] * xold[columns[t]] + constants[r]
+// for all rows r in [rowBegin, rowEnd).
+void multiplyAndAddCsr(SimdInstructionSet instructionSet,
+                       const CsrMatrixView& matrix,
+                       const double* xold,
+                       double* xnew,
+                       StateIndex rowBegin,
+                       StateIndex rowEnd);
+
+// Same for all rows of the chunks in [chunkBegin, chunkEnd). xnew must hold
+// the padding rows.
+void multiplyAndAddSell(SimdInstructionSet instructionSet,
+                        const SellMatrixView& matrix,
+                        const double* xold,
+                        double* xnew,
+                        StateIndex chunkBegin,
+                        StateIndex chunkEnd);
+
+}  // namespace pemc
+
+#endif  // PEMC_LMC_SPARSE_MATRIX_KERNELS_H_
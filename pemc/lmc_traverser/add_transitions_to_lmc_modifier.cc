@@ -24,6 +24,8 @@
 
 #include "pemc/lmc_traverser/add_transitions_to_lmc_modifier.h"
 
+#include <algorithm>
+
 namespace pemc {
 
 AddTransitionsToLmcModifier::AddTransitionsToLmcModifier(Lmc* _lmc) {
@@ -40,19 +42,29 @@ void AddTransitionsToLmcModifier::applyOnTransitions(
 
   TransitionIndex locationOfFirstEntry;
   auto transitionCount = transitions.size();
+  // Invalid transitions (e.g., merged duplicates) are not added.
+  auto validTransitionCount = static_cast<NoOfElements>(std::count_if(
+      transitions.begin(), transitions.end(), [](auto& transition) {
+        return !(transition.flags &
+                 TraversalTransitionFlags::IsTransitionInvalid);
+      }));
 
   if (stateIndexOfSource == std::nullopt) {
     locationOfFirstEntry =
-        lmc->getPlaceForNewInitialTransitionEntries(transitionCount);
+        lmc->getPlaceForNewInitialTransitionEntries(validTransitionCount);
   } else {
     locationOfFirstEntry = lmc->getPlaceForNewTransitionEntriesOfState(
-        *stateIndexOfSource, transitionCount);
+        *stateIndexOfSource, validTransitionCount);
   }
+  auto location = locationOfFirstEntry;
   for (auto i = 0; i < transitionCount; i++) {
+    if (p_transitions[i].flags & TraversalTransitionFlags::IsTransitionInvalid)
+      continue;
     auto newEntry =
         LmcTransitionEntry(transitionProbabilities[i], p_transitions[i].label,
                            p_transitions[i].targetStateIndex);
-    lmc->setLmcTransitionEntry(locationOfFirstEntry + i, newEntry);
+    lmc->setLmcTransitionEntry(location, newEntry);
+    ++location;
   }
 }
 }  // namespace pemc
@@ -50,7 +50,7 @@ bool LmcChoiceResolver::prepareNextPath() {
     return true;
   }
 
-  while (choiceStack.size() > 0) {
+  while (choiceStack.size() > prefixLength) {
     auto lastEntry = choiceStack.back();
     choiceStack.pop_back();
     if (lastEntry.noOfOptions > lastEntry.currentOption + 1) {
@@ -75,7 +75,8 @@ size_t LmcChoiceResolver::choose(const gsl::span<Probability>& choices) {
   choiceDepth++;
   if (choiceDepth < choiceStack.size()) {
     auto idx = choiceStack[choiceDepth].currentOption;
-    if (choiceDepth == choiceStack.size() - 1) {
+    // The probabilities of the fixed prefix are only known on the path.
+    if (choiceDepth == choiceStack.size() - 1 || choiceDepth < static_cast<int32_t>(prefixLength)) {
       choiceStack[choiceDepth].probability = choices[idx] * previousProbability;
     }
     return idx;
@@ -94,7 +95,8 @@ size_t LmcChoiceResolver::choose(size_t numberOfChoices) {
   choiceDepth++;
   if (choiceDepth < choiceStack.size()) {
     auto idx = choiceStack[choiceDepth].currentOption;
-    if (choiceDepth == choiceStack.size() - 1) {
+    // The probabilities of the fixed prefix are only known on the path.
+    if (choiceDepth == choiceStack.size() - 1 || choiceDepth < static_cast<int32_t>(prefixLength)) {
       choiceStack[choiceDepth].probability =
           Probability(1.0 / numberOfChoices) * previousProbability;
     }
@@ -112,7 +114,9 @@ size_t LmcChoiceResolver::choose(size_t numberOfChoices) {
 
 void LmcChoiceResolver::stepFinished() {
   auto probability = Probability::One();
-  if (choiceStack.size() > 0) {
+  if (optionProbabilityStack.size() > 0) {
+    probability = optionProbabilityStack.back();
+  } else if (choiceStack.size() > 0) {
     probability = choiceStack.back().probability;
   }
 
@@ -121,8 +125,53 @@ void LmcChoiceResolver::stepFinished() {
 
 void LmcChoiceResolver::endMacroStepExecution() {}
 
+bool LmcChoiceResolver::supportsChoicePointSnapshots() {
+  return true;
+}
+
+void LmcChoiceResolver::beginOptionOfChoicePoint(
+    Probability probabilityOfOption) {
+  auto previousProbability = Probability::One();
+  if (optionProbabilityStack.size() > 0) {
+    previousProbability = optionProbabilityStack.back();
+  }
+  optionProbabilityStack.push_back(probabilityOfOption * previousProbability);
+}
+
+void LmcChoiceResolver::endOptionOfChoicePoint() {
+  optionProbabilityStack.pop_back();
+}
+
+bool LmcChoiceResolver::supportsPrefixes() {
+  return true;
+}
+
+void LmcChoiceResolver::setPrefix(gsl::span<const size_t> options) {
+  choiceStack.clear();
+  for (auto option : options) {
+    auto entry = LmcChoiceStackEntry();
+    entry.probability = Probability::One();
+    entry.currentOption = option;
+    entry.noOfOptions = option + 1;
+    choiceStack.push_back(entry);
+  }
+  prefixLength = choiceStack.size();
+  // As after a path through the prefix.
+  choiceDepth = static_cast<int32_t>(choiceStack.size()) - 1;
+}
+
+size_t LmcChoiceResolver::getNumberOfOptionsAfterPrefix() {
+  if (choiceStack.size() > prefixLength)
+    return choiceStack[prefixLength].noOfOptions;
+  return 0;
+}
+
 void* LmcChoiceResolver::getCustomPayloadOfLastCalculation() {
   return static_cast<void*>(probabilities.data());
 }
 
+size_t LmcChoiceResolver::getCustomPayloadElementSize() {
+  return sizeof(Probability);
+}
+
 }  // namespace pemc
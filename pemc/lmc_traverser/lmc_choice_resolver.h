@@ -43,6 +43,12 @@ namespace pemc {
       bool firstExecutionOfMacroStep;
       int32_t choiceDepth = -1;
 
+      // The first prefixLength entries of choiceStack are fixed (see setPrefix).
+      size_t prefixLength = 0;
+
+      // Probabilities of the current path with choice point snapshots.
+      std::vector<Probability> optionProbabilityStack;
+
       Probability getPreviousProbability();
   public:
       LmcChoiceResolver();
@@ -62,7 +68,21 @@ namespace pemc {
 
       virtual void endMacroStepExecution();
 
+      virtual bool supportsChoicePointSnapshots();
+
+      virtual void beginOptionOfChoicePoint(Probability probabilityOfOption);
+
+      virtual void endOptionOfChoicePoint();
+
+      virtual bool supportsPrefixes();
+
+      virtual void setPrefix(gsl::span<const size_t> options);
+
+      virtual size_t getNumberOfOptionsAfterPrefix();
+
       virtual void* getCustomPayloadOfLastCalculation();
+
+      virtual size_t getCustomPayloadElementSize();
   };
 
 }
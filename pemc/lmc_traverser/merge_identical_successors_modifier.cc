@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "pemc/lmc_traverser/merge_identical_successors_modifier.h"
+
+#include <algorithm>
+
+#include "pemc/basic/probability.h"
+#include "pemc/basic/raw_memory.h"
+
+namespace pemc {
+
+MergeIdenticalSuccessorsModifier::MergeIdenticalSuccessorsModifier(
+    int32_t _stateVectorSize)
+    : stateVectorSize(_stateVectorSize),
+      stateVectorOperations(getStateVectorOperations(_stateVectorSize)) {}
+
+void MergeIdenticalSuccessorsModifier::setStateVectorSize(
+    int32_t _stateVectorSize) {
+  stateVectorSize = _stateVectorSize;
+  stateVectorOperations = getStateVectorOperations(_stateVectorSize);
+}
+
+bool MergeIdenticalSuccessorsModifier::requiresLabels() {
+  return false;
+}
+
+uint64_t MergeIdenticalSuccessorsModifier::hashTransition(
+    const TraversalTransition& transition) {
+  auto labelHash = static_cast<uint64_t>(transition.label.value);
+  if (transition.flags & TraversalTransitionFlags::IsToStutteringState)
+    return mixBits64(labelHash);
+  return stateVectorOperations.hash64(transition.targetState, labelHash);
+}
+
+bool MergeIdenticalSuccessorsModifier::areTransitionsEqual(
+    const TraversalTransition& transition1,
+    const TraversalTransition& transition2) {
+  if (transition1.label.value != transition2.label.value)
+    return false;
+  auto isToStutteringState1 =
+      (transition1.flags & TraversalTransitionFlags::IsToStutteringState) != 0;
+  auto isToStutteringState2 =
+      (transition2.flags & TraversalTransitionFlags::IsToStutteringState) != 0;
+  if (isToStutteringState1 || isToStutteringState2)
+    return isToStutteringState1 && isToStutteringState2;
+  return stateVectorOperations.areEqual(transition1.targetState,
+                                        transition2.targetState);
+}
+
+void MergeIdenticalSuccessorsModifier::applyOnTransitions(
+    std::optional<StateIndex> stateIndexOfSource,
+    gsl::span<TraversalTransition> transitions,
+    void* customPayLoad) {
+  auto transitionCount = static_cast<size_t>(transitions.size());
+  if (transitionCount < 2)
+    return;
+
+  auto transitionProbabilities = reinterpret_cast<Probability*>(customPayLoad);
+
+  // Keep the load factor at most 1/2. The capacity is a power of two.
+  size_t capacity = 4;
+  while (capacity < 2 * transitionCount)
+    capacity *= 2;
+  if (buckets.size() < capacity)
+    buckets.resize(capacity);
+  std::fill(buckets.begin(), buckets.begin() + capacity, -1);
+  auto mask = capacity - 1;
+
+  for (size_t i = 0; i < transitionCount; ++i) {
+    auto& transition = transitions[i];
+    if (transition.flags & TraversalTransitionFlags::IsTransitionInvalid)
+      continue;
+    auto position = hashTransition(transition) & mask;
+    while (true) {
+      auto existing = buckets[position];
+      if (existing == -1) {
+        buckets[position] = static_cast<int32_t>(i);
+        break;
+      }
+      if (areTransitionsEqual(transitions[existing], transition)) {
+        transitionProbabilities[existing] += transitionProbabilities[i];
+        transition.flags |= TraversalTransitionFlags::IsTransitionInvalid;
+        break;
+      }
+      position = (position + 1) & mask;
+    }
+  }
+}
+
+}  // namespace pemc
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef PEMC_LMC_TRAVERSER_MERGE_IDENTICAL_SUCCESSORS_MODIFIER_H_
+#define PEMC_LMC_TRAVERSER_MERGE_IDENTICAL_SUCCESSORS_MODIFIER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "pemc/basic/raw_memory.h"
+#include "pemc/generic_traverser/i_pre_state_storage_modifier.h"
+
+namespace pemc {
+
+///   Merges the transitions of a source state that have the same target state
+///   and the same label. The probability of a duplicate is added to the first
+///   transition with its target and label, the duplicate is flagged with
+///   IsTransitionInvalid. Thus, duplicates neither probe the state storage
+///   nor end up in the Lmc. The custom payload must be the probabilities of
+///   the LmcChoiceResolver. Transitions to the stuttering state are merged by
+///   their label. The traverser passes the size of the whole state vector via
+///   setStateVectorSize, so modifiers that write into the state vector must
+///   precede this one.
+class MergeIdenticalSuccessorsModifier : public IPreStateStorageModifier {
+ private:
+  int32_t stateVectorSize = 0;
+  StateVectorOperations stateVectorOperations = {};
+
+  // Open addressing hash set of transition indexes; reused for every source
+  // state. -1 marks an empty bucket.
+  std::vector<int32_t> buckets;
+
+  uint64_t hashTransition(const TraversalTransition& transition);
+  bool areTransitionsEqual(const TraversalTransition& transition1,
+                           const TraversalTransition& transition2);
+
+ public:
+  MergeIdenticalSuccessorsModifier() = default;
+  MergeIdenticalSuccessorsModifier(int32_t _stateVectorSize);
+
+  virtual void setStateVectorSize(int32_t _stateVectorSize);
+
+  // Deferred labels are equal for equal target states, so merging by the
+  // target state alone is still correct.
+  virtual bool requiresLabels();
+
+  virtual void applyOnTransitions(std::optional<StateIndex> stateIndexOfSource,
+                                  gsl::span<TraversalTransition> transitions,
+                                  void* customPayLoad);
+};
+
+}  // namespace pemc
+
+#endif  // PEMC_LMC_TRAVERSER_MERGE_IDENTICAL_SUCCESSORS_MODIFIER_H_
@@ -24,16 +24,80 @@
 #include "pemc/pemc.h"
 
 #include <atomic>
+#include <optional>
+
+#include "pemc/basic/ThrowAssert.hpp"
 
 #include "pemc/executable_model/model_executor.h"
 #include "pemc/formula/bounded_unary_formula.h"
+#include "pemc/formula/formula_utils.h"
+#include "pemc/formula/generate_label_based_formula_evaluator.h"
+#include "pemc/formula/unary_formula.h"
+#include "pemc/generic_traverser/early_termination_modifier.h"
+#include "pemc/generic_traverser/external_memory_traverser.h"
 #include "pemc/generic_traverser/generic_traverser.h"
 #include "pemc/lmc/lmc_model_checker.h"
 #include "pemc/lmc_traverser/add_transitions_to_lmc_modifier.h"
 #include "pemc/lmc_traverser/lmc_choice_resolver.h"
+#include "pemc/lmc_traverser/merge_identical_successors_modifier.h"
 #include "pemc/reachability_traverser/reachability_choice_resolver.h"
 #include "pemc/reachability_traverser/reachability_modifier.h"
 
+namespace {
+using namespace pemc;
+
+// The modifiers and options of a traversal besides the configuration.
+struct TraversalSetup {
+  std::function<std::unique_ptr<ITransitionsCalculator>()>
+      transitionsCalculatorCreator;
+  std::vector<std::function<std::unique_ptr<IPreStateStorageModifier>()>>
+      preStateStorageModifierCreators;
+  std::vector<std::function<std::unique_ptr<IPostStateStorageModifier>()>>
+      postStateStorageModifierCreators;
+  bool createStutteringState = false;
+};
+
+// The results of a traversal.
+struct TraversalResult {
+  // including the stuttering state
+  StateIndex numberOfStates;
+  std::optional<StateIndex> stutteringStateIndex;
+  double omissionProbability;
+};
+
+template <typename TTraverser>
+TraversalResult traverseModel(const Configuration& conf,
+                              const TraversalSetup& setup,
+                              cancellation_token cancellationToken) {
+  auto traverser = TTraverser(conf);
+  traverser.transitionsCalculatorCreator = setup.transitionsCalculatorCreator;
+  traverser.preStateStorageModifierCreators =
+      setup.preStateStorageModifierCreators;
+  traverser.postStateStorageModifierCreators =
+      setup.postStateStorageModifierCreators;
+  if (setup.createStutteringState)
+    traverser.enableStutteringState();
+  traverser.traverse(cancellationToken);
+
+  auto result = TraversalResult();
+  result.numberOfStates = traverser.getNoOfStates();
+  result.stutteringStateIndex = traverser.getStutteringStateIndex();
+  result.omissionProbability = traverser.getOmissionProbability();
+  return result;
+}
+
+// Traverses the model with the traverser selected in the configuration.
+TraversalResult traverseModel(const Configuration& conf,
+                              const TraversalSetup& setup,
+                              cancellation_token cancellationToken) {
+  if (conf.useExternalMemoryTraverser) {
+    return traverseModel<ExternalMemoryTraverser>(conf, setup,
+                                                  cancellationToken);
+  }
+  return traverseModel<GenericTraverser>(conf, setup, cancellationToken);
+}
+}  // namespace
+
 namespace pemc {
 Pemc::Pemc() {
   conf = Configuration();
@@ -46,9 +110,50 @@ Pemc::Pemc(const Configuration& _conf) {
 std::unique_ptr<Lmc> Pemc::buildLmcFromExecutableModel(
     const std::function<std::unique_ptr<AbstractModel>()>& modelCreator,
     std::vector<std::shared_ptr<Formula>> formulas) {
+  return buildLmc(conf, modelCreator, formulas, nullptr);
+}
+
+std::unique_ptr<Lmc> Pemc::buildLmcFromExecutableModel(
+    const std::function<std::unique_ptr<AbstractModel>()>& modelCreator,
+    std::vector<std::shared_ptr<Formula>> formulas,
+    int32_t horizon) {
+  throw_assert(horizon >= 0, "horizon must not be negative");
+  auto horizonConf = conf;
+  horizonConf.traversalStrategy = TraversalStrategy::BreadthFirst;
+  horizonConf.traversalHorizon = horizon;
+  auto lmc = buildLmc(horizonConf, modelCreator, formulas, nullptr);
+  lmc->setHorizon(horizon);
+  return lmc;
+}
+
+std::unique_ptr<Lmc> Pemc::buildLmcFromExecutableModelForFormula(
+    const std::function<std::unique_ptr<AbstractModel>()>& modelCreator,
+    std::vector<std::shared_ptr<Formula>> formulas,
+    std::shared_ptr<Formula> formulaToCheck) {
+  auto matchFormula = tryExtractPhiUntilPsiWithBound(*formulaToCheck);
+  throw_assert(matchFormula != std::nullopt,
+               "Only formulas of the form F psi or phi U psi are supported.");
+  auto bound = std::get<2>(*matchFormula);
+  if (bound == std::nullopt)
+    return buildLmc(conf, modelCreator, formulas, formulaToCheck.get());
+
+  // Steps beyond the bound do not matter either.
+  auto horizonConf = conf;
+  horizonConf.traversalStrategy = TraversalStrategy::BreadthFirst;
+  horizonConf.traversalHorizon = *bound;
+  auto lmc = buildLmc(horizonConf, modelCreator, formulas, formulaToCheck.get());
+  lmc->setHorizon(*bound);
+  return lmc;
+}
+
+std::unique_ptr<Lmc> Pemc::buildLmc(
+    const Configuration& buildConf,
+    const std::function<std::unique_ptr<AbstractModel>()>& modelCreator,
+    std::vector<std::shared_ptr<Formula>> formulas,
+    Formula* formulaToTruncateFor) {
   // initialize an empty Lmc, which will contain the resulting model.
   auto lmc = std::make_unique<Lmc>();
-  lmc->initialize(*conf.modelCapacity);
+  lmc->initialize(*buildConf.modelCapacity);
 
   // Set the labels of the Lmc.
   auto labelIdentifier = std::vector<std::string>();
@@ -60,21 +165,28 @@ std::unique_ptr<Lmc> Pemc::buildLmcFromExecutableModel(
                  });
   lmc->setLabelIdentifier(labelIdentifier);
 
-  auto traverser = GenericTraverser(conf);
-
   // Declare a creator for a ModelExecutor that has an instance of the model
   // that should be executed.
   auto transitionsCalculatorCreator =
-      [&modelCreator, &conf = this->conf,
+      [&modelCreator, &conf = buildConf,
        &formulas]() -> std::unique_ptr<ModelExecutor> {
     auto modelExecutor = std::make_unique<ModelExecutor>(conf);
     auto model = modelCreator();
     model->setFormulasForLabel(formulas);
     modelExecutor->setModel(std::move(model));
     modelExecutor->setChoiceResolver(std::make_unique<LmcChoiceResolver>());
+    if (conf.choiceTreeThreads > 1) {
+      modelExecutor->enableParallelChoiceEnumeration(
+          conf,
+          [&modelCreator, &formulas]() {
+            auto helperModel = modelCreator();
+            helperModel->setFormulasForLabel(formulas);
+            return helperModel;
+          },
+          []() { return std::make_unique<LmcChoiceResolver>(); });
+    }
     return modelExecutor;
   };
-  traverser.transitionsCalculatorCreator = transitionsCalculatorCreator;
 
   // Declare a creator for a modifier that adds states to the Lmc.
   auto addTransitionsToLmcModifierCreator =
@@ -82,31 +194,83 @@ std::unique_ptr<Lmc> Pemc::buildLmcFromExecutableModel(
     auto modifier = std::make_unique<AddTransitionsToLmcModifier>(p_lmc);
     return modifier;
   };
-  traverser.postStateStorageModifierCreators.push_back(
+
+  auto setup = TraversalSetup();
+  setup.transitionsCalculatorCreator = transitionsCalculatorCreator;
+  setup.postStateStorageModifierCreators.push_back(
       addTransitionsToLmcModifierCreator);
 
-  // Traverse the model.
-  traverser.traverse(cancellation_token::none());
+  // Once a transition satisfies psi or violates phi, the successors of its
+  // target do not matter for phi U psi. Such transitions are redirected to
+  // the stuttering state.
+  if (formulaToTruncateFor != nullptr) {
+    Formula* phi;
+    Formula* psi;
+    std::optional<int> bound;
+    std::tie(phi, psi, bound) =
+        *tryExtractPhiUntilPsiWithBound(*formulaToTruncateFor);
+    auto psiEvaluator = generateLabelBasedFormulaEvaluator(
+        lmc->getLabelIdentifier(), psi);
+    std::function<bool(Label)> phiEvaluator = [](Label label) {
+      return true;
+    };
+    if (phi != nullptr) {
+      phiEvaluator = generateLabelBasedFormulaEvaluator(
+          lmc->getLabelIdentifier(), phi);
+    }
+    auto terminateEarlyCondition = [psiEvaluator,
+                                    phiEvaluator](Label label) {
+      return psiEvaluator(label) || !phiEvaluator(label);
+    };
+    setup.preStateStorageModifierCreators.push_back(
+        [terminateEarlyCondition]()
+            -> std::unique_ptr<IPreStateStorageModifier> {
+          return std::make_unique<EarlyTerminationModifier>(
+              terminateEarlyCondition);
+        });
+    setup.createStutteringState = true;
+    lmc->setTruncatedForPhiUntilPsi(phiUntilPsiToStrings(phi, psi));
+  }
+
+  // Merge duplicate successors before they reach the state storage. Must be
+  // the last pre state storage modifier (see
+  // MergeIdenticalSuccessorsModifier).
+  if (buildConf.mergeIdenticalSuccessors) {
+    setup.preStateStorageModifierCreators.push_back(
+        []() -> std::unique_ptr<IPreStateStorageModifier> {
+          return std::make_unique<MergeIdenticalSuccessorsModifier>();
+        });
+  }
+
+  // Traverse the model. The Lmc needs the indexes of all states, so the
+  // states are always stored exactly.
+  auto exactConf = buildConf;
+  exactConf.stateStorageType = StateStorageType::Exact;
+  auto result = traverseModel(exactConf, setup, cancellation_token::none());
 
   // Finish the creation of the Lmc and return it.
-  auto getNoOfStates = traverser.getNoOfStates();
-  lmc->finishCreation(getNoOfStates);
+  if (result.stutteringStateIndex)
+    lmc->createStutteringState(*result.stutteringStateIndex);
+  lmc->finishCreation(result.numberOfStates);
   return lmc;
 }
 
 bool Pemc::checkReachabilityInExecutableModel(
     const std::function<std::unique_ptr<AbstractModel>()>& modelCreator,
     std::shared_ptr<Formula> formula) {
-  // initialize an empty Lmc, which will contain the resulting model.
-  auto lmc = std::make_unique<Lmc>();
-  lmc->initialize(*conf.modelCapacity);
+  Probability omissionProbability;
+  return checkReachabilityInExecutableModel(modelCreator, formula,
+                                            omissionProbability);
+}
 
+bool Pemc::checkReachabilityInExecutableModel(
+    const std::function<std::unique_ptr<AbstractModel>()>& modelCreator,
+    std::shared_ptr<Formula> formula,
+    Probability& omissionProbability) {
   // Because there is only one formula there is only one label
   std::vector<std::shared_ptr<Formula>> formulas;
   formulas.push_back(formula);
 
-  auto traverser = GenericTraverser(conf);
-
   // Declare a creator for a ModelExecutor that has an instance of the model
   // that should be executed.
   auto transitionsCalculatorCreator =
@@ -120,7 +284,6 @@ bool Pemc::checkReachabilityInExecutableModel(
         std::make_unique<ReachabilityChoiceResolver>());
     return modelExecutor;
   };
-  traverser.transitionsCalculatorCreator = transitionsCalculatorCreator;
 
   std::atomic<bool> reached(false);
 
@@ -135,11 +298,19 @@ bool Pemc::checkReachabilityInExecutableModel(
         std::make_unique<ReachabilityModifier>(&reached, tokenSource);
     return modifier;
   };
-  traverser.postStateStorageModifierCreators.push_back(
-      reachabilityModifierCreator);
 
   // Traverse the model.
-  traverser.traverse(tokenSource.get_token());
+  auto setup = TraversalSetup();
+  setup.transitionsCalculatorCreator = transitionsCalculatorCreator;
+  setup.postStateStorageModifierCreators.push_back(reachabilityModifierCreator);
+  auto result = traverseModel(conf, setup, tokenSource.get_token());
+  auto omissionProbabilityOfTraversal = result.omissionProbability;
+  omissionProbability = Probability(omissionProbabilityOfTraversal);
+
+  if (conf.stateStorageType != StateStorageType::Exact) {
+    *conf.cout << "Estimated probability that a state has been omitted: "
+               << omissionProbabilityOfTraversal << std::endl;
+  }
 
   return reached.load();
 }
@@ -155,4 +326,15 @@ Probability Pemc::calculateProbabilityToReachStateWithinBound(
   auto probability = mc.calculateProbability(*finally_formula);
   return probability;
 }
+
+Probability Pemc::calculateProbabilityToReachState(
+    Lmc& lmc,
+    std::shared_ptr<Formula> formula) {
+  auto finally_formula =
+      std::make_shared<UnaryFormula>(formula, UnaryOperator::Finally);
+
+  auto mc = LmcModelChecker(lmc, conf);
+  auto probability = mc.calculateProbability(*finally_formula);
+  return probability;
+}
 }  // namespace pemc
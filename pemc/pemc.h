@@ -41,6 +41,12 @@ class Pemc {
  private:
   Configuration conf;
 
+  std::unique_ptr<Lmc> buildLmc(
+      const Configuration& buildConf,
+      const std::function<std::unique_ptr<AbstractModel>()>& modelCreator,
+      std::vector<std::shared_ptr<Formula>> formulas,
+      Formula* formulaToTruncateFor);
+
  public:
   Pemc();
   Pemc(const Configuration& _conf);
@@ -51,18 +57,52 @@ class Pemc {
       const std::function<std::unique_ptr<AbstractModel>()>& modelCreator,
       std::vector<std::shared_ptr<Formula>> formulas);
 
+  // Like above, but only the states that can be reached within horizon steps
+  // are expanded (breadth first). Transitions leaving the horizon lead to the
+  // stuttering state. The Lmc gives exact results for bounds up to horizon.
+  std::unique_ptr<Lmc> buildLmcFromExecutableModel(
+      const std::function<std::unique_ptr<AbstractModel>()>& modelCreator,
+      std::vector<std::shared_ptr<Formula>> formulas,
+      int32_t horizon);
+
+  // Builds an Lmc that is only suitable to check formulaToCheck, which must
+  // be of the form F psi or phi U psi, optionally bounded. Transitions that
+  // satisfy psi or violate phi lead to the stuttering state, so their
+  // successors are not explored. A bound is used as horizon (see above).
+  // phi and psi must be evaluable on the labels of formulas. Checking another
+  // phi U psi on the resulting Lmc throws; only the bound may differ.
+  std::unique_ptr<Lmc> buildLmcFromExecutableModelForFormula(
+      const std::function<std::unique_ptr<AbstractModel>()>& modelCreator,
+      std::vector<std::shared_ptr<Formula>> formulas,
+      std::shared_ptr<Formula> formulaToCheck);
+
   // The modelCreator creates an instance of an executable model.
   // The formulas are the formulas to include as labels.
   bool checkReachabilityInExecutableModel(
       const std::function<std::unique_ptr<AbstractModel>()>& modelCreator,
       std::shared_ptr<Formula> formula);
 
+  // Like above. If the states are stored lossy (see
+  // Configuration::stateStorageType), a reachable state might be missed. The
+  // estimated probability of such an omission is written to
+  // omissionProbability (0 for exact state storage).
+  bool checkReachabilityInExecutableModel(
+      const std::function<std::unique_ptr<AbstractModel>()>& modelCreator,
+      std::shared_ptr<Formula> formula,
+      Probability& omissionProbability);
+
   // Lmc is a Labeled Markov chain. This method calculates the probability
   // to reach
   Probability calculateProbabilityToReachStateWithinBound(
       Lmc& lmc,
       std::shared_ptr<Formula> formula,
       int32_t bound);
+
+  // Same without a bound. Solved iteratively until the tolerances of the
+  // configuration are met (see Configuration::lmcIterativeSolver).
+  Probability calculateProbabilityToReachState(
+      Lmc& lmc,
+      std::shared_ptr<Formula> formula);
 };
 
 }  // namespace pemc
@@ -94,6 +94,10 @@ void ReachabilityChoiceResolver::stepFinished() {}
 
 void ReachabilityChoiceResolver::endMacroStepExecution() {}
 
+bool ReachabilityChoiceResolver::supportsChoicePointSnapshots() {
+  return true;
+}
+
 void* ReachabilityChoiceResolver::getCustomPayloadOfLastCalculation() {
   return nullptr;
 }
@@ -58,6 +58,8 @@ class ReachabilityChoiceResolver : public IChoiceResolver {
 
   virtual void endMacroStepExecution();
 
+  virtual bool supportsChoicePointSnapshots();
+
   virtual void* getCustomPayloadOfLastCalculation();
 };
 
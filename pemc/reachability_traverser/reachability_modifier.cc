@@ -41,6 +41,8 @@ void ReachabilityModifier::applyOnTransitions(
   auto transitionCount = transitions.size();
 
   for (auto i = 0; i < transitionCount; i++) {
+    if (transitions[i].flags & TraversalTransitionFlags::IsTransitionInvalid)
+      continue;
     if (transitions[i].label[0] == true) {
       *reached = true;
       cancellationTokenSource.cancel();
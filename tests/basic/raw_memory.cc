@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "pemc/basic/raw_memory.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+
+using namespace pemc;
+
+namespace {
+uint64_t hashString(const std::string& value) {
+  auto buffer = reinterpret_cast<gsl::byte*>(const_cast<char*>(value.data()));
+  return hashBuffer64(buffer, value.size(), 0);
+}
+}  // namespace
+
+TEST(basic_test, hashBuffer64_matches_xxh64) {
+  ASSERT_EQ(hashString(""), 0xEF46DB3751D8E999ULL) << "FAIL";
+  ASSERT_EQ(hashString("a"), 0xD24EC4F1A98C6E5BULL) << "FAIL";
+  ASSERT_EQ(hashString("abc"), 0x44BC2CF5AD770999ULL) << "FAIL";
+  ASSERT_EQ(hashString("Nobody inspects the spammish repetition"),
+            0xFBCEA83C8A378BF1ULL)
+      << "FAIL";
+}
+
+TEST(basic_test, hashBuffer64_depends_on_seed_and_unaligned_input) {
+  char data[48];
+  for (size_t i = 0; i < sizeof(data); ++i)
+    data[i] = static_cast<char>(i * 7);
+  auto buffer = reinterpret_cast<gsl::byte*>(data);
+
+  ASSERT_NE(hashBuffer64(buffer, 40, 0), hashBuffer64(buffer, 40, 1)) << "FAIL";
+
+  char shifted[49];
+  std::memcpy(shifted + 1, data, sizeof(data));
+  auto shiftedBuffer = reinterpret_cast<gsl::byte*>(shifted + 1);
+  ASSERT_EQ(hashBuffer64(buffer, 45, 3), hashBuffer64(shiftedBuffer, 45, 3))
+      << "FAIL";
+}
+
+TEST(basic_test, stateVectorOperations_match_generic_functions) {
+  char data[80];
+  char copy[80];
+  for (size_t i = 0; i < sizeof(data); ++i)
+    data[i] = static_cast<char>(i * 13 + 5);
+  auto buffer = reinterpret_cast<gsl::byte*>(data);
+  auto copyBuffer = reinterpret_cast<gsl::byte*>(copy);
+
+  // Specialised sizes, generic sizes and sizes beyond the specialisations.
+  for (size_t size = 1; size <= sizeof(data); ++size) {
+    auto operations = getStateVectorOperations(size);
+    ASSERT_EQ(operations.hash64(buffer, 7), hashBuffer64(buffer, size, 7))
+        << "FAIL";
+    std::memset(copy, 0, sizeof(copy));
+    operations.copy(buffer, copyBuffer);
+    ASSERT_EQ(operations.areEqual(buffer, copyBuffer), true) << "FAIL";
+    ASSERT_EQ(std::memcmp(data, copy, size), 0) << "FAIL";
+    if (size < sizeof(copy)) {
+      ASSERT_EQ(copy[size], 0) << "FAIL";
+    }
+    copy[size - 1] ^= 1;
+    ASSERT_EQ(operations.areEqual(buffer, copyBuffer), false) << "FAIL";
+  }
+}
+
+TEST(basic_test, updateLinearHash64_matches_hashBufferLinear64) {
+  char oldData[45];
+  char newData[45];
+  for (size_t i = 0; i < sizeof(oldData); ++i)
+    oldData[i] = static_cast<char>(i * 11 + 3);
+  std::memcpy(newData, oldData, sizeof(oldData));
+  auto oldBuffer = reinterpret_cast<gsl::byte*>(oldData);
+  auto newBuffer = reinterpret_cast<gsl::byte*>(newData);
+
+  // A word in the middle and the last, partial word change.
+  newData[17] ^= 0x40;
+  newData[44] ^= 0x01;
+  for (auto size : {size_t(18), size_t(45)}) {
+    auto hashOfOld = hashBufferLinear64(oldBuffer, size);
+    auto hashOfNew = hashBufferLinear64(newBuffer, size);
+    ASSERT_NE(hashOfOld, hashOfNew) << "FAIL";
+    ASSERT_EQ(updateLinearHash64(hashOfOld, oldBuffer, newBuffer, size),
+              hashOfNew)
+        << "FAIL";
+    ASSERT_EQ(updateLinearHash64(hashOfOld, oldBuffer, oldBuffer, size),
+              hashOfOld)
+        << "FAIL";
+  }
+
+  // Moving a word to another position changes the hash.
+  uint64_t words1[2] = {1, 2};
+  uint64_t words2[2] = {2, 1};
+  ASSERT_NE(hashBufferLinear64(reinterpret_cast<gsl::byte*>(words1), 16),
+            hashBufferLinear64(reinterpret_cast<gsl::byte*>(words2), 16))
+      << "FAIL";
+}
+
+TEST(basic_test, areBuffersEqual_finds_every_difference) {
+  // Covers the vector loops, their remainders and unaligned buffers.
+  char data1[200];
+  char data2[201];
+  for (size_t i = 0; i < sizeof(data1); ++i)
+    data1[i] = static_cast<char>(i * 29 + 1);
+  std::memcpy(data2 + 1, data1, sizeof(data1));
+  auto buffer1 = reinterpret_cast<gsl::byte*>(data1);
+  auto buffer2 = reinterpret_cast<gsl::byte*>(data2 + 1);
+
+  for (size_t size = 0; size <= sizeof(data1); size += (size < 70 ? 1 : 13)) {
+    ASSERT_EQ(areBuffersEqual(buffer1, buffer2, size), true) << "FAIL";
+    for (size_t position = 0; position < size; ++position) {
+      data2[1 + position] ^= 0x10;
+      ASSERT_EQ(areBuffersEqual(buffer1, buffer2, size), false) << "FAIL";
+      data2[1 + position] ^= 0x10;
+    }
+  }
+}
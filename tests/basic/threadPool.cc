@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "pemc/basic/thread_pool.h"
+
+using namespace pemc;
+
+TEST(threadPool_test, parallelFor_calls_each_task_once) {
+  auto threadPool = ThreadPool(4);
+  ASSERT_EQ(threadPool.getNumberOfThreads(), 4) << "FAIL";
+
+  for (auto round = 0; round < 10; ++round) {
+    auto calls = std::vector<std::atomic<int32_t>>(1000);
+    std::atomic<bool> invalidThreadIndex(false);
+    threadPool.parallelFor(1000, [&](int64_t taskIndex, int32_t threadIndex) {
+      calls[taskIndex]++;
+      if (threadIndex < 0 || threadIndex >= 4)
+        invalidThreadIndex = true;
+    });
+    for (auto& call : calls) {
+      ASSERT_EQ(call.load(), 1) << "FAIL";
+    }
+    ASSERT_EQ(invalidThreadIndex.load(), false) << "FAIL";
+  }
+}
+
+TEST(threadPool_test, parallelFor_rethrows_exceptions) {
+  auto threadPool = ThreadPool(3);
+  ASSERT_THROW(threadPool.parallelFor(100, [](int64_t taskIndex, int32_t) {
+    if (taskIndex == 42)
+      throw std::runtime_error("task failed");
+  }), std::runtime_error) << "FAIL";
+
+  // The pool can be used again afterwards.
+  std::atomic<int64_t> sum(0);
+  threadPool.parallelFor(100, [&](int64_t taskIndex, int32_t) { sum += taskIndex; });
+  ASSERT_EQ(sum.load(), 4950) << "FAIL";
+}
+
+TEST(threadPool_test, runOnEveryThread_meets_at_the_barrier) {
+  auto threadPool = ThreadPool(4);
+  auto barrier = SpinningBarrier(4);
+  auto values = std::vector<int32_t>(4, -1);
+  std::atomic<int32_t> mismatches(0);
+
+  threadPool.runOnEveryThread([&](int32_t threadIndex) {
+    for (auto phase = 0; phase < 100; ++phase) {
+      values[threadIndex] = phase;
+      barrier.arriveAndWait();
+      for (auto value : values) {
+        if (value != phase)
+          mismatches++;
+      }
+      barrier.arriveAndWait();
+    }
+  });
+  ASSERT_EQ(mismatches.load(), 0) << "FAIL";
+
+  // parallelFor still distributes the tasks dynamically afterwards.
+  std::atomic<int64_t> sum(0);
+  threadPool.parallelFor(100, [&](int64_t taskIndex, int32_t) { sum += taskIndex; });
+  ASSERT_EQ(sum.load(), 4950) << "FAIL";
+}
@@ -137,9 +137,9 @@ TEST(c_api_test, c_api_function_accessor_works) {
 
 TEST(c_api_test, c_api_check_reachability_in_executable_model_works) {
   // setup model functions
-  pemc_model_functions model_functions;
+  pemc_model_functions model_functions = {0};
   model_functions.model_create = (pemc_model_create)test_model_create;
-  model_functions.model_free = (pemc_model_free)test_model_create;
+  model_functions.model_free = (pemc_model_free)test_model_free;
   model_functions.serialize =
       (pemc_serialize_function_type)test_model_serialize;
   model_functions.deserialize =
@@ -178,6 +178,101 @@ TEST(c_api_test, c_api_check_reachability_in_executable_model_works) {
   ASSERT_EQ(result_f2, false) << "FAIL";
 }
 
+// The resident test model keeps its state in the state vector of pemc.
+typedef struct ResidentTestModel {
+  int32_t* state;
+  pemc_model_specific_interface* pemc_interface;
+} ResidentTestModel;
+
+void resident_test_model_create(unsigned char** model,
+                                pemc_model_specific_interface* _pemc_interface,
+                                unsigned char* optional_value_for_model_create) {
+  ResidentTestModel* testmodel =
+      (ResidentTestModel*)malloc(sizeof(ResidentTestModel));
+  testmodel->state = NULL;
+  testmodel->pemc_interface = _pemc_interface;
+  *model = (unsigned char*)testmodel;
+}
+
+void resident_test_model_use_state_vector(unsigned char* model,
+                                          unsigned char* position,
+                                          size_t size) {
+  ResidentTestModel* testmodel = (ResidentTestModel*)model;
+  testmodel->state = (int32_t*)position;
+}
+
+void resident_test_model_reset_to_initial_state(unsigned char* model) {
+  ResidentTestModel* testmodel = (ResidentTestModel*)model;
+  *testmodel->state = 0;
+}
+
+void resident_test_model_step(unsigned char* model) {
+  ResidentTestModel* testmodel = (ResidentTestModel*)model;
+
+  if (*testmodel->state == 0) {
+    int32_t options[] = {1, 3};
+    int numOptions = sizeof(options) / sizeof(options[0]);
+    *testmodel->state = pemc_function_accessor.pemc_choose_int_option(
+        testmodel->pemc_interface, options, numOptions);
+  } else if (*testmodel->state == 1) {
+    *testmodel->state = 3;
+  }
+}
+
+int32_t resident_formula_f1(unsigned char* model) {
+  ResidentTestModel* testmodel = (ResidentTestModel*)model;
+  return *testmodel->state == 3;
+}
+
+int32_t resident_formula_f2(unsigned char* model) {
+  ResidentTestModel* testmodel = (ResidentTestModel*)model;
+  return *testmodel->state == 4;
+}
+
+TEST(c_api_test,
+     c_api_check_reachability_in_resident_executable_model_works) {
+  // setup model functions; serialize and deserialize stay NULL
+  pemc_resident_model_functions resident_model_functions = {0};
+  resident_model_functions.model_functions.model_create =
+      (pemc_model_create)resident_test_model_create;
+  resident_model_functions.model_functions.model_free =
+      (pemc_model_free)test_model_free;
+  resident_model_functions.model_functions.reset_to_initial_state =
+      (pemc_reset_to_initial_state_function_type)
+          resident_test_model_reset_to_initial_state;
+  resident_model_functions.model_functions.step =
+      (pemc_step_function_type)resident_test_model_step;
+  resident_model_functions.model_functions.get_state_vector_size =
+      (pemc_get_state_vector_size_function_type)
+          test_model_get_state_vector_size;
+  resident_model_functions.use_state_vector =
+      (pemc_use_state_vector_function_type)
+          resident_test_model_use_state_vector;
+
+  // get pemc functions
+  assign_pemc_functions(&pemc_function_accessor);
+
+  pemc_formula_ref* f1 =
+      pemc_function_accessor.pemc_register_basic_formula(resident_formula_f1);
+
+  pemc_formula_ref* f2 =
+      pemc_function_accessor.pemc_register_basic_formula(resident_formula_f2);
+
+  auto result_f1 =
+      pemc_function_accessor.check_reachability_in_resident_executable_model(
+          resident_model_functions, NULL, f1);
+
+  auto result_f2 =
+      pemc_function_accessor.check_reachability_in_resident_executable_model(
+          resident_model_functions, NULL, f2);
+
+  pemc_function_accessor.pemc_unref_formula(f1);
+  pemc_function_accessor.pemc_unref_formula(f2);
+
+  ASSERT_EQ(result_f1, true) << "FAIL";
+  ASSERT_EQ(result_f2, false) << "FAIL";
+}
+
 static int32_t dummy_choose_by_no_of_options(
     pemc_model_specific_interface* pemc_interface,
     int32_t no_of_options) {
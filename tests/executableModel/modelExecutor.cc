@@ -22,11 +22,13 @@
 // THE SOFTWARE.
 
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <iostream>
 
 #include "pemc/executable_model/model_executor.h"
 #include "pemc/lmc_traverser/lmc_choice_resolver.h"
 
+#include "tests/basic/allocationCounter.h"
 #include "tests/simpleExecutableModel/simpleFormula.h"
 #include "tests/simpleExecutableModel/simpleModel.h"
 
@@ -106,3 +108,208 @@ TEST(modelExecutor_test, modelExecutor_test) {
     ASSERT_EQ(label3[0], true) << "FAIL";
     ASSERT_EQ(probabilityIsOne(prob3, 0.0001), true) << "FAIL";
 }
+
+namespace {
+  // Two nested choices. With choice point snapshots, the code before a
+  // choice point is executed once per choice point and not once per path.
+  class ContinuationModel : public SimpleModel {
+  public:
+    bool withSnapshots = true;
+    int32_t executionsOfPrefix = 0;
+    int32_t executionsOfInnerPrefix = 0;
+
+    virtual bool usesContinuationStyleChoices() {
+      return withSnapshots;
+    }
+
+    virtual void step() {
+      executionsOfPrefix++;
+      auto probabilities = std::vector<Probability>( {Probability(0.2), Probability(0.8)} );
+      AbstractModel::choose(probabilities, [this](size_t outer) {
+        setState(getState() + static_cast<int32_t>(outer) * 10);
+        executionsOfInnerPrefix++;
+        if (outer == 0)
+          return;
+        AbstractModel::choose(3, [this](size_t inner) {
+          setState(getState() + static_cast<int32_t>(inner));
+        });
+      });
+    }
+  };
+}
+
+TEST(modelExecutor_test, modelExecutor_with_choice_point_snapshots_test) {
+    auto configuration = Configuration();
+
+    std::vector<std::vector<std::tuple<int32_t, double>>> results;
+    for (auto withSnapshots : {false, true}) {
+      auto modelExecutor = std::make_unique<ModelExecutor>(configuration);
+      auto model = std::make_unique<ContinuationModel>();
+      model->withSnapshots = withSnapshots;
+      model->setFormulasForLabel(formulas);
+      auto modelPtr = model.get();
+      modelExecutor->setModel(std::move(model));
+      modelExecutor->setChoiceResolver(std::make_unique<LmcChoiceResolver>());
+
+      *sourceStatePtr = 1;
+      auto resultTransitions = modelExecutor->calculateTransitionsOfState(sourceState);
+      auto resultPayload = reinterpret_cast<Probability*>(modelExecutor->getCustomPayloadOfLastCalculation());
+      auto result = std::vector<std::tuple<int32_t, double>>();
+      for (auto i = 0; i < resultTransitions.size(); ++i) {
+        auto target = *reinterpret_cast<int32_t*>(resultTransitions[i].targetState);
+        result.push_back(std::make_tuple(target, resultPayload[i].value));
+      }
+      std::sort(result.begin(), result.end());
+      results.push_back(result);
+
+      ASSERT_EQ(modelPtr->executionsOfPrefix, withSnapshots ? 1 : 4) << "FAIL";
+      ASSERT_EQ(modelPtr->executionsOfInnerPrefix, withSnapshots ? 2 : 4) << "FAIL";
+    }
+
+    ASSERT_EQ(results[0].size(), 4) << "FAIL";
+    ASSERT_EQ(results[1].size(), 4) << "FAIL";
+    for (auto i = 0; i < 4; ++i) {
+      ASSERT_EQ(std::get<0>(results[1][i]), std::get<0>(results[0][i])) << "FAIL";
+      ASSERT_EQ(probabilityIsAround(std::get<1>(results[1][i]), std::get<1>(results[0][i]), 0.0000001), true) << "FAIL";
+    }
+    ASSERT_EQ(std::get<0>(results[1][0]), 1) << "FAIL";
+    ASSERT_EQ(probabilityIsAround(std::get<1>(results[1][0]), 0.2, 0.0000001), true) << "FAIL";
+    ASSERT_EQ(std::get<0>(results[1][3]), 13) << "FAIL";
+    ASSERT_EQ(probabilityIsAround(std::get<1>(results[1][3]), 0.8 / 3.0, 0.0000001), true) << "FAIL";
+}
+
+namespace {
+  // An LmcChoiceResolver without choice point snapshots.
+  class ReplayingLmcChoiceResolver : public LmcChoiceResolver {
+  public:
+    virtual bool supportsChoicePointSnapshots() {
+      return false;
+    }
+  };
+}
+
+TEST(modelExecutor_test, modelExecutor_disables_choice_point_snapshots_test) {
+    auto configuration = Configuration();
+
+    auto modelExecutor = std::make_unique<ModelExecutor>(configuration);
+    auto model = std::make_unique<ContinuationModel>();
+    model->setFormulasForLabel(formulas);
+    auto modelPtr = model.get();
+    modelExecutor->setModel(std::move(model));
+    modelExecutor->setChoiceResolver(std::make_unique<LmcChoiceResolver>());
+    // The new choice resolver requires the replaying choose.
+    modelExecutor->setChoiceResolver(std::make_unique<ReplayingLmcChoiceResolver>());
+
+    *sourceStatePtr = 1;
+    auto resultTransitions = modelExecutor->calculateTransitionsOfState(sourceState);
+    auto resultPayload = reinterpret_cast<Probability*>(modelExecutor->getCustomPayloadOfLastCalculation());
+    ASSERT_EQ(resultTransitions.size(), 4) << "FAIL";
+    ASSERT_EQ(modelPtr->executionsOfPrefix, 4) << "FAIL";
+    auto probabilitySum = 0.0;
+    for (auto i = 0; i < resultTransitions.size(); ++i) {
+      probabilitySum += resultPayload[i].value;
+    }
+    ASSERT_EQ(probabilityIsOne(probabilitySum, 0.0000001), true) << "FAIL";
+}
+
+namespace {
+  // Has more successors than the initial capacity of the ModelExecutor.
+  class ManySuccessorsModel : public SimpleModel {
+    virtual void step() {
+      auto option = AbstractModel::choose(3000);
+      setState( getState() + choose( {0, 1} ) * 3000 + static_cast<int32_t>(option) );
+    }
+  };
+}
+
+TEST(modelExecutor_test, modelExecutor_does_not_allocate_in_steady_state_test) {
+    auto configuration = Configuration();
+    configuration.successorCapacity = 1024;
+
+    auto modelExecutor = std::make_unique<ModelExecutor>(configuration);
+    auto model = std::make_unique<ManySuccessorsModel>();
+    model->setFormulasForLabel(formulas);
+    modelExecutor->setModel(std::move(model));
+    modelExecutor->setChoiceResolver(std::make_unique<LmcChoiceResolver>());
+
+    // The first macro step lets the buffers grow.
+    *sourceStatePtr = 0;
+    auto resultTransitions = modelExecutor->calculateTransitionsOfState(sourceState);
+    ASSERT_EQ(resultTransitions.size(), 6000) << "FAIL";
+    for (auto i = 0; i < resultTransitions.size(); ++i) {
+      auto target = *reinterpret_cast<int32_t*>(resultTransitions[i].targetState);
+      ASSERT_EQ(target, (i % 2) * 3000 + i / 2) << "FAIL";
+    }
+
+    auto allocationsBefore = pemc::tests::getNumberOfAllocationsOfThisThread();
+    for (auto state = 1; state < 10; ++state) {
+      *sourceStatePtr = state;
+      resultTransitions = modelExecutor->calculateTransitionsOfState(sourceState);
+    }
+    auto allocations = pemc::tests::getNumberOfAllocationsOfThisThread() - allocationsBefore;
+
+    ASSERT_EQ(allocations, 0) << "FAIL";
+    ASSERT_EQ(*reinterpret_cast<int32_t*>(resultTransitions[5999].targetState), 9 + 5999) << "FAIL";
+}
+
+namespace {
+  // Independent choices with a different number of choices on some paths.
+  class FaultsModel : public SimpleModel {
+    virtual void step() {
+      auto fault1 = choose( {0, 1, 2, 3, 4} );
+      if (fault1 == 4) {
+        setState(getState() + 1000);
+        return;
+      }
+      auto fault2 = std::get<1>(choose( {std::make_tuple(Probability(0.1), 0), std::make_tuple(Probability(0.9), 1)} ));
+      auto fault3 = static_cast<int32_t>(AbstractModel::choose(7));
+      setState(getState() + fault1 * 100 + fault2 * 10 + fault3);
+    }
+  };
+}
+
+TEST(modelExecutor_test, modelExecutor_with_parallel_choice_enumeration_test) {
+    auto modelCreator = []() -> std::unique_ptr<AbstractModel> {
+      auto model = std::make_unique<FaultsModel>();
+      model->setFormulasForLabel(formulas);
+      return model;
+    };
+
+    std::vector<std::vector<std::tuple<int32_t, double, int32_t>>> results;
+    for (auto choiceTreeThreads : {1, 2, 5}) {
+      auto configuration = Configuration();
+      configuration.choiceTreeThreads = choiceTreeThreads;
+      auto modelExecutor = std::make_unique<ModelExecutor>(configuration);
+      modelExecutor->setModel(modelCreator());
+      modelExecutor->setChoiceResolver(std::make_unique<LmcChoiceResolver>());
+      modelExecutor->enableParallelChoiceEnumeration(configuration, modelCreator,
+          []() { return std::make_unique<LmcChoiceResolver>(); });
+
+      auto result = std::vector<std::tuple<int32_t, double, int32_t>>();
+      for (auto state : {1, 2}) {
+        *sourceStatePtr = state;
+        auto resultTransitions = modelExecutor->calculateTransitionsOfState(sourceState);
+        auto resultPayload = reinterpret_cast<Probability*>(modelExecutor->getCustomPayloadOfLastCalculation());
+        for (auto i = 0; i < resultTransitions.size(); ++i) {
+          auto target = *reinterpret_cast<int32_t*>(resultTransitions[i].targetState);
+          result.push_back(std::make_tuple(target, resultPayload[i].value, resultTransitions[i].label.value));
+        }
+      }
+      results.push_back(result);
+    }
+
+    // The order of the transitions does not depend on the number of threads.
+    ASSERT_EQ(results[0].size(), 2 * (4 * 2 * 7 + 1)) << "FAIL";
+    for (auto& result : results) {
+      ASSERT_EQ(result.size(), results[0].size()) << "FAIL";
+      for (size_t i = 0; i < result.size(); ++i) {
+        ASSERT_EQ(std::get<0>(result[i]), std::get<0>(results[0][i])) << "FAIL";
+        ASSERT_EQ(std::get<1>(result[i]), std::get<1>(results[0][i])) << "FAIL";
+        ASSERT_EQ(std::get<2>(result[i]), std::get<2>(results[0][i])) << "FAIL";
+      }
+    }
+    ASSERT_EQ(std::get<0>(results[0][1]), 1 + 1) << "FAIL";
+    ASSERT_EQ(probabilityIsAround(std::get<1>(results[0][1]), 0.2 * 0.1 / 7.0, 0.0000001), true) << "FAIL";
+    ASSERT_EQ(std::get<0>(results[0][4 * 2 * 7]), 1 + 1000) << "FAIL";
+    ASSERT_EQ(probabilityIsAround(std::get<1>(results[0][4 * 2 * 7]), 0.2, 0.0000001), true) << "FAIL";
+}
@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "pemc/generic_traverser/external_sorter.h"
+
+using namespace pemc;
+
+TEST(genericTraverser_test, externalSorter_sorts_in_memory) {
+  auto sorter = ExternalSorter("", sizeof(int32_t), sizeof(int32_t), 1 << 20);
+  for (auto value : {3, 1, 2}) {
+    sorter.add(reinterpret_cast<gsl::byte*>(&value));
+  }
+  sorter.sort();
+
+  auto result = std::vector<int32_t>();
+  while (auto record = sorter.next()) {
+    int32_t value;
+    std::memcpy(&value, record, sizeof(int32_t));
+    result.push_back(value);
+  }
+
+  ASSERT_EQ(result, (std::vector<int32_t>{1, 2, 3})) << "FAIL";
+}
+
+TEST(genericTraverser_test, externalSorter_merges_many_runs) {
+  // Records consist of a big endian key and a payload that is not compared.
+  // A buffer of 10 records results in more runs than can be merged at once.
+  auto recordSize = 3;
+  auto numberOfRecords = 5000;
+  auto sorter = ExternalSorter("", recordSize, 2, 10 * recordSize);
+
+  auto randomGenerator = std::mt19937(42);
+  auto keys = std::vector<int32_t>();
+  for (auto i = 0; i < numberOfRecords; i++) {
+    auto key = static_cast<int32_t>(randomGenerator() % 1000);
+    keys.push_back(key);
+    gsl::byte record[3] = {static_cast<gsl::byte>(key >> 8),
+                           static_cast<gsl::byte>(key & 0xff),
+                           static_cast<gsl::byte>(i % 256)};
+    sorter.add(record);
+  }
+  sorter.sort();
+  std::sort(keys.begin(), keys.end());
+
+  auto result = std::vector<int32_t>();
+  while (auto record = sorter.next()) {
+    result.push_back((static_cast<int32_t>(record[0]) << 8) |
+                     static_cast<int32_t>(record[1]));
+  }
+
+  ASSERT_EQ(sorter.getNumberOfRecords(), numberOfRecords) << "FAIL";
+  ASSERT_EQ(result, keys) << "FAIL";
+}
@@ -30,13 +30,22 @@
 #include "pemc/basic/model_capacity.h"
 #include "pemc/basic/raw_memory.h"
 #include "pemc/basic/tsc_index.h"
+#include "pemc/executable_model/model_executor.h"
 #include "pemc/executable_model/temporary_state_storage.h"
 #include "pemc/formula/formula.h"
 #include "pemc/generic_traverser/generic_traverser.h"
 #include "pemc/generic_traverser/i_transitions_calculator.h"
 #include "pemc/generic_traverser/traversal_transition.h"
+#include "pemc/lmc/lmc.h"
+#include "pemc/lmc_traverser/add_transitions_to_lmc_modifier.h"
+#include "pemc/lmc_traverser/lmc_choice_resolver.h"
+#include "pemc/lmc_traverser/merge_identical_successors_modifier.h"
+#include "tests/basic/allocationCounter.h"
+#include "tests/simpleExecutableModel/simpleFormula.h"
+#include "tests/simpleExecutableModel/simpleModel.h"
 
 using namespace pemc;
+using namespace pemc::simple;
 
 namespace {
 using namespace pemc;
@@ -198,3 +207,162 @@ TEST(genericTraverser_test, genericTraverser_works) {
   ASSERT_EQ(getNoOfStates, 4) << "FAIL";
   ASSERT_EQ(transitionCount, 7) << "FAIL";
 }
+
+TEST(genericTraverser_test, genericTraverser_with_multiple_workers_works) {
+  auto configuration = Configuration();
+  configuration.numberOfWorkers = 4;
+  auto traverser = GenericTraverser(configuration);
+
+  auto transitionsCalculatorCreator =
+      [&configuration]() -> std::unique_ptr<HardCodedTransitionsCalculator> {
+    return std::make_unique<HardCodedTransitionsCalculator>(configuration);
+  };
+  traverser.transitionsCalculatorCreator = transitionsCalculatorCreator;
+
+  // Each worker gets its own modifier and thus its own counter.
+  auto transitionCounts = std::vector<int32_t>(configuration.numberOfWorkers);
+  auto createdModifiers = 0;
+  auto countTransitionsModifierCreator =
+      [&transitionCounts,
+       &createdModifiers]() -> std::unique_ptr<IPostStateStorageModifier> {
+    auto modifier = std::make_unique<CountTranstitionsModifier>(
+        transitionCounts[createdModifiers]);
+    createdModifiers++;
+    return modifier;
+  };
+  traverser.postStateStorageModifierCreators.push_back(
+      countTransitionsModifierCreator);
+
+  traverser.traverse(cancellation_token::none());
+
+  auto getNoOfStates = traverser.getNoOfStates();
+  auto transitionCount = 0;
+  for (auto count : transitionCounts)
+    transitionCount += count;
+
+  ASSERT_EQ(createdModifiers, configuration.numberOfWorkers) << "FAIL";
+  ASSERT_EQ(getNoOfStates, 4) << "FAIL";
+  ASSERT_EQ(transitionCount, 7) << "FAIL";
+}
+
+TEST(genericTraverser_test, genericTraverser_breadth_first_works) {
+  auto configuration = Configuration();
+  configuration.numberOfWorkers = 4;
+  configuration.traversalStrategy = TraversalStrategy::BreadthFirst;
+  auto traverser = GenericTraverser(configuration);
+
+  auto transitionsCalculatorCreator =
+      [&configuration]() -> std::unique_ptr<HardCodedTransitionsCalculator> {
+    return std::make_unique<HardCodedTransitionsCalculator>(configuration);
+  };
+  traverser.transitionsCalculatorCreator = transitionsCalculatorCreator;
+
+  auto transitionCounts = std::vector<int32_t>(configuration.numberOfWorkers);
+  auto createdModifiers = 0;
+  auto countTransitionsModifierCreator =
+      [&transitionCounts,
+       &createdModifiers]() -> std::unique_ptr<IPostStateStorageModifier> {
+    auto modifier = std::make_unique<CountTranstitionsModifier>(
+        transitionCounts[createdModifiers]);
+    createdModifiers++;
+    return modifier;
+  };
+  traverser.postStateStorageModifierCreators.push_back(
+      countTransitionsModifierCreator);
+
+  traverser.traverse(cancellation_token::none());
+
+  auto transitionCount = 0;
+  for (auto count : transitionCounts)
+    transitionCount += count;
+
+  // Layers: {112}, {1, 5}, {3}
+  ASSERT_EQ(traverser.getNoOfStates(), 4) << "FAIL";
+  ASSERT_EQ(transitionCount, 7) << "FAIL";
+  ASSERT_EQ(traverser.getNumberOfLayers(), 3) << "FAIL";
+  ASSERT_EQ(traverser.getStateDepth(0), 0) << "FAIL";
+  ASSERT_EQ(traverser.getStateDepth(1), 1) << "FAIL";
+  ASSERT_EQ(traverser.getStateDepth(2), 1) << "FAIL";
+  ASSERT_EQ(traverser.getStateDepth(3), 2) << "FAIL";
+}
+
+namespace {
+// Ring of 4096 positions. Every step advances by one or two positions, once
+// through a redundant choice, so the merge modifier has work to do.
+class BranchingRingModel : public SimpleModel {
+  virtual void step() {
+    auto redundantChoice = choose({0, 1});
+    auto advance = redundantChoice + choose({1, 2});
+    setState((getState() + advance) % 4096);
+  }
+};
+
+// Records the number of heap allocations of the worker thread after each
+// expansion. The records are reserved in advance.
+class RecordAllocationsModifier : public IPostStateStorageModifier {
+ public:
+  std::vector<int64_t>& allocations;
+
+  RecordAllocationsModifier(std::vector<int64_t>& _allocations)
+      : allocations(_allocations) {}
+
+  virtual void applyOnTransitions(std::optional<StateIndex> stateIndexOfSource,
+                                  gsl::span<TraversalTransition> transitions,
+                                  void* customPayLoad) {
+    if (allocations.size() < allocations.capacity())
+      allocations.push_back(pemc::tests::getNumberOfAllocationsOfThisThread());
+  }
+};
+}  // namespace
+
+TEST(genericTraverser_test, genericTraverser_does_not_allocate_in_steady_state) {
+  // A single depth-first worker runs on this thread. The capacities are fixed,
+  // so the state storage and the Lmc do not grow.
+  auto configuration = Configuration();
+  auto capacity = std::make_shared<ModelCapacityByModelSize>();
+  capacity->setMaximalStates(1 << 14);
+  capacity->setMaximalTargets(1 << 16);
+  capacity->setMaximalChoices(1 << 16);
+  configuration.modelCapacity = capacity;
+  configuration.maximalSearchDepth = 1 << 14;
+
+  auto formulas = std::vector<std::shared_ptr<Formula>>(
+      {std::make_shared<SimpleFormula>(
+          [](SimpleModel* model) { return model->getState() == 0; }, "f")});
+  auto lmc = Lmc();
+  lmc.initialize(*capacity);
+
+  auto traverser = GenericTraverser(configuration);
+  traverser.transitionsCalculatorCreator =
+      [&configuration, &formulas]() -> std::unique_ptr<ITransitionsCalculator> {
+    auto modelExecutor = std::make_unique<ModelExecutor>(configuration);
+    auto model = std::make_unique<BranchingRingModel>();
+    model->setFormulasForLabel(formulas);
+    modelExecutor->setModel(std::move(model));
+    modelExecutor->setChoiceResolver(std::make_unique<LmcChoiceResolver>());
+    return modelExecutor;
+  };
+  traverser.preStateStorageModifierCreators.push_back(
+      []() -> std::unique_ptr<IPreStateStorageModifier> {
+        return std::make_unique<MergeIdenticalSuccessorsModifier>();
+      });
+  traverser.postStateStorageModifierCreators.push_back(
+      [&lmc]() -> std::unique_ptr<IPostStateStorageModifier> {
+        return std::make_unique<AddTransitionsToLmcModifier>(&lmc);
+      });
+  auto allocations = std::vector<int64_t>();
+  allocations.reserve(4096 + 1);
+  traverser.postStateStorageModifierCreators.push_back(
+      [&allocations]() -> std::unique_ptr<IPostStateStorageModifier> {
+        return std::make_unique<RecordAllocationsModifier>(allocations);
+      });
+
+  traverser.traverse(cancellation_token::none());
+
+  // The initial transitions and the expansion of each position.
+  ASSERT_EQ(traverser.getNoOfStates(), 4096) << "FAIL";
+  ASSERT_EQ(allocations.size(), 4096 + 1) << "FAIL";
+  // The buffers of the worker grow during the first expansions only.
+  auto firstSteadyExpansion = 16;
+  ASSERT_EQ(allocations.back(), allocations[firstSteadyExpansion]) << "FAIL";
+}
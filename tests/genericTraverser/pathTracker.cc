@@ -23,6 +23,9 @@
 
 #include<gtest/gtest.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "pemc/generic_traverser/path_tracker.h"
 
 using namespace pemc;
@@ -158,3 +161,37 @@ TEST(genericTraverser_test, pathTracker_space_gets_reused) {
     ASSERT_EQ(get2, 5) << "FAIL";
     ASSERT_EQ(get2success, true) << "FAIL";
 }
+
+
+TEST(genericTraverser_test, pathTracker_splitWork_works) {
+    auto pathTracker = PathTracker(5000);
+    pathTracker.pushFrame();
+    pathTracker.pushStateIndex(1);
+    pathTracker.pushStateIndex(5);
+    pathTracker.pushStateIndex(8);
+    pathTracker.pushStateIndex(13);
+
+    auto otherPathTracker = PathTracker(5000);
+    auto splitSuccess = pathTracker.splitWork(otherPathTracker);
+
+    // collect all states of both path trackers; no state may get lost or
+    // be duplicated.
+    auto states = std::vector<StateIndex>();
+    StateIndex state;
+    while (pathTracker.tryGetStateIndex(state)) {
+      states.push_back(state);
+      pathTracker.pushFrame();
+    }
+    auto statesOfThis = states.size();
+    while (otherPathTracker.tryGetStateIndex(state)) {
+      states.push_back(state);
+      otherPathTracker.pushFrame();
+    }
+    auto statesOfOther = states.size() - statesOfThis;
+    std::sort(states.begin(), states.end());
+
+    ASSERT_EQ(splitSuccess, true) << "FAIL";
+    ASSERT_GT(statesOfThis, 0) << "FAIL";
+    ASSERT_GT(statesOfOther, 0) << "FAIL";
+    ASSERT_EQ(states, (std::vector<StateIndex>{1, 5, 8, 13})) << "FAIL";
+}
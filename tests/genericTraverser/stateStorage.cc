@@ -23,6 +23,10 @@
 
 #include<gtest/gtest.h>
 
+#include <cstring>
+#include <vector>
+
+#include "pemc/generic_traverser/lossy_state_storage.h"
 #include "pemc/generic_traverser/state_storage.h"
 
 using namespace pemc;
@@ -63,3 +67,108 @@ TEST(genericTraverser_test, stateStorage_works_with_intSized_model) {
     ASSERT_EQ(firstStateAgainAddSuccess, false) << "FAIL";
     ASSERT_EQ(firstStateAgainIndex, 0) << "FAIL";
 }
+
+TEST(genericTraverser_test, stateStorage_grows_and_keeps_indexes) {
+    auto stateVectorSize = sizeof(int32_t);
+    auto preStateStorageModifierStateVectorSize = 0;
+    auto initialCapacity = 1024;
+    auto maximalCapacity = 1 << 20;
+    auto numberOfStates = 100000;
+
+    StateStorage stateStorage{initialCapacity, maximalCapacity};
+    stateStorage.setStateVectorSize(stateVectorSize, preStateStorageModifierStateVectorSize);
+    stateStorage.clear();
+    auto reservedIndex = stateStorage.reserveStateIndex();
+
+    for (auto i = int32_t(0); i < numberOfStates; i++) {
+      auto state = i;
+      StateIndex stateIndex = -1;
+      auto addSuccess = stateStorage.addState(reinterpret_cast<gsl::byte*>(&state), stateIndex);
+      ASSERT_EQ(addSuccess, true) << "FAIL";
+      ASSERT_EQ(stateIndex, i + 1) << "FAIL";
+    }
+
+    // all states are found again under their original index
+    for (auto i = int32_t(0); i < numberOfStates; i++) {
+      auto state = i;
+      StateIndex stateIndex = -1;
+      auto addSuccess = stateStorage.addState(reinterpret_cast<gsl::byte*>(&state), stateIndex);
+      ASSERT_EQ(addSuccess, false) << "FAIL";
+      ASSERT_EQ(stateIndex, i + 1) << "FAIL";
+      ASSERT_EQ(*reinterpret_cast<int32_t*>(stateStorage[stateIndex].data()), i) << "FAIL";
+    }
+
+    ASSERT_EQ(reservedIndex, 0) << "FAIL";
+    ASSERT_EQ(stateStorage.getNumberOfSavedStates(), numberOfStates + 1) << "FAIL";
+    ASSERT_GT(stateStorage.getCapacity(), initialCapacity) << "FAIL";
+    ASSERT_LE(stateStorage.getCapacity(), maximalCapacity) << "FAIL";
+}
+
+TEST(genericTraverser_test, stateStorage_works_with_compressed_states) {
+    // wide states, which differ only in two words
+    auto wordsPerState = 61;
+    auto stateVectorSize = wordsPerState * sizeof(int32_t);
+    auto preStateStorageModifierStateVectorSize = 0;
+    auto capacity = 1 << 14;
+    auto numberOfStates = 10000;
+
+    StateStorage stateStorage{capacity, capacity, int64_t(capacity) * 4};
+    stateStorage.setStateVectorSize(stateVectorSize, preStateStorageModifierStateVectorSize);
+    stateStorage.clear();
+
+    auto createState = [wordsPerState](int32_t i) {
+      auto state = std::vector<int32_t>(wordsPerState, 7);
+      state[3] = i % 100;
+      state[wordsPerState - 1] = i / 100;
+      return state;
+    };
+
+    for (auto i = int32_t(0); i < numberOfStates; i++) {
+      auto state = createState(i);
+      StateIndex stateIndex = -1;
+      auto addSuccess = stateStorage.addState(reinterpret_cast<gsl::byte*>(state.data()), stateIndex);
+      ASSERT_EQ(addSuccess, true) << "FAIL";
+      ASSERT_EQ(stateIndex, i) << "FAIL";
+    }
+
+    auto buffer = std::vector<gsl::byte>(stateVectorSize);
+    for (auto i = int32_t(0); i < numberOfStates; i++) {
+      auto state = createState(i);
+      StateIndex stateIndex = -1;
+      auto addSuccess = stateStorage.addState(reinterpret_cast<gsl::byte*>(state.data()), stateIndex);
+      ASSERT_EQ(addSuccess, false) << "FAIL";
+      ASSERT_EQ(stateIndex, i) << "FAIL";
+      auto storedState = stateStorage.getState(stateIndex, buffer);
+      ASSERT_EQ(storedState.size(), stateVectorSize) << "FAIL";
+      ASSERT_EQ(std::memcmp(storedState.data(), state.data(), stateVectorSize), 0) << "FAIL";
+    }
+
+    // uncompressed, the states would need 10000*244 bytes
+    ASSERT_EQ(stateStorage.isCompressed(), true) << "FAIL";
+    ASSERT_LT(stateStorage.getStateMemoryUsage(), int64_t(numberOfStates) * stateVectorSize) << "FAIL";
+}
+
+TEST(genericTraverser_test, lossyStateStorage_detects_duplicates) {
+    for (auto type : {StateStorageType::Bitstate, StateStorageType::HashCompaction}) {
+      LossyStateStorage stateStorage{type, 1 << 16, 3, 1024};
+      stateStorage.setStateVectorSize(sizeof(int32_t), 0);
+      stateStorage.clear();
+
+      auto firstState = int32_t(55);
+      StateIndex firstStateIndex = -1;
+      auto firstAddSuccess = stateStorage.addState(reinterpret_cast<gsl::byte*>(&firstState), firstStateIndex);
+      auto buffer = std::vector<gsl::byte>(sizeof(int32_t));
+      auto storedFirstState = *reinterpret_cast<int32_t*>(stateStorage.getState(firstStateIndex, buffer).data());
+      stateStorage.releaseState(firstStateIndex);
+
+      StateIndex firstStateAgainIndex = -1;
+      auto firstStateAgainAddSuccess = stateStorage.addState(reinterpret_cast<gsl::byte*>(&firstState), firstStateAgainIndex);
+
+      ASSERT_EQ(firstAddSuccess, true) << "FAIL";
+      ASSERT_EQ(storedFirstState, 55) << "FAIL";
+      ASSERT_EQ(firstStateAgainAddSuccess, false) << "FAIL";
+      ASSERT_EQ(stateStorage.getNumberOfSavedStates(), 1) << "FAIL";
+      ASSERT_GT(stateStorage.getOmissionProbability(), -0.0000001) << "FAIL";
+      ASSERT_LT(stateStorage.getOmissionProbability(), 0.0000001) << "FAIL";
+    }
+}
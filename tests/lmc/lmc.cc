@@ -24,6 +24,8 @@
 #include<gtest/gtest.h>
 
 #include "pemc/lmc/lmc.h"
+#include "pemc/lmc/lmc_columns.h"
+#include "pemc/basic/exceptions.h"
 
 #include "tests/lmc/lmcExamples.h"
 
@@ -55,3 +57,99 @@ TEST(lmc_test, lmc_createLabelBasedFormulaEvaluator_works) {
 
     ASSERT_EQ(resultOfFirstTransitionOfState3, true) << "FAIL";
 }
+
+TEST(lmc_test, lmcColumns_contain_transitions_in_state_order) {
+    LmcExample2 example{};
+    auto& lmc = example.lmc;
+    LmcColumns columns(lmc);
+
+    ASSERT_EQ(columns.getStateCount(), 3) << "FAIL";
+    ASSERT_EQ(columns.getTransitionCount(), lmc.getTransitions().size()) << "FAIL";
+
+    auto probabilities = columns.getProbabilities();
+    auto targets = columns.getTargets();
+    auto labels = columns.getLabels();
+    auto compareRow = [&](gsl::span<LmcTransitionEntry> expected,
+                          TransitionIndex begin, TransitionIndex end) {
+      ASSERT_EQ(end - begin, expected.size()) << "FAIL";
+      for (auto t = begin; t < end; t++) {
+        auto& transition = expected[t - begin];
+        ASSERT_EQ(probabilities[t].value, transition.probability.value) << "FAIL";
+        ASSERT_EQ(targets[t], transition.state) << "FAIL";
+        ASSERT_EQ(labels[t].value, transition.label.value) << "FAIL";
+      }
+    };
+
+    TransitionIndex begin, end = 0;
+    TransitionIndex expectedBegin = 0;
+    for (StateIndex s = 0; s < 3; s++) {
+      std::tie(begin, end) = columns.getTransitionIndexesOfState(s);
+      ASSERT_EQ(begin, expectedBegin) << "FAIL";
+      compareRow(lmc.getTransitionsOfState(s), begin, end);
+      expectedBegin = end;
+    }
+    std::tie(begin, end) = columns.getInitialTransitionIndexes();
+    ASSERT_EQ(begin, expectedBegin) << "FAIL";
+    compareRow(lmc.getInitialTransitions(), begin, end);
+}
+
+TEST(lmc_test, lmcColumns_are_copied_once_per_lmc) {
+    LmcExample2 example{};
+    auto& lmc = example.lmc;
+
+    auto& columns = lmc.getColumns();
+    ASSERT_EQ(&lmc.getColumns(), &columns) << "FAIL";
+    ASSERT_EQ(columns.getStateCount(), 3) << "FAIL";
+    ASSERT_EQ(columns.getTransitionCount(), lmc.getTransitions().size()) << "FAIL";
+}
+
+TEST(lmc_test, lmc_throws_if_transition_capacity_is_exceeded) {
+    auto capacity = ModelCapacityByModelSize::Small();
+    capacity.setMaximalTargets(4);
+    Lmc lmc;
+    lmc.initialize(capacity);
+
+    ASSERT_EQ(lmc.getPlaceForNewInitialTransitionEntries(3), 0) << "FAIL";
+    ASSERT_THROW(lmc.getPlaceForNewTransitionEntriesOfState(0, 2), OutOfMemoryException) << "FAIL";
+}
+
+TEST(lmc_test, lmc_grows_from_initial_capacity) {
+    // Chain 0 -> 1 -> ... -> n-1, where the last state loops. The initial
+    // capacity holds only a few states and transitions.
+    auto capacity = ModelCapacityByModelSize::Small();
+    capacity.setInitialStates(16);
+    capacity.setInitialTargets(16);
+    Lmc lmc;
+    lmc.initialize(capacity);
+    lmc.setLabelIdentifier(std::vector<std::string>());
+
+    const StateIndex stateCount = 1000;
+    auto initialEntry = lmc.getPlaceForNewInitialTransitionEntries(1);
+    lmc.setLmcTransitionEntry(initialEntry, LmcTransitionEntry(Probability::One(), Label(), 0));
+    for (StateIndex state = 0; state < stateCount; state++) {
+        auto target = state + 1 < stateCount ? state + 1 : state;
+        auto entry = lmc.getPlaceForNewTransitionEntriesOfState(state, 1);
+        lmc.setLmcTransitionEntry(entry, LmcTransitionEntry(Probability::One(), Label(), target));
+    }
+    lmc.finishCreation(stateCount);
+    lmc.validate();
+
+    ASSERT_EQ(lmc.getStates().size(), stateCount) << "FAIL";
+    ASSERT_EQ(lmc.getTransitions().size(), stateCount + 1) << "FAIL";
+    ASSERT_EQ(lmc.getInitialTransitions()[0].state, 0) << "FAIL";
+    for (StateIndex state = 0; state < stateCount; state++) {
+        auto transitions = lmc.getTransitionsOfState(state);
+        ASSERT_EQ(transitions.size(), 1) << "FAIL";
+        ASSERT_EQ(transitions[0].state, state + 1 < stateCount ? state + 1 : state) << "FAIL";
+    }
+}
+
+TEST(lmc_test, lmc_index_types_have_configured_size) {
+#ifdef PEMC_LARGE_INDEXES
+    ASSERT_EQ(sizeof(StateIndex), 8) << "FAIL";
+    ASSERT_EQ(sizeof(TransitionIndex), 8) << "FAIL";
+#else
+    ASSERT_EQ(sizeof(StateIndex), 4) << "FAIL";
+    ASSERT_EQ(sizeof(TransitionIndex), 4) << "FAIL";
+#endif
+}
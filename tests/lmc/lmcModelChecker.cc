@@ -23,8 +23,11 @@
 
 #include<gtest/gtest.h>
 
+#include "pemc/basic/ThrowAssert.hpp"
 #include "pemc/formula/binary_formula.h"
+#include "pemc/formula/bounded_binary_formula.h"
 #include "pemc/formula/bounded_unary_formula.h"
+#include "pemc/formula/unary_formula.h"
 #include "pemc/lmc/lmc_model_checker.h"
 
 #include "tests/lmc/lmcExamples.h"
@@ -78,3 +81,106 @@ TEST(lmcModelChecker_test, check_simple_formula_2) {
 
     ASSERT_EQ(probabilityIsAround(result200, 0.91, 0.000001), true) << "FAIL";
 }
+
+
+TEST(lmcModelChecker_test, check_bounded_until) {
+    LmcExample2 example{};
+    auto& lmc = example.lmc;
+
+    auto settings = { std::make_tuple(LmcMatrixFormat::Csr, 1),
+                      std::make_tuple(LmcMatrixFormat::SellCSigma, 1),
+                      std::make_tuple(LmcMatrixFormat::Csr, 3),
+                      std::make_tuple(LmcMatrixFormat::SellCSigma, 3) };
+    for (auto setting : settings) {
+      auto configuration = Configuration();
+      configuration.lmcMatrixFormat = std::get<0>(setting);
+      configuration.lmcModelCheckingThreads = std::get<1>(setting);
+      auto mc = LmcModelChecker(lmc, configuration);
+
+      // Paths through the f1-transition 0->1 are excluded.
+      auto not_f1 = std::make_shared<UnaryFormula>(example.f1,UnaryOperator::Not);
+      auto not_f1_until_f2_in_i = [&](int i) {
+        auto formula = std::make_shared<BoundedBinaryFormula>(not_f1,BinaryOperator::Until,example.f2,i);
+        return mc.calculateProbability(*formula);
+      };
+
+      ASSERT_EQ(probabilityIsAround(not_f1_until_f2_in_i(1), 0.1, 0.000001), true) << "FAIL";
+      ASSERT_EQ(probabilityIsAround(not_f1_until_f2_in_i(2), 0.1 + 0.6*0.09, 0.000001), true) << "FAIL";
+      ASSERT_EQ(probabilityIsAround(not_f1_until_f2_in_i(200), 0.1 + 0.6*0.9, 0.000001), true) << "FAIL";
+    }
+}
+
+
+TEST(lmcModelChecker_test, check_unbounded_until) {
+    LmcExample2 example{};
+    auto& lmc = example.lmc;
+
+    auto finally_f2 = std::make_shared<UnaryFormula>(example.f2,UnaryOperator::Finally);
+    auto not_f1 = std::make_shared<UnaryFormula>(example.f1,UnaryOperator::Not);
+    auto not_f1_until_f2 = std::make_shared<BinaryFormula>(not_f1,BinaryOperator::Until,example.f2);
+
+    auto settings = { std::make_tuple(LmcIterativeSolver::Jacobi, 1, LmcMatrixFormat::Csr),
+                      std::make_tuple(LmcIterativeSolver::Jacobi, 3, LmcMatrixFormat::Csr),
+                      std::make_tuple(LmcIterativeSolver::Jacobi, 3, LmcMatrixFormat::SellCSigma),
+                      std::make_tuple(LmcIterativeSolver::GaussSeidel, 1, LmcMatrixFormat::Csr),
+                      std::make_tuple(LmcIterativeSolver::GaussSeidel, 1, LmcMatrixFormat::SellCSigma) };
+    for (auto setting : settings) {
+      auto configuration = Configuration();
+      configuration.lmcIterativeSolver = std::get<0>(setting);
+      configuration.lmcModelCheckingThreads = std::get<1>(setting);
+      configuration.lmcMatrixFormat = std::get<2>(setting);
+      configuration.lmcAbsoluteTolerance = 1e-12;
+      auto mc = LmcModelChecker(lmc, configuration);
+
+      auto probability = mc.calculateProbability(*finally_f2);
+      auto& statistics = mc.getLastIterationStatistics();
+      ASSERT_EQ(probabilityIsAround(probability, 0.91, 0.000001), true) << "FAIL";
+      ASSERT_EQ(statistics.converged, true) << "FAIL";
+      ASSERT_LE(statistics.absoluteResidual, 1e-12) << "FAIL";
+      // The self loop of state 1 with probability 0.9 needs about
+      // log(1e-12) / log(0.9) iterations.
+      ASSERT_GT(statistics.iterations, 100) << "FAIL";
+      ASSERT_LT(statistics.iterations, 400) << "FAIL";
+
+      probability = mc.calculateProbability(*not_f1_until_f2);
+      ASSERT_EQ(probabilityIsAround(probability, 0.1 + 0.6*0.9, 0.000001), true) << "FAIL";
+    }
+}
+
+
+TEST(lmcModelChecker_test, unbounded_until_decides_probability_1_without_iterations) {
+    // 0----> 1 ----> 2⟲ f2: every state reaches f2 with probability 1.
+    LmcExample1 example{};
+    auto& lmc = example.lmc;
+    auto finally_f2 = std::make_shared<UnaryFormula>(example.f2,UnaryOperator::Finally);
+
+    auto configuration = Configuration();
+    auto mc = LmcModelChecker(lmc, configuration);
+    auto probability = mc.calculateProbability(*finally_f2);
+    auto& statistics = mc.getLastIterationStatistics();
+    ASSERT_EQ(probability.value, 1.0) << "FAIL";
+    ASSERT_EQ(statistics.converged, true) << "FAIL";
+    ASSERT_EQ(statistics.iterations, 1) << "FAIL";
+}
+
+
+TEST(lmcModelChecker_test, unbounded_until_reports_missing_convergence) {
+    LmcExample2 example{};
+    auto& lmc = example.lmc;
+    auto finally_f2 = std::make_shared<UnaryFormula>(example.f2,UnaryOperator::Finally);
+
+    auto configuration = Configuration();
+    configuration.lmcMaximalIterations = 3;
+    configuration.lmcAbsoluteTolerance = 0.0;
+    configuration.lmcRelativeTolerance = 1e-6;
+    auto mc = LmcModelChecker(lmc, configuration);
+    mc.calculateProbability(*finally_f2);
+    auto& statistics = mc.getLastIterationStatistics();
+    ASSERT_EQ(statistics.converged, false) << "FAIL";
+    ASSERT_EQ(statistics.iterations, 3) << "FAIL";
+    ASSERT_GT(statistics.relativeResidual, 1e-6) << "FAIL";
+
+    // The horizon of an Lmc does not suffice for unbounded formulas.
+    lmc.setHorizon(10);
+    ASSERT_THROW(mc.calculateProbability(*finally_f2), AssertionFailureException) << "FAIL";
+}
@@ -0,0 +1,215 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include<gtest/gtest.h>
+
+#include <random>
+
+#include "pemc/lmc/lmc_columns.h"
+#include "pemc/lmc/lmc_reduced_matrix.h"
+
+#include "tests/lmc/lmcExamples.h"
+
+using namespace pemc;
+
+namespace {
+  using namespace pemc;
+
+  // Random Lmc whose states have between 1 and 20 transitions, so that the
+  // kernels run through their vectorized loops and their remainders.
+  void createRandomLmc(Lmc& lmc, StateIndex stateCount, std::mt19937& random) {
+    auto capacity = ModelCapacityByModelSize::Small();
+    lmc.initialize(capacity);
+    lmc.setLabelIdentifier(std::vector<std::string> {"f1", "f2"});
+
+    auto targetDistribution = std::uniform_int_distribution<StateIndex>(0, stateCount - 1);
+    auto addTransitions = [&](TransitionIndex location, NoOfElements number) {
+      for (auto i = 0; i < number; i++) {
+        lmc.setLmcTransitionEntry(location + i,
+          LmcTransitionEntry(Probability(1.0 / number), Label(), targetDistribution(random)));
+      }
+    };
+    addTransitions(lmc.getPlaceForNewInitialTransitionEntries(3), 3);
+    auto numberDistribution = std::uniform_int_distribution<NoOfElements>(1, 20);
+    for (StateIndex s = 0; s < stateCount; s++) {
+      auto number = numberDistribution(random);
+      addTransitions(lmc.getPlaceForNewTransitionEntriesOfState(s, number), number);
+    }
+    lmc.finishCreation(stateCount);
+    lmc.validate();
+  }
+}
+
+TEST(lmcReducedMatrix_test, rows_of_decided_states_are_omitted) {
+    // 0----> 1 ----> 2⟲ with all transitions into 2 satisfied: only the
+    // transition 0->1 remains undecided and state 2 is never read.
+    LmcExample1 example{};
+    LmcColumns columns(example.lmc);
+
+    auto precalculations = std::vector<PrecalculatedTransition>(
+      columns.getTransitionCount(), PrecalculatedTransition::Nothing);
+    for (TransitionIndex t = 0; t < columns.getTransitionCount(); t++) {
+      if (columns.getTargets()[t] == 2)
+        precalculations[t] = PrecalculatedTransition::Satisfied;
+    }
+
+    LmcReducedMatrix matrix(columns, precalculations);
+
+    ASSERT_EQ(matrix.getRowCount(), 2) << "FAIL";
+    ASSERT_EQ(matrix.getNonZeroCount(), 1) << "FAIL";
+    ASSERT_EQ(matrix.getRowOfState()[2], -1) << "FAIL";
+    ASSERT_EQ(matrix.getConstants()[0].value, 0.0) << "FAIL";
+    ASSERT_EQ(matrix.getConstants()[1].value, 1.0) << "FAIL";
+
+    auto x = std::vector<Probability>(2, Probability::Zero());
+    auto xnew = std::vector<Probability>(2, Probability::Zero());
+    matrix.multiplyAndAdd(x, xnew);
+    ASSERT_EQ(matrix.calculateInitialProbability(xnew).value, 0.0) << "FAIL";
+    matrix.multiplyAndAdd(xnew, x);
+    ASSERT_EQ(matrix.calculateInitialProbability(x).value, 1.0) << "FAIL";
+}
+
+TEST(lmcReducedMatrix_test, excluded_transitions_are_dropped) {
+    LmcExample2 example{};
+    LmcColumns columns(example.lmc);
+
+    auto precalculations = std::vector<PrecalculatedTransition>(
+      columns.getTransitionCount(), PrecalculatedTransition::Excluded);
+
+    LmcReducedMatrix matrix(columns, precalculations);
+
+    ASSERT_EQ(matrix.getRowCount(), 0) << "FAIL";
+    ASSERT_EQ(matrix.getNonZeroCount(), 0) << "FAIL";
+    ASSERT_EQ(matrix.calculateInitialProbability({}).value, 0.0) << "FAIL";
+}
+
+TEST(lmcReducedMatrix_test, all_formats_and_kernels_agree_with_the_columns) {
+    std::mt19937 random(42);
+    Lmc lmc;
+    StateIndex stateCount = 300;
+    createRandomLmc(lmc, stateCount, random);
+    LmcColumns columns(lmc);
+
+    auto precalculations = std::vector<PrecalculatedTransition>(columns.getTransitionCount());
+    auto kindDistribution = std::uniform_int_distribution<int>(0, 9);
+    for (auto& precalculated : precalculations) {
+      auto kind = kindDistribution(random);
+      precalculated = kind == 0 ? PrecalculatedTransition::Satisfied :
+                      kind == 1 ? PrecalculatedTransition::Excluded :
+                                  PrecalculatedTransition::Nothing;
+    }
+
+    // Reference: iterate on the columns of all states.
+    const auto iterations = 6;
+    auto expected = std::vector<double>(stateCount, 0.0);
+    auto probabilities = columns.getProbabilities();
+    auto targets = columns.getTargets();
+    for (auto i = 0; i < iterations; i++) {
+      auto next = std::vector<double>(stateCount, 0.0);
+      for (StateIndex s = 0; s < stateCount; s++) {
+        TransitionIndex begin, end = 0;
+        std::tie(begin, end) = columns.getTransitionIndexesOfState(s);
+        for (auto t = begin; t < end; t++) {
+          if (precalculations[t] == PrecalculatedTransition::Satisfied)
+            next[s] += probabilities[t].value;
+          else if (precalculations[t] == PrecalculatedTransition::Nothing)
+            next[s] += probabilities[t].value * expected[targets[t]];
+        }
+      }
+      expected = next;
+    }
+
+    auto instructionSets = { SimdInstructionSet::Scalar, SimdInstructionSet::Avx2, SimdInstructionSet::Avx512 };
+    auto formats = { std::make_tuple(LmcMatrixFormat::Csr, 1),
+                     std::make_tuple(LmcMatrixFormat::SellCSigma, 1),
+                     std::make_tuple(LmcMatrixFormat::SellCSigma, 32) };
+    for (auto instructionSet : instructionSets) {
+      if (!isSimdInstructionSetSupported(instructionSet))
+        continue;
+      for (auto format : formats) {
+        LmcReducedMatrix matrix(columns, precalculations, std::get<0>(format), std::get<1>(format));
+        matrix.setSimdInstructionSet(instructionSet);
+        ASSERT_GT(matrix.getNonZeroCount(), 0) << "FAIL";
+
+        auto x = std::vector<Probability>(matrix.getVectorSize(), Probability::Zero());
+        auto xnew = x;
+        for (auto i = 0; i < iterations; i++) {
+          matrix.multiplyAndAdd(x, xnew);
+          std::swap(x, xnew);
+        }
+
+        for (StateIndex s = 0; s < stateCount; s++) {
+          auto row = matrix.getRowOfState()[s];
+          if (row != -1) {
+            ASSERT_NEAR(x[row].value, expected[s], 1e-12)
+              << simdInstructionSetToString(instructionSet) << " state " << s;
+          }
+        }
+      }
+    }
+}
+
+TEST(lmcReducedMatrix_test, partitions_are_balanced_and_placement_keeps_the_matrix) {
+    std::mt19937 random(7);
+    Lmc lmc;
+    StateIndex stateCount = 300;
+    createRandomLmc(lmc, stateCount, random);
+    LmcColumns columns(lmc);
+    auto precalculations = std::vector<PrecalculatedTransition>(
+      columns.getTransitionCount(), PrecalculatedTransition::Nothing);
+    precalculations[0] = PrecalculatedTransition::Satisfied;
+
+    auto threadPool = ThreadPool(4);
+    for (auto format : { LmcMatrixFormat::Csr, LmcMatrixFormat::SellCSigma }) {
+      // The reference keeps its CSR arrays to count the entries of the rows.
+      LmcReducedMatrix matrix(columns, precalculations, format, 256, true);
+      LmcReducedMatrix placedMatrix(columns, precalculations, format);
+      ASSERT_EQ(placedMatrix.hasCsrArrays(), format == LmcMatrixFormat::Csr) << "FAIL";
+      ASSERT_EQ(placedMatrix.getNonZeroCount(), matrix.getNonZeroCount()) << "FAIL";
+      auto partitions = placedMatrix.partitionRows(4);
+      ASSERT_EQ(partitions.size(), 5) << "FAIL";
+      ASSERT_EQ(partitions.front(), 0) << "FAIL";
+      ASSERT_EQ(partitions.back(), matrix.getRowCount()) << "FAIL";
+
+      // Each partition has about a quarter of the entries. Rows have at most
+      // 20 entries, chunks at most 8 * 20.
+      auto rowOffsets = matrix.getRowOffsets();
+      for (auto i = 0; i < 4; i++) {
+        ASSERT_EQ(partitions[i] == matrix.getRowCount() ||
+                  partitions[i] % matrix.getRowAlignment() == 0, true) << "FAIL";
+        ASSERT_LE(partitions[i], partitions[i + 1]) << "FAIL";
+        auto entries = rowOffsets[partitions[i + 1]] - rowOffsets[partitions[i]];
+        ASSERT_NEAR(entries, matrix.getNonZeroCount() / 4.0, 2 * 8 * 20) << "FAIL";
+      }
+
+      placedMatrix.placeInMemory(threadPool, partitions);
+      auto x = std::vector<Probability>(matrix.getVectorSize(), Probability(0.5));
+      auto expected = x;
+      auto result = x;
+      matrix.multiplyAndAdd(x, expected);
+      for (auto i = 0; i < 4; i++)
+        placedMatrix.multiplyAndAdd(x, result, partitions[i], partitions[i + 1]);
+      for (StateIndex r = 0; r < matrix.getRowCount(); r++)
+        ASSERT_EQ(result[r].value, expected[r].value) << "FAIL";
+    }
+}
@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: MIT
+// The MIT License (MIT)
+//
+// Copyright (c) 2014-2018, Institute for Software & Systems Engineering
+// Copyright (c) 2018-2019, Johannes Leupolz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <iostream>
+
+#include "pemc/basic/label.h"
+#include "pemc/basic/probability.h"
+#include "pemc/generic_traverser/traversal_transition.h"
+#include "pemc/lmc_traverser/merge_identical_successors_modifier.h"
+
+using namespace pemc;
+
+TEST(lmcTraverser_test, mergeIdenticalSuccessors_works) {
+  auto modifier = MergeIdenticalSuccessorsModifier(sizeof(int32_t));
+
+  auto targets = std::vector<int32_t>{7, 8, 7, 7, 9, 9};
+  auto labels = std::vector<bool>{false, false, false, true, false, false};
+  auto transitions = std::vector<TraversalTransition>();
+  auto transitionProbabilities = std::vector<Probability>();
+  for (size_t i = 0; i < targets.size(); ++i) {
+    auto transition = TraversalTransition(
+        reinterpret_cast<gsl::byte*>(&targets[i]),
+        Label(std::vector<bool>{labels[i]}));
+    transitions.push_back(transition);
+    transitionProbabilities.push_back(Probability(0.1 + 0.01 * i));
+  }
+  // Transitions to the stuttering state are merged by their label.
+  transitions[5].flags |= TraversalTransitionFlags::IsToStutteringState;
+  auto stutteringTransition = transitions[5];
+  stutteringTransition.targetState = reinterpret_cast<gsl::byte*>(&targets[1]);
+  transitions.push_back(stutteringTransition);
+  transitionProbabilities.push_back(Probability(0.2));
+
+  // act
+  modifier.applyOnTransitions(
+      std::make_optional(0), gsl::span<TraversalTransition>(transitions),
+      static_cast<void*>(transitionProbabilities.data()));
+
+  // assert
+  auto isInvalid = [&transitions](size_t i) {
+    return (transitions[i].flags &
+            TraversalTransitionFlags::IsTransitionInvalid) != 0;
+  };
+  ASSERT_EQ(isInvalid(0), false) << "FAIL";
+  ASSERT_EQ(isInvalid(1), false) << "FAIL";
+  ASSERT_EQ(isInvalid(2), true) << "FAIL";
+  ASSERT_EQ(isInvalid(3), false) << "FAIL";
+  ASSERT_EQ(isInvalid(4), false) << "FAIL";
+  ASSERT_EQ(isInvalid(5), false) << "FAIL";
+  ASSERT_EQ(isInvalid(6), true) << "FAIL";
+  ASSERT_EQ(probabilityIsAround(transitionProbabilities[0], 0.1 + 0.12, 0.0000001), true) << "FAIL";
+  ASSERT_EQ(probabilityIsAround(transitionProbabilities[3], 0.13, 0.0000001), true) << "FAIL";
+  ASSERT_EQ(probabilityIsAround(transitionProbabilities[5], 0.15 + 0.2, 0.0000001), true) << "FAIL";
+}
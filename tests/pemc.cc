@@ -25,6 +25,8 @@
 #include <iostream>
 
 #include "pemc/executable_model/model_executor.h"
+#include "pemc/formula/bounded_unary_formula.h"
+#include "pemc/formula/unary_formula.h"
 #include "pemc/lmc_traverser/lmc_choice_resolver.h"
 #include "pemc/pemc.h"
 
@@ -54,9 +56,8 @@ namespace {
   auto sourceStatePtr = reinterpret_cast<int32_t*>(sourceState.data());
 }
 
-TEST(pemc_test, pemc_test) {
-    auto configuration = Configuration();
-
+namespace {
+  void checkTestModel(const Configuration& configuration) {
     auto modelCreator = [](){ return std::make_unique<TestModel>(); };
 
     auto pemc = Pemc(configuration);
@@ -70,5 +71,278 @@ TEST(pemc_test, pemc_test) {
     ASSERT_EQ(lmc->getStates().size(), 2) << "FAIL";
     ASSERT_EQ(probabilityIsAround(probability1, 0.5, 0.0001), true) << "FAIL";
     ASSERT_EQ(probabilityIsOne(probability2, 0.0001), true) << "FAIL";
+  }
+}
+
+TEST(pemc_test, pemc_test) {
+    checkTestModel(Configuration());
+}
+
+TEST(pemc_test, pemc_with_multiple_workers_test) {
+    auto configuration = Configuration();
+    configuration.numberOfWorkers = 4;
+    checkTestModel(configuration);
+}
+
+namespace {
+  // Random walk on a ring of 500 states.
+  class RingModel : public SimpleModel {
+    virtual void step() {
+      setState( (getState() + choose( {1, 2, 499} )) % 500 );
+    }
+  };
+
+  auto onRingEnd = std::make_shared<SimpleFormula>([](SimpleModel* model) { return model->getState() == 250; }, "onRingEnd" );
+  auto onRingPosition100 = std::make_shared<SimpleFormula>([](SimpleModel* model) { return model->getState() == 100; }, "onRingPosition100" );
+  auto inUpperHalf = std::make_shared<SimpleFormula>([](SimpleModel* model) { return model->getState() >= 250; }, "inUpperHalf" );
+
+  std::unique_ptr<AbstractModel> createRingModel() {
+    return std::make_unique<RingModel>();
+  }
+
+  // The reference configuration for the ring model.
+  Configuration createRingConfiguration() {
+    auto configuration = Configuration();
+    configuration.modelCapacity = std::make_shared<ModelCapacityByModelSize>(ModelCapacityByModelSize::Normal());
+    return configuration;
+  }
+
+  // Builds the Lmc of the ring model with the reference configuration and
+  // with variant. Expects both to have the same states and transitions and
+  // the same probability to reach formula within bound. Returns the Lmc
+  // built with variant.
+  std::unique_ptr<Lmc> expectSameRingLmcAs(const Configuration& variant,
+                                           std::shared_ptr<Formula> formula,
+                                           int32_t bound) {
+    auto ringFormulas = std::vector<std::shared_ptr<Formula>>( {formula} );
+    auto pemc = Pemc(createRingConfiguration());
+    auto lmc = pemc.buildLmcFromExecutableModel(createRingModel, ringFormulas);
+    auto probability = pemc.calculateProbabilityToReachStateWithinBound(*lmc, formula, bound);
+
+    auto variantPemc = Pemc(variant);
+    auto variantLmc = variantPemc.buildLmcFromExecutableModel(createRingModel, ringFormulas);
+    auto variantProbability = variantPemc.calculateProbabilityToReachStateWithinBound(*variantLmc, formula, bound);
+
+    variantLmc->validate();
+    EXPECT_EQ(lmc->getStates().size(), 500) << "FAIL";
+    EXPECT_EQ(variantLmc->getStates().size(), lmc->getStates().size()) << "FAIL";
+    EXPECT_EQ(variantLmc->getTransitions().size(), lmc->getTransitions().size()) << "FAIL";
+    EXPECT_EQ(probabilityIsAround(variantProbability, probability.value, 0.0000001), true) << "FAIL";
+    return variantLmc;
+  }
+}
+
+TEST(pemc_test, pemc_with_external_memory_traverser_test) {
+    auto externalConfiguration = createRingConfiguration();
+    externalConfiguration.useExternalMemoryTraverser = true;
+    // force several runs per layer
+    externalConfiguration.externalMemoryBufferSize = 64;
+
+    expectSameRingLmcAs(externalConfiguration, onRingEnd, 200);
+    auto externalPemc = Pemc(externalConfiguration);
+    ASSERT_EQ(externalPemc.checkReachabilityInExecutableModel(createRingModel, onRingEnd), true) << "FAIL";
+}
+
+TEST(pemc_test, pemc_with_breadth_first_traversal_test) {
+    auto breadthFirstConfiguration = createRingConfiguration();
+    breadthFirstConfiguration.traversalStrategy = TraversalStrategy::BreadthFirst;
+    breadthFirstConfiguration.numberOfWorkers = 4;
+
+    expectSameRingLmcAs(breadthFirstConfiguration, onRingEnd, 200);
+    auto breadthFirstPemc = Pemc(breadthFirstConfiguration);
+    ASSERT_EQ(breadthFirstPemc.checkReachabilityInExecutableModel(createRingModel, onRingEnd), true) << "FAIL";
+}
+
+TEST(pemc_test, pemc_with_parallel_choice_enumeration_test) {
+    auto parallelConfiguration = createRingConfiguration();
+    parallelConfiguration.choiceTreeThreads = 3;
+    parallelConfiguration.numberOfWorkers = 2;
+
+    expectSameRingLmcAs(parallelConfiguration, onRingEnd, 200);
+}
+
+TEST(pemc_test, pemc_with_horizon_test) {
+    auto configuration = createRingConfiguration();
+    auto externalConfiguration = configuration;
+    externalConfiguration.useExternalMemoryTraverser = true;
+
+    auto modelCreator = createRingModel;
+    auto ringFormulas = std::vector<std::shared_ptr<Formula>>( {onRingPosition100} );
+
+    auto pemc = Pemc(configuration);
+    auto lmc = pemc.buildLmcFromExecutableModel(modelCreator, ringFormulas);
+    auto horizonLmc = pemc.buildLmcFromExecutableModel(modelCreator, ringFormulas, 60);
+    auto externalPemc = Pemc(externalConfiguration);
+    auto externalHorizonLmc = externalPemc.buildLmcFromExecutableModel(modelCreator, ringFormulas, 60);
+
+    horizonLmc->validate();
+    externalHorizonLmc->validate();
+
+    // The states at depth 0 to 59 (60 steps, the positions -60 to 120) and the
+    // stuttering state.
+    ASSERT_EQ(horizonLmc->getStates().size(), 181 + 1) << "FAIL";
+    ASSERT_EQ(externalHorizonLmc->getStates().size(), horizonLmc->getStates().size()) << "FAIL";
+    for (auto bound : {50, 59, 60}) {
+        auto probability = pemc.calculateProbabilityToReachStateWithinBound(*lmc, onRingPosition100, bound);
+        auto horizonProbability = pemc.calculateProbabilityToReachStateWithinBound(*horizonLmc, onRingPosition100, bound);
+        auto externalHorizonProbability = pemc.calculateProbabilityToReachStateWithinBound(*externalHorizonLmc, onRingPosition100, bound);
+        ASSERT_EQ(probabilityIsAround(horizonProbability, probability.value, 0.0000001), true) << "FAIL";
+        ASSERT_EQ(probabilityIsAround(externalHorizonProbability, probability.value, 0.0000001), true) << "FAIL";
+    }
+    ASSERT_ANY_THROW(pemc.calculateProbabilityToReachStateWithinBound(*horizonLmc, onRingPosition100, 61)) << "FAIL";
+}
+
+TEST(pemc_test, pemc_with_early_termination_test) {
+    auto configuration = createRingConfiguration();
 
+    auto modelCreator = createRingModel;
+    auto ringFormulas = std::vector<std::shared_ptr<Formula>>( {onRingPosition100, inUpperHalf} );
+    auto finallyInUpperHalf = std::make_shared<UnaryFormula>(inUpperHalf, UnaryOperator::Finally);
+    auto boundedFinallyOnRingPosition100 = std::make_shared<BoundedUnaryFormula>(onRingPosition100, UnaryOperator::Finally, 150);
+
+    auto pemc = Pemc(configuration);
+    auto lmc = pemc.buildLmcFromExecutableModel(modelCreator, ringFormulas);
+    auto horizonLmc = pemc.buildLmcFromExecutableModel(modelCreator, ringFormulas, 150);
+    auto truncatedLmc = pemc.buildLmcFromExecutableModelForFormula(modelCreator, ringFormulas, finallyInUpperHalf);
+    auto truncatedHorizonLmc = pemc.buildLmcFromExecutableModelForFormula(modelCreator, ringFormulas, boundedFinallyOnRingPosition100);
+
+    truncatedLmc->validate();
+    truncatedHorizonLmc->validate();
+
+    // The positions 0 to 249 and the stuttering state.
+    ASSERT_EQ(truncatedLmc->getStates().size(), 250 + 1) << "FAIL";
+    ASSERT_LT(truncatedHorizonLmc->getStates().size(), horizonLmc->getStates().size()) << "FAIL";
+    for (auto bound : {50, 100, 150}) {
+        auto probability = pemc.calculateProbabilityToReachStateWithinBound(*lmc, inUpperHalf, bound);
+        auto truncatedProbability = pemc.calculateProbabilityToReachStateWithinBound(*truncatedLmc, inUpperHalf, bound);
+        ASSERT_EQ(probabilityIsAround(truncatedProbability, probability.value, 0.0000001), true) << "FAIL";
+        probability = pemc.calculateProbabilityToReachStateWithinBound(*lmc, onRingPosition100, bound);
+        truncatedProbability = pemc.calculateProbabilityToReachStateWithinBound(*truncatedHorizonLmc, onRingPosition100, bound);
+        ASSERT_EQ(probabilityIsAround(truncatedProbability, probability.value, 0.0000001), true) << "FAIL";
+    }
+    auto probability = pemc.calculateProbabilityToReachState(*lmc, inUpperHalf);
+    auto truncatedProbability = pemc.calculateProbabilityToReachState(*truncatedLmc, inUpperHalf);
+    ASSERT_EQ(probabilityIsAround(truncatedProbability, probability.value, 0.0000001), true) << "FAIL";
+
+    // The truncated Lmcs lack the successors needed by other formulas.
+    ASSERT_ANY_THROW(pemc.calculateProbabilityToReachStateWithinBound(*truncatedLmc, onRingPosition100, 50)) << "FAIL";
+    ASSERT_ANY_THROW(pemc.calculateProbabilityToReachState(*truncatedLmc, onRingPosition100)) << "FAIL";
+    ASSERT_ANY_THROW(pemc.calculateProbabilityToReachStateWithinBound(*truncatedHorizonLmc, inUpperHalf, 50)) << "FAIL";
+}
+
+namespace {
+  // Many paths of a step lead to the same successor.
+  class RedundantChoicesModel : public SimpleModel {
+    virtual void step() {
+      auto irrelevantFault = choose( {0, 1, 2, 3} );
+      auto next = (getState() + choose( {1, 2} )) % 10;
+      setState( irrelevantFault == 3 ? 0 : next );
+    }
+  };
+}
+
+TEST(pemc_test, pemc_with_merged_successors_test) {
+    auto configuration = Configuration();
+    auto unmergedConfiguration = configuration;
+    unmergedConfiguration.mergeIdenticalSuccessors = false;
+
+    auto modelCreator = [](){ return std::make_unique<RedundantChoicesModel>(); };
+    auto onPosition5 = std::make_shared<SimpleFormula>([](SimpleModel* model) { return model->getState() == 5; }, "onPosition5" );
+    auto positionFormulas = std::vector<std::shared_ptr<Formula>>( {onPosition5} );
+
+    auto pemc = Pemc(configuration);
+    auto lmc = pemc.buildLmcFromExecutableModel(modelCreator, positionFormulas);
+    auto unmergedPemc = Pemc(unmergedConfiguration);
+    auto unmergedLmc = unmergedPemc.buildLmcFromExecutableModel(modelCreator, positionFormulas);
+
+    lmc->validate();
+    unmergedLmc->validate();
+
+    ASSERT_EQ(lmc->getStates().size(), unmergedLmc->getStates().size()) << "FAIL";
+    ASSERT_EQ(unmergedLmc->getTransitions().size(), 8 * (10 + 1)) << "FAIL";
+    // At most the successors +1, +2 and 0 of each state.
+    ASSERT_LE(lmc->getTransitions().size(), 3 * (10 + 1)) << "FAIL";
+    for (auto bound : {5, 10, 20}) {
+        auto probability = unmergedPemc.calculateProbabilityToReachStateWithinBound(*unmergedLmc, onPosition5, bound);
+        auto mergedProbability = pemc.calculateProbabilityToReachStateWithinBound(*lmc, onPosition5, bound);
+        ASSERT_EQ(probabilityIsAround(mergedProbability, probability.value, 0.0000001), true) << "FAIL";
+    }
+}
+
+TEST(pemc_test, pemc_with_labels_per_state_test) {
+    static std::atomic<int32_t> evaluations;
+    auto countedOnRingEnd = std::make_shared<SimpleFormula>([](SimpleModel* model) {
+      evaluations++;
+      return model->getState() == 250;
+    }, "countedOnRingEnd" );
+    auto ringFormulas = std::vector<std::shared_ptr<Formula>>( {countedOnRingEnd} );
+    auto modelCreator = createRingModel;
+
+    auto configuration = createRingConfiguration();
+    evaluations = 0;
+    auto pemc = Pemc(configuration);
+    auto lmc = pemc.buildLmcFromExecutableModel(modelCreator, ringFormulas);
+    auto evaluationsPerTransition = evaluations.load();
+    auto probability = pemc.calculateProbabilityToReachStateWithinBound(*lmc, countedOnRingEnd, 200);
+
+    for (auto numberOfWorkers : {1, 4}) {
+      auto perStateConfiguration = configuration;
+      perStateConfiguration.calculateLabelsPerState = true;
+      perStateConfiguration.numberOfWorkers = numberOfWorkers;
+      evaluations = 0;
+      auto perStatePemc = Pemc(perStateConfiguration);
+      auto perStateLmc = perStatePemc.buildLmcFromExecutableModel(modelCreator, ringFormulas);
+      auto evaluationsPerState = evaluations.load();
+      auto perStateProbability = perStatePemc.calculateProbabilityToReachStateWithinBound(*perStateLmc, countedOnRingEnd, 200);
+
+      perStateLmc->validate();
+      ASSERT_EQ(evaluationsPerTransition, 3 * 500 + 3) << "FAIL";
+      ASSERT_EQ(evaluationsPerState, 500) << "FAIL";
+      ASSERT_EQ(probabilityIsAround(perStateProbability, probability.value, 0.0000001), true) << "FAIL";
+    }
+}
+
+TEST(pemc_test, pemc_with_incremental_state_hashing_test) {
+    auto ringFormulas = std::vector<std::shared_ptr<Formula>>( {onRingPosition100} );
+    auto pemc = Pemc(createRingConfiguration());
+    auto lmc = pemc.buildLmcFromExecutableModel(createRingModel, ringFormulas);
+    auto probability = pemc.calculateProbabilityToReachStateWithinBound(*lmc, onRingPosition100, 50);
+
+    // Also with several workers and with a horizon, which looks up the
+    // states beyond it.
+    for (auto numberOfWorkers : {1, 4}) {
+      auto incrementalConfiguration = createRingConfiguration();
+      incrementalConfiguration.incrementalStateHashing = true;
+      incrementalConfiguration.numberOfWorkers = numberOfWorkers;
+      expectSameRingLmcAs(incrementalConfiguration, onRingPosition100, 50);
+
+      auto incrementalPemc = Pemc(incrementalConfiguration);
+      auto horizonLmc = incrementalPemc.buildLmcFromExecutableModel(createRingModel, ringFormulas, 60);
+      auto horizonProbability = incrementalPemc.calculateProbabilityToReachStateWithinBound(*horizonLmc, onRingPosition100, 50);
+
+      horizonLmc->validate();
+      ASSERT_EQ(horizonLmc->getStates().size(), 181 + 1) << "FAIL";
+      ASSERT_EQ(probabilityIsAround(horizonProbability, probability.value, 0.0000001), true) << "FAIL";
+    }
+}
+
+TEST(pemc_test, pemc_reachability_with_lossy_state_storage_test) {
+    auto modelCreator = createRingModel;
+    auto unreachable = std::make_shared<SimpleFormula>([](SimpleModel* model) { return model->getState() >= 500; }, "unreachable" );
+
+    for (auto type : {StateStorageType::Bitstate, StateStorageType::HashCompaction}) {
+      auto configuration = Configuration();
+      configuration.stateStorageType = type;
+      configuration.lossyStateStorageMemory = 1 << 16;
+
+      auto pemc = Pemc(configuration);
+      Probability omissionProbability;
+      auto reachable = pemc.checkReachabilityInExecutableModel(modelCreator, onRingEnd, omissionProbability);
+      auto unreachableReached = pemc.checkReachabilityInExecutableModel(modelCreator, unreachable, omissionProbability);
+
+      ASSERT_EQ(reachable, true) << "FAIL";
+      ASSERT_EQ(unreachableReached, false) << "FAIL";
+      ASSERT_GE(omissionProbability.value, 0.0) << "FAIL";
+      ASSERT_LT(omissionProbability.value, 0.01) << "FAIL";
+    }
 }
@@ -33,6 +33,7 @@ namespace pemc { namespace simple {
   class SimpleModel : public AbstractModel {
   private:
     int32_t state;
+    std::vector<Probability> probabilitiesOfChoice;
   public:
 
     virtual void serialize(gsl::span<gsl::byte> position);
@@ -54,11 +55,11 @@ namespace pemc { namespace simple {
     template<typename T>
     std::tuple<Probability,T> choose(std::initializer_list<std::tuple<Probability,T>> choices) {
       // This is a Member template and the implementation must stay therefore in the header.
-      auto probabilities = std::vector<Probability>();
-      probabilities.reserve(choices.size());
-      std::transform(choices.begin(), choices.end(), std::back_inserter(probabilities),
+      // The buffer is reused, so choose does not allocate in a steady state.
+      probabilitiesOfChoice.clear();
+      std::transform(choices.begin(), choices.end(), std::back_inserter(probabilitiesOfChoice),
         [](auto& choice){ return std::get<0>(choice);} );
-      auto chosenIdx = choiceResolver->choose(probabilities);
+      auto chosenIdx = choiceResolver->choose(probabilitiesOfChoice);
       return choices.begin()[chosenIdx];
     }
 